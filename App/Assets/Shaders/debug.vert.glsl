@@ -3,8 +3,15 @@
 layout (location = 0) in vec3 aPos;
 
 uniform mat4 u_Model;
-uniform mat4 u_View;
-uniform mat4 u_Proj;
+
+// camera of the frame, written once per frame by the renderer
+layout(std140, binding = 0) uniform FrameData {
+    mat4 u_View;
+    mat4 u_Proj;
+    mat4 u_ViewProj;
+    mat3 u_NormalMat;  // upper 3x3 of the view
+    vec4 u_CameraPos;  // world space
+};
 
 void main()
 {
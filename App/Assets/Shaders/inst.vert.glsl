@@ -16,9 +16,15 @@ out VS_OUT{
     vec4 ProjTexCoord;
 } vs_out;
 
-uniform mat4 u_View;
-uniform mat4 u_Proj;
-uniform mat3 u_NormalMat;
+// camera of the frame, written once per frame by the renderer
+layout(std140, binding = 0) uniform FrameData {
+    mat4 u_View;
+    mat4 u_Proj;
+    mat4 u_ViewProj;
+    mat3 u_NormalMat;  // upper 3x3 of the view
+    vec4 u_CameraPos;  // world space
+};
+
 uniform mat4 u_ProjectorMat;
 
 void main() {
@@ -54,8 +54,28 @@ struct Material {
 
 const int NUM_LIGHTS = 1;
 
-uniform DirectionalLight u_DirLight;
-uniform PointLight u_PointLights[NUM_LIGHTS];
+// the sun and the light cluster grid, written once per frame by the renderer
+layout(std140, binding = 1) uniform LightData {
+    DirectionalLight u_DirLight;
+    int u_NumPointLights;
+    ivec4 u_ClusterGrid;  // tiles x, tiles y, depth slices
+    vec4 u_ClusterScale;  // viewport width, height, slice scale, slice bias
+};
+
+// every point light of the frame, in view space
+layout(std430, binding = 2) readonly buffer PointLights {
+    PointLight u_PointLights[];
+};
+
+// per cluster, the offset and the number of its lights in u_LightIndices
+layout(std430, binding = 3) readonly buffer LightClusters {
+    uvec2 u_LightClusters[];
+};
+
+layout(std430, binding = 4) readonly buffer LightIndices {
+    uint u_LightIndices[];
+};
+
 uniform SpotLight u_SpotLights[NUM_LIGHTS];
 uniform Material u_Material;
 layout(binding = 4) uniform sampler2D u_ProjectorTex;
@@ -65,8 +85,6 @@ uniform bool u_UseSpotLights;
 uniform bool u_UseProjTex;
 uniform bool u_SetLit;
 
-uniform int u_NumPointLights;
-
 // Define reusable variables for texture lookups
 vec4 diffuseTextureColor = texture(u_Material.texture_diffuse1, fs_in.TexCoords);
 
@@ -178,6 +196,16 @@ vec3 shadingSpotLight(SpotLight light, vec3 pos, vec3 n) {
     return ambient + diffuse + specular + projTexColor * 0.5;
 }
 
+// the light cluster the fragment falls into, see LightClusterer
+// pos is the fragment's position in view space
+uvec2 findLightCluster(vec3 pos) {
+    ivec2 tile = ivec2(gl_FragCoord.xy / u_ClusterScale.xy * vec2(u_ClusterGrid.xy));
+    int slice = int(log(max(-pos.z, 1e-4)) * u_ClusterScale.z - u_ClusterScale.w);
+    tile = clamp(tile, ivec2(0), u_ClusterGrid.xy - 1);
+    slice = clamp(slice, 0, u_ClusterGrid.z - 1);
+    return u_LightClusters[(slice * u_ClusterGrid.y + tile.y) * u_ClusterGrid.x + tile.x];
+}
+
 float near = 0.1f;
 float far = 200.0f;
 
@@ -208,10 +236,11 @@ void main() {
         // Only one directional light
         vec3 dirColor = shadingDirectionalLight(u_DirLight, fs_in.Pos, normalize(fs_in.Normal));
 
-        // Shading for the point lights
-        if (u_UsePointLights) {
-            for (int i = 0; i < u_NumPointLights; i++) {
-                lightColor += shadingPointLight(u_PointLights[i], fs_in.Pos, normalize(fs_in.Normal));
+        // Shading for the point lights, only the ones reaching the fragment's cluster
+        if (u_UsePointLights && u_NumPointLights > 0) {
+            uvec2 cluster = findLightCluster(fs_in.Pos);
+            for (uint i = cluster.x; i < cluster.x + cluster.y; i++) {
+                lightColor += shadingPointLight(u_PointLights[u_LightIndices[i]], fs_in.Pos, normalize(fs_in.Normal));
             }
         }
 
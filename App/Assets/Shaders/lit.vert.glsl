@@ -16,43 +16,59 @@ out VS_OUT{
 } vs_out;
 
 uniform mat4 u_Model;
-uniform mat4 u_View;
-uniform mat4 u_Proj;
-uniform mat3 u_NormalMat;
+
+// camera of the frame, written once per frame by the renderer
+layout(std140, binding = 0) uniform FrameData {
+    mat4 u_View;
+    mat4 u_Proj;
+    mat4 u_ViewProj;
+    mat3 u_NormalMat;  // upper 3x3 of the view
+    vec4 u_CameraPos;  // world space
+};
 
 uniform mat4 u_ProjectorMat;
 
 
-const int MAX_BONES = 100;
 const int MAX_BONE_INFLUENCE = 4;
-uniform mat4 bones[MAX_BONES];
+
+// skinning matrices of every animated object drawn this frame, back to back
+layout(std430, binding = 0) readonly buffer BonePalette {
+    mat4 bones[];
+};
+// first matrix of this object in the palette, -1 if it is not skinned
+uniform int u_BoneOffset = -1;
+
+// model matrices of the draws the render queue merged, one per instance
+layout(std430, binding = 1) readonly buffer InstanceMatrices {
+    mat4 instances[];
+};
+// added to the draw's base instance to find its first matrix in the instance buffer, -1 to use u_Model
+uniform int u_InstanceBase = -1;
 
 void main() {
+    mat4 model = u_InstanceBase >= 0 ? instances[u_InstanceBase + gl_BaseInstance + gl_InstanceID] : u_Model;
 
 	vec4 totalPosition = vec4(0.0f);
-    for(int i = 0 ; i < MAX_BONE_INFLUENCE ; i++)
+    if(u_BoneOffset >= 0)
     {
-        if(boneIds[i] == -1) 
-            continue;
-        if(boneIds[i] >= MAX_BONES) 
+        for(int i = 0 ; i < MAX_BONE_INFLUENCE ; i++)
         {
-            totalPosition = vec4(a_Pos,1.0f);
-            break;
+            if(boneIds[i] == -1) 
+                continue;
+            vec4 localPosition = bones[u_BoneOffset + boneIds[i]] * vec4(a_Pos,1.0f);
+            totalPosition += localPosition * weights[i];
         }
-        vec4 localPosition = bones[boneIds[i]] * vec4(a_Pos,1.0f);
-        totalPosition += localPosition * weights[i];
-        vec3 localNormal = mat3(bones[boneIds[i]]) * a_Normal;
     }
 
-    if(boneIds[0] == -1) 
+    if(u_BoneOffset < 0 || boneIds[0] == -1) 
         totalPosition = vec4(a_Pos, 1.0);
 		
-    mat4 viewModel = u_View * u_Model;
+    mat4 viewModel = u_View * model;
     gl_Position =  u_Proj * viewModel * totalPosition;
 
 	vs_out.TexCoords = a_TexCoords;
 	vs_out.Normal = normalize(u_NormalMat * a_Normal);
-	vs_out.Pos = (u_View * u_Model * vec4(a_Pos, 1.0)).xyz;
-	vs_out.ProjTexCoord = u_ProjectorMat * u_Model * vec4(a_Pos, 1.0);
+	vs_out.Pos = (u_View * model * vec4(a_Pos, 1.0)).xyz;
+	vs_out.ProjTexCoord = u_ProjectorMat * model * vec4(a_Pos, 1.0);
 
 }
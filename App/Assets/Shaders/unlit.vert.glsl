@@ -9,8 +9,15 @@ out VS_OUT{
 } vs_out;
 
 uniform mat4 u_Model;
-uniform mat4 u_View;
-uniform mat4 u_Proj;
+
+// camera of the frame, written once per frame by the renderer
+layout(std140, binding = 0) uniform FrameData {
+	mat4 u_View;
+	mat4 u_Proj;
+	mat4 u_ViewProj;
+	mat3 u_NormalMat;  // upper 3x3 of the view
+	vec4 u_CameraPos;  // world space
+};
 
 void main() {
 	vs_out.TexCoords = a_TexCoords;
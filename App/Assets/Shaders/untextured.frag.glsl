@@ -9,6 +9,11 @@ out vec4 o_FragColor;
 
 struct DirectionalLight {
 	vec3 dir; // Light direction in view space.
+	vec4 color;
+	float intensity;
+};
+
+struct LightColors {
 	vec3 a;  // Ambient color
 	vec3 d;  // Diffuse color
 	vec3 s;  // Specular color
@@ -21,18 +26,27 @@ struct Material {
 	float shininess;    // Specular shininess factor
 };
 
-uniform DirectionalLight u_DirLight;
+// the frame's lights, only the sun's direction is used here
+layout(std140, binding = 1) uniform LightData {
+	DirectionalLight u_DirLight;
+	int u_NumPointLights;
+	ivec4 u_ClusterGrid;
+	vec4 u_ClusterScale;
+};
+
+uniform LightColors u_LightColors;
 uniform Material u_Material;
 
 // Blinn-Phong shading, the directional light contribution
+// dir is the light direction in view space
 // pos is the fragment's position in view space
 // n is the fragment's normal in view space
-vec3 shadingDirectionalLight(DirectionalLight light, vec3 pos, vec3 n) {
+vec3 shadingDirectionalLight(LightColors light, vec3 dir, vec3 pos, vec3 n) {
 	// ambient component
 	vec3 ambient = light.a * u_Material.a;
 
 	// diffuse component
-	vec3 s = normalize(-light.dir); // s is the light source direction
+	vec3 s = normalize(-dir); // s is the light source direction
 	float sDotN = max(dot(n, s), 0.0);
 	vec3 diffuse = light.d * sDotN * u_Material.d;
 
@@ -50,6 +64,6 @@ vec3 shadingDirectionalLight(DirectionalLight light, vec3 pos, vec3 n) {
 }
 
 void main() {
-	vec3 dirColor = shadingDirectionalLight(u_DirLight, fs_in.Pos, normalize(fs_in.Normal));
+	vec3 dirColor = shadingDirectionalLight(u_LightColors, u_DirLight.dir, fs_in.Pos, normalize(fs_in.Normal));
 	o_FragColor = vec4(dirColor, 1.0);
 }
@@ -40,7 +40,7 @@ project "App"
 
     filter "system:windows"
         systemversion "latest"
-        defines { "WINDOWS" }
+        defines { "WINDOWS", "GLM_FORCE_INTRINSICS" }
 
     filter "configurations:Debug"
         defines { "DEBUG" }
@@ -9,6 +9,12 @@ using namespace gdp1::utils;
 
 #include "Utils/softbody_utils.h"
 #include "Utils/timer.h"
+#include "Animation/pose_system.h"
+#include "Render/frustum.h"
+#include "Render/occlusion_culler.h"
+#include "Render/light_clusterer.h"
+#include "Render/render_queue.h"
+#include "Resource/lod_system.h"
 
 GameLayer::GameLayer()
     : Layer("Game") {}
@@ -31,6 +37,10 @@ void GameLayer::OnAttach() {
     zombie1->SetCurrentAnimation("zombie_idle");
     zombie2->SetCurrentAnimation("zombie_idle");
 
+    // walking and running move the zombies instead of playing in place
+    zombie1->applyRootMotion = true;
+    zombie2->applyRootMotion = true;
+
     // Add Player and objects to the scene
     AddPlayer();
 
@@ -61,6 +71,8 @@ void GameLayer::OnAttach() {
     m_Physics = std::make_unique<Physics>(m_Scene.get(), m_Scene->GetLevelDesc());
     m_Physics->StartSoftBodyThreads();
 
+    BuildFrameGraph();
+
     // configure global OpenGL state
     glEnable(GL_DEPTH_TEST);
 
@@ -89,15 +101,71 @@ void GameLayer::OnEvent(gdp1::Event& event) {
 
 void GameLayer::OnUpdate(gdp1::Timestep ts) {
     // m_FlyCamera->OnUpdate(ts);
-    m_Player->Update(ts);
-
-    m_Physics->FixedUpdate(ts);
-    m_Scene->Update(ts);
-
-    m_Renderer->Render(m_Scene, m_Player->fps_camera_ptr_.get()->GetCamera(), ts);
+    m_FrameGraph->Execute(ts);
     // m_ParticleSystem->Render(m_Player->fps_camera_ptr_.get()->GetCamera());
 }
 
+void GameLayer::BuildFrameGraph() {
+    m_FrameGraph = std::make_unique<FrameGraph>();
+
+    // The previous frame's render list is submitted first, so GL submission overlaps with this frame's simulation.
+    // The render list is rebuilt at the end of the frame, which adds one frame of latency.
+    m_FrameGraph->AddTask({"Render",
+                           {"RenderList"},
+                           {"GL"},
+                           TaskAffinity::MainThread,
+                           [this](float dt) {
+                               m_Renderer->Submit(m_Scene, m_Player->fps_camera_ptr_.get()->GetCamera(), dt);
+                           }});
+
+    m_FrameGraph->AddTask({"Player",
+                           {"Input"},
+                           {"PlayerTransform", "Camera"},
+                           TaskAffinity::MainThread,
+                           [this](float dt) { m_Player->Update(dt); }});
+
+    m_FrameGraph->AddTask({"PhysicsSimulate",
+                           {"PlayerTransform"},
+                           {"Rigidbodies"},
+                           TaskAffinity::Any,
+                           [this](float dt) { m_Physics->Simulate(dt); }});
+
+    m_FrameGraph->AddTask({"GameObjects",
+                           {"Input", "Rigidbodies"},
+                           {"PlayerTransform", "Camera", "Transforms", "Rigidbodies", "Animators"},
+                           TaskAffinity::MainThread,
+                           [this](float dt) { m_Physics->UpdateGameObjects(dt); }});
+
+    m_FrameGraph->AddTask({"PhysicsIntegrate",
+                           {},
+                           {"Rigidbodies", "Transforms"},
+                           TaskAffinity::Any,
+                           [this](float dt) { m_Physics->Integrate(dt); }});
+
+    m_FrameGraph->AddTask({"Scene",
+                           {},
+                           {"Transforms"},
+                           TaskAffinity::Any,
+                           [this](float dt) { m_Scene->Update(dt); }});
+
+    m_FrameGraph->AddTask({"BuildRenderList",
+                           {"Transforms", "Camera"},
+                           {"RenderList"},
+                           TaskAffinity::Any,
+                           [this](float dt) {
+                               m_Renderer->BuildRenderList(m_Scene, m_Player->fps_camera_ptr_.get()->GetCamera());
+                           }});
+
+    m_FrameGraph->AddTask({"Animation",
+                           {},
+                           {"RenderList", "Animators"},
+                           TaskAffinity::Any,
+                           [this](float dt) { m_Renderer->UpdateAnimations(dt); }});
+
+    m_FrameGraph->Compile();
+    m_FrameGraph->LogGraph();
+}
+
 void GameLayer::OnImGuiRender() {
     ImGui::Begin("Controls");
     ImGui::Text("WASD to move, mouse to look around");
@@ -118,6 +186,41 @@ void GameLayer::OnImGuiRender() {
     ImGui::Checkbox("Draw Debug", &m_Renderer->drawDebug);
     ImGui::Checkbox("Set Instanced", &m_Renderer->setInstanced);
 
+    PoseSystem* poseSystem = m_Renderer->GetPoseSystem();
+    ImGui::Text("Animation LOD: full %u, half %u, quarter %u, hidden %u", poseSystem->GetLODCount(AnimationLOD::Full),
+                poseSystem->GetLODCount(AnimationLOD::Half), poseSystem->GetLODCount(AnimationLOD::Quarter),
+                poseSystem->GetLODCount(AnimationLOD::Hidden));
+    ImGui::SliderFloat("Half Rate Below", &poseSystem->halfRateSize, 0.0f, 1.0f);
+    ImGui::SliderFloat("Quarter Rate Below", &poseSystem->quarterRateSize, 0.0f, 1.0f);
+
+    LODSystem* lodSystem = m_Renderer->GetLODSystem();
+    ImGui::SliderFloat("LOD Max Screen Error", &lodSystem->maxScreenError, 0.1f, 8.0f);
+    ImGui::SliderFloat("LOD Hysteresis", &lodSystem->hysteresis, 0.0f, 0.9f);
+
+    OcclusionCuller* occlusionCuller = m_Renderer->GetOcclusionCuller();
+    ImGui::Checkbox("Occlusion Culling", &m_Renderer->occlusionCulling);
+    ImGui::Text("Occluders: %u (%u triangles), occluded objects: %u", occlusionCuller->GetOccluderCount(),
+                occlusionCuller->GetTriangleCount(), occlusionCuller->GetCulledCount());
+
+    LightClusterer* lightClusterer = m_Renderer->GetLightClusterer();
+    ImGui::Text("Light Clusters: %d, light assignments: %u, most lights in a cluster: %u",
+                LightClusterer::NUM_CLUSTERS, lightClusterer->GetAssignmentCount(),
+                lightClusterer->GetMaxLightsPerCluster());
+
+    const RenderStats& renderStats = m_Renderer->GetRenderStats();
+    ImGui::Text("Render Queue: %u packets in %u draws (%u instanced), %u multi draws of %u commands",
+                renderStats.packets, renderStats.drawCalls, renderStats.instancedDraws, renderStats.multiDraws,
+                renderStats.indirectCommands);
+    ImGui::Checkbox("Multi Draw Indirect", &m_Renderer->GetRenderQueue()->multiDraw);
+    ImGui::Text("State changes: %u (%u programs, %u textures, %u VAOs), %u binds skipped",
+                renderStats.GetStateChanges(), renderStats.programBinds, renderStats.textureBinds,
+                renderStats.vertexArrayBinds, renderStats.redundantBinds);
+
+    if (ImGui::Button("Benchmark Frustum Culling")) {
+        std::shared_ptr<Camera> camera = m_Player->fps_camera_ptr_.get()->GetCamera();
+        Frustum::Benchmark(camera->GetProjectionMatrix() * camera->GetViewMatrix());
+    }
+
     ImGui::End();
 
     ImGui::Begin("Change Zombie 1 Animations");
@@ -196,6 +299,19 @@ void GameLayer::OnImGuiRender() {
         }
     }
 
+    // locomotion blend tree: idle/walk/run blended by speed, attack layered over the upper body
+    static float zombieSpeed = 0.0f;
+    static float zombieAttack = 0.0f;
+    if (ImGui::Button("Use Locomotion Blend Tree")) {
+        zombie2->SetBlendTree("zombie_locomotion");
+        zombie2->SetAnimationParameter("speed", zombieSpeed);
+        zombie2->SetAnimationParameter("attack", zombieAttack);
+    }
+    if (ImGui::SliderFloat("Speed", &zombieSpeed, 0.0f, 2.0f)) zombie2->SetAnimationParameter("speed", zombieSpeed);
+    if (ImGui::SliderFloat("Attack", &zombieAttack, 0.0f, 1.0f)) {
+        zombie2->SetAnimationParameter("attack", zombieAttack);
+    }
+
     ImGui::End();
 }
 
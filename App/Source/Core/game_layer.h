@@ -7,6 +7,7 @@
 #include <Physics/softbody.h>
 #include <Audio/audio_manager.h>
 #include <Core/game_object.h>
+#include <Core/frame_graph.h>
 
 #include "IO/sqlite_database.h"
 
@@ -36,6 +37,8 @@ private:
 
     std::unique_ptr<gdp1::ParticleSystem> m_ParticleSystem;
 
+    std::unique_ptr<gdp1::FrameGraph> m_FrameGraph;
+
     Player* m_Player;
     gdp1::GameObject* zombie1;
     gdp1::GameObject* zombie2;
@@ -47,4 +50,6 @@ private:
 
     void AddPlayer();
     void AddCoins();
+
+    void BuildFrameGraph();
 };
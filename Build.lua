@@ -23,4 +23,5 @@ IncludeDir["json"] = "Vendor/json/include"
 
 -- Projects
 include "Engine/Build-Engine.lua"
-include "App/Build-App.lua"
\ No newline at end of file
+include "App/Build-App.lua"
+include "Tests/Build-Tests.lua"
\ No newline at end of file
@@ -69,7 +69,8 @@ project "Engine"
         defines
         {
             "GLFW_INCLUDE_NONE",
-            "WIN32_LEAN_AND_MEAN"
+            "WIN32_LEAN_AND_MEAN",
+            "GLM_FORCE_INTRINSICS"
         }
 
     filter "configurations:Debug"
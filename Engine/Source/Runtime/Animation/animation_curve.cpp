@@ -1,11 +1,21 @@
 #include "animation_curve.h"
 
+#include <algorithm>
+
+#include <emmintrin.h>
+
 AnimationCurve::AnimationCurve(std::vector<Keyframe>&& keys)
     : keys(std::move(keys)) {
+    SortKeys();
 }
 
 AnimationCurve::AnimationCurve(const std::vector<Keyframe>& keys)
     : keys(keys) {
+    SortKeys();
+}
+
+void AnimationCurve::SortKeys() {
+    std::stable_sort(keys.begin(), keys.end(), [](const Keyframe& a, const Keyframe& b) { return a.time < b.time; });
 }
 
 Keyframe& AnimationCurve::operator[](size_t index) {
@@ -16,7 +26,86 @@ const Keyframe& AnimationCurve::operator[](size_t index) const {
     return keys.at(index);
 }
 
-float AnimationCurve::Evaluate(float time) {
+float AnimationCurve::Evaluate(float time) const {
+    if (bakedValues.empty()) {
+        return EvaluateKeys(time);
+    }
+
+    // clamped like the keys, then linear between the two nearest samples
+    float x = (time - bakedStartTime) * bakedInvStep;
+    float last = static_cast<float>(bakedValues.size() - 1);
+    x = x < 0.f ? 0.f : (x > last ? last : x);
+
+    size_t index = static_cast<size_t>(x);
+    if (index >= bakedValues.size() - 1) {
+        return bakedValues.back();
+    }
+
+    float t = x - static_cast<float>(index);
+    return bakedValues[index] + (bakedValues[index + 1] - bakedValues[index]) * t;
+}
+
+void AnimationCurve::Evaluate(const float* times, float* out, size_t count) const {
+    size_t i = 0;
+
+    if (bakedValues.size() >= 2) {
+        const __m128 start = _mm_set1_ps(bakedStartTime);
+        const __m128 invStep = _mm_set1_ps(bakedInvStep);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 end = _mm_set1_ps(static_cast<float>(bakedValues.size() - 1));
+        // one sample short of the end, so index + 1 is always in the table
+        const __m128 last = _mm_set1_ps(static_cast<float>(bakedValues.size() - 2));
+        const float* values = bakedValues.data();
+
+        for (; i + 4 <= count; i += 4) {
+            __m128 x = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(times + i), start), invStep);
+            // clamped on both sides like the scalar path, times too large for an int convert to INT_MIN.
+            // max returns zero for NaN.
+            x = _mm_min_ps(_mm_max_ps(x, zero), end);
+
+            // at the end the fraction is 1 on the last segment
+            __m128 index = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(x)), last);
+            __m128 t = _mm_sub_ps(x, index);
+
+            alignas(16) int indices[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(indices), _mm_cvttps_epi32(index));
+
+            __m128 v0 = _mm_setr_ps(values[indices[0]], values[indices[1]], values[indices[2]], values[indices[3]]);
+            __m128 v1 = _mm_setr_ps(values[indices[0] + 1], values[indices[1] + 1], values[indices[2] + 1],
+                                    values[indices[3] + 1]);
+
+            _mm_storeu_ps(out + i, _mm_add_ps(v0, _mm_mul_ps(_mm_sub_ps(v1, v0), t)));
+        }
+    }
+
+    for (; i < count; ++i) {
+        out[i] = Evaluate(times[i]);
+    }
+}
+
+void AnimationCurve::Bake(size_t resolution) {
+    bakedValues.clear();
+    if (keys.size() < 2 || resolution < 2) {
+        return;
+    }
+
+    float startTime = keys.front().time;
+    float duration = keys.back().time - startTime;
+    if (duration <= 0.f) {
+        return;
+    }
+
+    bakedValues.resize(resolution);
+    for (size_t i = 0; i < resolution; ++i) {
+        float time = startTime + duration * static_cast<float>(i) / static_cast<float>(resolution - 1);
+        bakedValues[i] = EvaluateKeys(time);
+    }
+
+    bakedStartTime = startTime;
+    bakedInvStep = static_cast<float>(resolution - 1) / duration;
+}
+
+float AnimationCurve::EvaluateKeys(float time) const {
     if (keys.size() == 0) {
         return 0.f;
     }
@@ -29,14 +118,10 @@ float AnimationCurve::Evaluate(float time) {
     if (time >= keys.back().time) {
         return keys.back().value;
     }
-    // find the keyframes to interpolate between
-    size_t keyIndex = 0;
-    for (size_t i = 0; i < keys.size(); ++i) {
-        if (keys[i].time > time) {
-            keyIndex = i;
-            break;
-        }
-    }
+    // find the keyframes to interpolate between, the first key after time
+    size_t keyIndex = std::upper_bound(keys.begin(), keys.end(), time,
+                                       [](float t, const Keyframe& key) { return t < key.time; }) -
+                      keys.begin();
     // interpolate
     // Cubic Spline Interpolation
     // ref: https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html#interpolation-cubic
@@ -65,27 +150,30 @@ float AnimationCurve::Evaluate(float time) {
 }
 
 int AnimationCurve::AddKey(Keyframe key) {
-    return AddKey(key.time, key.value);
+    // keys stay sorted, so the insertion point is also where a key at the same time would be
+    std::vector<Keyframe>::iterator it = std::lower_bound(
+        keys.begin(), keys.end(), key.time, [](const Keyframe& k, float t) { return k.time < t; });
+    if (it != keys.end() && it->time == key.time) {
+        return -1;
+    }
+
+    bakedValues.clear();
+    return static_cast<int>(keys.insert(it, key) - keys.begin());
 }
 
 int AnimationCurve::AddKey(float time, float value) {
-    // check if the key exists
-    for (size_t i = 0; i < keys.size(); ++i) {
-        if (keys[i].time == time) {
-            return -1;
-        }
-    }
-    // add the key
-    keys.push_back({value, time});
-    return keys.size() - 1;
+    Keyframe key = {value, time};
+    return AddKey(key);
 }
 
 void AnimationCurve::RemoveKey(int index) {
     keys.erase(keys.begin() + index);
+    bakedValues.clear();
 }
 
 void AnimationCurve::ClearKeys() {
     keys.clear();
+    bakedValues.clear();
 }
 
 AnimationCurve AnimationCurve::Constant(float timeStart, float timeEnd, float value) {
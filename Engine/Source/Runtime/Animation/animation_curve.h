@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 // Sets which weights to use when calculating curve segments.
@@ -37,12 +38,19 @@ enum class WrapMode {
 };
 
 // Store a collection of Keyframes that can be evaluated over time.
+// Keys are kept sorted by time. A baked curve is sampled into a fixed resolution table once and then evaluates in
+// constant time, which is what tweens, camera shakes and material animations evaluated every frame should use.
 struct AnimationCurve {
     std::vector<Keyframe> keys;
     float length;           // in seconds
     WrapMode postWrapMode;  // The behavior of the animation after the last keyframe.
     WrapMode preWrapMode;   // The behavior of the animation before the first keyframe.
 
+    // baked samples from the first to the last key, empty if the curve is not baked
+    std::vector<float> bakedValues;
+    float bakedStartTime = 0.f;
+    float bakedInvStep = 0.f;  // samples per second
+
     // ctor
     AnimationCurve(const std::vector<Keyframe>& keys);
 
@@ -55,20 +63,37 @@ struct AnimationCurve {
     // operator[] non-const
     Keyframe& operator[](size_t index);
 
-    float Evaluate(float time);
+    float Evaluate(float time) const;
+
+    /**
+     * @brief Evaluate the curve at many times at once, four at a time with SSE if the curve is baked.
+     * @param times The times to evaluate at.
+     * @param out   Receives one value per time.
+     * @param count The number of times.
+     */
+    void Evaluate(const float* times, float* out, size_t count) const;
+
+    /**
+     * @brief Sample the curve into a table, Evaluate then interpolates the two nearest samples instead of searching
+     * the keys. Adding or removing keys drops the table, changing keys through operator[] needs another Bake.
+     * @param resolution The number of samples between the first and the last key.
+     */
+    void Bake(size_t resolution = 256);
+
+    bool IsBaked() const { return !bakedValues.empty(); }
 
     /**
      * @brief Add a key to the curve
      * @param time TThe time at which to add the key (horizontal axis in the curve graph).
      * @param value The value for the key (vertical axis in the curve graph).
-     * @return TThe index of the added key, or -1 if the key could not be added.
+     * @return TThe index of the added key, or -1 if there already is a key at that time.
      */
     int AddKey(float time, float value);
 
     /**
      * @brief Add a key to the curve.
      * @param key   The key to add to the curve.
-     * @return      TThe index of the added key, or -1 if the key could not be added.
+     * @return      TThe index of the added key, or -1 if there already is a key at that time.
      */
     int AddKey(Keyframe key);
 
@@ -110,4 +135,10 @@ struct AnimationCurve {
      * @return AnimationCurve The ease-in and out curve generated from the specified values.
      */
     static AnimationCurve EaseInOut(float timeStart, float valueStart, float timeEnd, float valueEnd);
+
+private:
+    void SortKeys();
+
+    // evaluates the keys without the baked table
+    float EvaluateKeys(float time) const;
 };
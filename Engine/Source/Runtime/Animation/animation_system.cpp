@@ -1,9 +1,65 @@
 #include "animation_system.h"
 
-#include <glm/gtx/easing.hpp>
+#include <algorithm>
+#include <map>
+
+#include <glm/gtc/constants.hpp>
 
 namespace gdp1 {
 
+namespace {
+
+// Every sine easing is a + b * cos(c * t + d), so the segments of a channel are eased by one loop without a switch.
+struct EasingCurve {
+    float a, b, c, d;
+    float linear;  // 1 to pass the factor through unchanged
+};
+
+const EasingCurve EASING_CURVES[] = {
+    {0.0f, 0.0f, 0.0f, 0.0f, 1.0f},                                        // Linear
+    {1.0f, -1.0f, glm::half_pi<float>(), 0.0f, 0.0f},                      // sineEaseIn
+    {0.0f, 1.0f, glm::half_pi<float>(), -glm::half_pi<float>(), 0.0f},     // sineEaseOut
+    {0.5f, -0.5f, glm::pi<float>(), 0.0f, 0.0f},                           // sineEaseInOut
+};
+
+void EaseSegments(std::vector<KeyframeSegment>& segments, const std::vector<EasingType>& easings) {
+    for (size_t i = 0; i < segments.size(); i++) {
+        const EasingCurve& curve = EASING_CURVES[static_cast<int>(easings[i])];
+        float t = segments[i].factor;
+        float eased = curve.a + curve.b * cosf(curve.c * t + curve.d);
+        segments[i].factor = eased + (t - eased) * curve.linear;
+    }
+}
+
+// Groups a clip's keys by transform into tracks of time sorted keys. Keys whose object was not found are dropped.
+template <typename Keyframe, typename T>
+void BuildChannel(const std::vector<Keyframe>& keys, KeyframeChannel<T>& channel) {
+    std::map<Transform*, std::vector<const Keyframe*>> keysPerTransform;
+    for (const Keyframe& keyframe : keys) {
+        if (keyframe.xform != nullptr) keysPerTransform[keyframe.xform].push_back(&keyframe);
+    }
+
+    for (auto& pair : keysPerTransform) {
+        std::vector<const Keyframe*>& trackKeys = pair.second;
+        std::stable_sort(trackKeys.begin(), trackKeys.end(),
+                         [](const Keyframe* a, const Keyframe* b) { return a->time < b->time; });
+
+        KeyframeTrack track;
+        track.xform = pair.first;
+        track.firstKey = (unsigned int)channel.times.size();
+        track.numKeys = (unsigned int)trackKeys.size();
+        channel.tracks.push_back(track);
+
+        for (const Keyframe* keyframe : trackKeys) {
+            channel.times.push_back(keyframe->time);
+            channel.values.push_back(keyframe->value);
+            channel.easings.push_back(keyframe->easingType);
+        }
+    }
+}
+
+}  // namespace
+
 AnimationSystem::AnimationSystem(Animation* animation)
     : m_Animation(animation)
     , m_Playing(false)
@@ -22,46 +78,31 @@ void AnimationSystem::SetPlaying(bool isPlaying) {
 }
 
 void AnimationSystem::CreateRuntimeData() {
-    // for each clip, sort the keyframes by time
-    for (auto& clip : m_Animation->clips) {
-        std::sort(clip.positionKeys.begin(), clip.positionKeys.end(),
-                  [](const PositionKeyframe& a, const PositionKeyframe& b) { return a.time < b.time; });
-
-        std::sort(clip.scaleKeys.begin(), clip.scaleKeys.end(),
-                  [](const ScaleKeyframe& a, const ScaleKeyframe& b) { return a.time < b.time; });
-
-        std::sort(clip.rotationKeys.begin(), clip.rotationKeys.end(),
-                  [](const RotationKeyframe& a, const RotationKeyframe& b) { return a.time < b.time; });
-    }
-    // after sorting, gather the keyframes for each game object
     m_AnimationClipRuntimeData.clear();
-    for (auto& clip : m_Animation->clips) {
+    for (const AnimationClip& clip : m_Animation->clips) {
         AnimationClipRuntimeData data;
-        for (auto& keyframe : clip.positionKeys) {
-            if (data.xformPositionKeyframesMap.find(keyframe.xform) == data.xformPositionKeyframesMap.end()) {
-                data.xformPositionKeyframesMap[keyframe.xform] = std::vector<PositionKeyframe*>();
-            }
-            data.xformPositionKeyframesMap[keyframe.xform].push_back(&keyframe);
-        }
-        for (auto& keyframe : clip.scaleKeys) {
-            if (data.xformScaleKeyframesMap.find(keyframe.xform) == data.xformScaleKeyframesMap.end()) {
-                data.xformScaleKeyframesMap[keyframe.xform] = std::vector<ScaleKeyframe*>();
-            }
-            data.xformScaleKeyframesMap[keyframe.xform].push_back(&keyframe);
-        }
-        for (auto& keyframe : clip.rotationKeys) {
-            if (data.xformRotationKeyframesMap.find(keyframe.xform) == data.xformRotationKeyframesMap.end()) {
-                data.xformRotationKeyframesMap[keyframe.xform] = std::vector<RotationKeyframe*>();
-            }
-            data.xformRotationKeyframesMap[keyframe.xform].push_back(&keyframe);
-        }
+        BuildChannel(clip.positionKeys, data.positions);
+        BuildChannel(clip.rotationKeys, data.rotations);
+        BuildChannel(clip.scaleKeys, data.scales);
         m_AnimationClipRuntimeData.push_back(data);
     }
+
+    ResetCursors();
 }
 
 void AnimationSystem::SetCurrentClipIndex(size_t index) {
     m_CurrentClipIndex = index;
     m_ElapsedTime = 0;
+    ResetCursors();
+}
+
+void AnimationSystem::ResetCursors() {
+    if (m_CurrentClipIndex >= m_AnimationClipRuntimeData.size()) return;
+
+    const AnimationClipRuntimeData& clip = m_AnimationClipRuntimeData[m_CurrentClipIndex];
+    m_PositionCursors.assign(clip.positions.tracks.size(), 0);
+    m_RotationCursors.assign(clip.rotations.tracks.size(), 0);
+    m_ScaleCursors.assign(clip.scales.tracks.size(), 0);
 }
 
 void AnimationSystem::SetPlaySpeed(float speed) {
@@ -81,190 +122,80 @@ float AnimationSystem::GetElapsedTime() const {
 }
 
 void AnimationSystem::Update(float deltaTime) {
-    if (!m_Playing) {
+    if (!m_Playing || m_CurrentClipIndex >= m_AnimationClipRuntimeData.size()) {
         return;
     }
 
     m_ElapsedTime += deltaTime * m_PlaySpeed;
 
-    AnimationClipRuntimeData& clip = m_AnimationClipRuntimeData[m_CurrentClipIndex];
+    const AnimationClipRuntimeData& clip = m_AnimationClipRuntimeData[m_CurrentClipIndex];
 
     /// POSITION
-    for (auto& xformKeysPair : clip.xformPositionKeyframesMap) {
-        Transform* xform = xformKeysPair.first;
-        std::vector<PositionKeyframe*>& keyframes = xformKeysPair.second;
-
-        // If there is only 1 key frame, use that one.
-        // If we are equal to or greater than the time of the last key frame, use the last keyframe
-        if (keyframes.size() == 1) {
-            xform->SetPosition(keyframes[0]->value);
-        } else {
-            // Find our position keyframes (Start and End)
-            int KeyframeEndIndex = 0;
-            for (; KeyframeEndIndex < keyframes.size(); KeyframeEndIndex++) {
-                if (keyframes[KeyframeEndIndex]->time > m_ElapsedTime) {
-                    break;
-                }
-            }
-
-            if (KeyframeEndIndex >= keyframes.size()) {
-                // we are at or past the last key frame use the last keyframe only
-                xform->SetPosition(keyframes[KeyframeEndIndex - 1]->value);
-                continue;
-            }
-
-            if (KeyframeEndIndex == 0) {
-                xform->SetPosition(keyframes[0]->value);
-                continue;
-            }
-
-            int KeyframeStartIndex = KeyframeEndIndex - 1;
-
-            PositionKeyframe* startKeyframe = keyframes[KeyframeStartIndex];
-            PositionKeyframe* endKeyframe = keyframes[KeyframeEndIndex];
-
-            float percent = (m_ElapsedTime - startKeyframe->time) / (endKeyframe->time - startKeyframe->time);
-            float factor = 0.f;
-            switch (endKeyframe->easingType) {
-                case EasingType::Linear:
-                    factor = percent;
-                    break;
-
-                case EasingType::sineEaseIn:
-                    factor = glm::sineEaseIn(percent);
-                    break;
-
-                case EasingType::sineEaseOut:
-                    factor = glm::sineEaseOut(percent);
-                    break;
-
-                case EasingType::sineEaseInOut:
-                    factor = glm::sineEaseInOut(percent);
-                    break;
-            }
-
-            glm::vec3 interpolated = glm::mix(startKeyframe->value, endKeyframe->value, factor);
-            xform->SetPosition(interpolated);
-        }
+    FindSegments(clip.positions, m_PositionCursors);
+    for (size_t i = 0; i < clip.positions.tracks.size(); i++) {
+        const KeyframeSegment& segment = m_Segments[i];
+        glm::vec3 interpolated = glm::mix(clip.positions.values[segment.startKey],
+                                          clip.positions.values[segment.endKey], segment.factor);
+        clip.positions.tracks[i].xform->SetPosition(interpolated);
     }
 
     /// SCALE
-    for (auto& xformKeysPair : clip.xformScaleKeyframesMap) {
-        Transform* xform = xformKeysPair.first;
-        std::vector<ScaleKeyframe*>& keyframes = xformKeysPair.second;
-
-        // If there is only 1 key frame, use that one.
-        // If we are equal to or greater than the time of the last key frame, use the last keyframe
-        if (keyframes.size() == 1) {
-            xform->SetScale(keyframes[0]->value);
-        } else {
-            // Find our position keyframes (Start and End)
-            int KeyframeEndIndex = 0;
-            for (; KeyframeEndIndex < keyframes.size(); KeyframeEndIndex++) {
-                if (keyframes[KeyframeEndIndex]->time > m_ElapsedTime) {
-                    break;
-                }
-            }
-
-            if (KeyframeEndIndex >= keyframes.size()) {
-                // we are at or past the last key frame use the last keyframe only
-                xform->SetScale(keyframes[KeyframeEndIndex - 1]->value);
-                continue;
-            }
-
-            if (KeyframeEndIndex == 0) {
-                xform->SetScale(keyframes[0]->value);
-                continue;
-            }
-
-            int KeyFrameStartIndex = KeyframeEndIndex - 1;
-
-            ScaleKeyframe* startKeyframe = keyframes[KeyFrameStartIndex];
-            ScaleKeyframe* endKeyframe = keyframes[KeyframeEndIndex];
-
-            float percent = (m_ElapsedTime - startKeyframe->time) / (endKeyframe->time - startKeyframe->time);
-            float factor = 0.f;
-            switch (endKeyframe->easingType) {
-                case EasingType::Linear:
-                    factor = percent;
-                    break;
-
-                case EasingType::sineEaseIn:
-                    factor = glm::sineEaseIn(percent);
-                    break;
-
-                case EasingType::sineEaseOut:
-                    factor = glm::sineEaseOut(percent);
-                    break;
-
-                case EasingType::sineEaseInOut:
-                    factor = glm::sineEaseInOut(percent);
-                    break;
-            }
-
-            glm::vec3 interpolated = glm::mix(startKeyframe->value, endKeyframe->value, factor);
-            xform->SetScale(interpolated);
-        }
+    FindSegments(clip.scales, m_ScaleCursors);
+    for (size_t i = 0; i < clip.scales.tracks.size(); i++) {
+        const KeyframeSegment& segment = m_Segments[i];
+        glm::vec3 interpolated =
+            glm::mix(clip.scales.values[segment.startKey], clip.scales.values[segment.endKey], segment.factor);
+        clip.scales.tracks[i].xform->SetScale(interpolated);
     }
 
     /// ROTATION
-    for (auto& xformKeysPair : clip.xformRotationKeyframesMap) {
-        Transform* transform = xformKeysPair.first;
-        std::vector<RotationKeyframe*>& keyframes = xformKeysPair.second;
-
-        // If there is only 1 key frame, use that one.
-        // If we are equal to or greater than the time of the last key frame, use the last keyframe
-        if (keyframes.size() == 1) {
-            transform->SetRotation(keyframes[0]->value);
-        } else {
-            // Find our rotation keyframes (Start and End)
-            int KeyframeEndIndex = 0;
-            for (; KeyframeEndIndex < keyframes.size(); KeyframeEndIndex++) {
-                if (keyframes[KeyframeEndIndex]->time > m_ElapsedTime) {
-                    break;
-                }
-            }
-
-            if (KeyframeEndIndex >= keyframes.size()) {
-                // we are at or past the last key frame use the last keyframe only
-                transform->SetRotation(keyframes[KeyframeEndIndex - 1]->value);
-                continue;
-            }
-
-            if (KeyframeEndIndex == 0) {
-                transform->SetRotation(keyframes[0]->value);
-                continue;
-            }
-
-            int KeyframeStartIndex = KeyframeEndIndex - 1;
-
-            RotationKeyframe* startKeyframe = keyframes[KeyframeStartIndex];
-            RotationKeyframe* endKeyFrame = keyframes[KeyframeEndIndex];
-
-            float percent = (m_ElapsedTime - startKeyframe->time) / (endKeyFrame->time - startKeyframe->time);
-            float factor = 0.f;
-            switch (endKeyFrame->easingType) {
-                case EasingType::Linear:
-                    factor = percent;
-                    break;
-
-                case EasingType::sineEaseIn:
-                    factor = glm::sineEaseIn(percent);
-                    break;
-
-                case EasingType::sineEaseOut:
-                    factor = glm::sineEaseOut(percent);
-                    break;
-
-                case EasingType::sineEaseInOut:
-                    factor = glm::sineEaseInOut(percent);
-                    break;
-            }
-
-            glm::quat interpolated = glm::slerp(startKeyframe->value, endKeyFrame->value, factor);
-            transform->SetRotation(interpolated);
+    FindSegments(clip.rotations, m_RotationCursors);
+    for (size_t i = 0; i < clip.rotations.tracks.size(); i++) {
+        const KeyframeSegment& segment = m_Segments[i];
+        glm::quat interpolated = glm::slerp(clip.rotations.values[segment.startKey],
+                                            clip.rotations.values[segment.endKey], segment.factor);
+        clip.rotations.tracks[i].xform->SetRotation(interpolated);
+    }
+}
+
+template <typename T>
+void AnimationSystem::FindSegments(const KeyframeChannel<T>& channel, std::vector<unsigned int>& cursors) {
+    size_t numTracks = channel.tracks.size();
+    m_Segments.resize(numTracks);
+    m_SegmentEasings.resize(numTracks);
+
+    const float* times = channel.times.empty() ? nullptr : &channel.times[0];
+
+    for (size_t i = 0; i < numTracks; i++) {
+        const KeyframeTrack& track = channel.tracks[i];
+        KeyframeSegment& segment = m_Segments[i];
+        const float* keys = times + track.firstKey;
+        unsigned int last = track.numKeys - 1;
+
+        // before the first or at/after the last key the track holds that key
+        if (m_ElapsedTime < keys[0] || m_ElapsedTime >= keys[last]) {
+            unsigned int key = m_ElapsedTime < keys[0] ? 0 : last;
+            segment.startKey = segment.endKey = track.firstKey + key;
+            segment.factor = 0.0f;
+            m_SegmentEasings[i] = EasingType::Linear;
+            continue;
         }
+
+        // keys[cursor] <= time < keys[cursor + 1], walk forward from last frame's segment, search only after a jump
+        unsigned int cursor = cursors[i];
+        if (cursor >= last || m_ElapsedTime < keys[cursor]) {
+            cursor = (unsigned int)(std::upper_bound(keys, keys + last, m_ElapsedTime) - keys) - 1;
+        }
+        while (m_ElapsedTime >= keys[cursor + 1]) cursor++;
+        cursors[i] = cursor;
+
+        segment.startKey = track.firstKey + cursor;
+        segment.endKey = segment.startKey + 1;
+        segment.factor = (m_ElapsedTime - keys[cursor]) / (keys[cursor + 1] - keys[cursor]);
+        m_SegmentEasings[i] = channel.easings[segment.endKey];
     }
+
+    EaseSegments(m_Segments, m_SegmentEasings);
 }
 
 void AnimationSystem::PlayPreviousClip() {
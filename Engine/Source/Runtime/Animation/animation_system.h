@@ -6,10 +6,33 @@
 
 namespace gdp1 {
 
+// The keys of one property of one transform, a contiguous range of the channel's key arrays sorted by time.
+struct KeyframeTrack {
+    Transform* xform;
+    unsigned int firstKey;
+    unsigned int numKeys;
+};
+
+// All tracks of one property in a clip, with the keys stored as flat arrays so a segment search only touches times.
+template <typename T>
+struct KeyframeChannel {
+    std::vector<KeyframeTrack> tracks;
+    std::vector<float> times;
+    std::vector<T> values;
+    std::vector<EasingType> easings;  // easing of the segment that ends at the key
+};
+
 struct AnimationClipRuntimeData {
-    std::unordered_map<Transform*, std::vector<PositionKeyframe*>> xformPositionKeyframesMap;
-    std::unordered_map<Transform*, std::vector<RotationKeyframe*>> xformRotationKeyframesMap;
-    std::unordered_map<Transform*, std::vector<ScaleKeyframe*>> xformScaleKeyframesMap;
+    KeyframeChannel<glm::vec3> positions;
+    KeyframeChannel<glm::quat> rotations;
+    KeyframeChannel<glm::vec3> scales;
+};
+
+// Where a track is sampled this frame: the two keys around the playback time and the eased factor between them.
+struct KeyframeSegment {
+    unsigned int startKey;
+    unsigned int endKey;
+    float factor;
 };
 
 class AnimationSystem {
@@ -31,6 +54,11 @@ public:
 private:
     void CreateRuntimeData();
     void SetCurrentClipIndex(size_t index);
+    void ResetCursors();
+
+    // Finds the segment of every track of a channel, then eases all segments in one pass.
+    template <typename T>
+    void FindSegments(const KeyframeChannel<T>& channel, std::vector<unsigned int>& cursors);
 
 private:
     Animation* m_Animation;  // original animation data
@@ -38,6 +66,15 @@ private:
     // animation runtime data
     std::vector<AnimationClipRuntimeData> m_AnimationClipRuntimeData;
 
+    // last segment found per track of the current clip, playback moves forward so the search resumes from here
+    std::vector<unsigned int> m_PositionCursors;
+    std::vector<unsigned int> m_RotationCursors;
+    std::vector<unsigned int> m_ScaleCursors;
+
+    // per track of the channel being sampled
+    std::vector<KeyframeSegment> m_Segments;
+    std::vector<EasingType> m_SegmentEasings;
+
     size_t m_CurrentClipIndex = 0;
     float m_ElapsedTime = 0.0f;
     float m_PlaySpeed = 1.0f;
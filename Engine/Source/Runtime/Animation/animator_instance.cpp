@@ -0,0 +1,220 @@
+#include "animator_instance.h"
+
+#include "character_animation.h"
+#include "Render/model.h"
+
+namespace gdp1 {
+
+AnimatorInstance::AnimatorInstance(Model* model)
+    : m_Model(model) {}
+
+bool AnimatorInstance::Play(const std::string& clipName) {
+    m_Tree = nullptr;
+
+    int clip = m_Model->FindAnimation(clipName);
+    if (clip < 0) {
+        m_CurrentClip = -1;
+        return false;
+    }
+
+    // fade out of whatever is showing now, the first clip has nothing to fade from
+    if (m_CurrentClip >= 0) {
+        m_PrevClip = m_CurrentClip;
+        m_PrevCursors.swap(m_CurrentCursors);
+    } else {
+        m_PrevClip = clip;
+        m_PrevCursors.assign(m_Model->animations[clip]->clip.GetTrackCount(), TrackCursor());
+    }
+
+    m_CurrentClip = clip;
+    m_CurrentCursors.assign(m_Model->animations[clip]->clip.GetTrackCount(), TrackCursor());
+    m_BlendFactor = 0.0f;
+
+    return true;
+}
+
+void AnimatorInstance::SetBlendTree(const BlendTree* tree) {
+    m_Tree = tree;
+    m_CurrentClip = m_PrevClip = -1;
+    m_Ops.clear();
+
+    if (tree == nullptr) return;
+
+    m_Parameters = tree->GetDefaultParameters();
+    m_TreePhases.assign(tree->GetNodeCount(), 0.0f);
+    m_TreeCursors.resize(tree->GetNodeCount());
+    for (unsigned int i = 0; i < tree->GetNodeCount(); i++) {
+        const BlendNode& node = tree->GetNode(i);
+        unsigned int numTracks = node.clip >= 0 ? m_Model->animations[node.clip]->clip.GetTrackCount() : 0;
+        m_TreeCursors[i].assign(numTracks, TrackCursor());
+    }
+}
+
+void AnimatorInstance::SetParameter(int index, float value) {
+    if (index >= 0 && index < (int)m_Parameters.size()) m_Parameters[index] = value;
+}
+
+bool AnimatorInstance::SetParameter(const std::string& name, float value) {
+    int index = m_Tree != nullptr ? m_Tree->FindParameter(name) : -1;
+    if (index < 0) return false;
+
+    SetParameter(index, value);
+    return true;
+}
+
+float AnimatorInstance::GetParameter(int index) const {
+    return index >= 0 && index < (int)m_Parameters.size() ? m_Parameters[index] : 0.0f;
+}
+
+void AnimatorInstance::Update(float deltaTime) {
+    if (m_Tree != nullptr) {
+        float* parameters = m_Parameters.empty() ? nullptr : &m_Parameters[0];
+        float* phases = m_TreePhases.empty() ? nullptr : &m_TreePhases[0];
+        std::vector<TrackCursor>* cursors = m_TreeCursors.empty() ? nullptr : &m_TreeCursors[0];
+        m_Tree->Compile(parameters, deltaTime, phases, cursors, m_Ops);
+        m_RootMotion += BlendTree::EvaluateRootMotion(m_Ops.empty() ? nullptr : &m_Ops[0], (unsigned int)m_Ops.size());
+        return;
+    }
+
+    if (m_CurrentClip < 0) return;
+
+    m_ElapsedTime += deltaTime;
+
+    if (m_BlendFactor < 1.0f) {
+        m_BlendFactor += deltaTime / blendDuration;
+    }
+
+    if (m_BlendFactor > 1.0f) {
+        m_BlendFactor = 1.0f;
+        m_PrevClip = m_CurrentClip;
+    }
+
+    // a cross-fade is the smallest blend tree: two samples and a blend, once it is done only the end clip is left
+    const CharacterAnimation* startAnimation = m_Model->animations[m_PrevClip];
+    const CharacterAnimation* endAnimation = m_Model->animations[m_CurrentClip];
+
+    m_Ops.clear();
+
+    float prevTime = m_ElapsedTime - deltaTime;
+
+    if (m_BlendFactor < 1.0f && startAnimation != endAnimation) {
+        BlendOp start = {BlendOp::Sample,
+                         startAnimation,
+                         startAnimation->calcAnimationTimeTicks(m_ElapsedTime),
+                         startAnimation->calcAnimationTimeTicks(prevTime),
+                         m_PrevCursors.empty() ? nullptr : &m_PrevCursors[0],
+                         1.0f,
+                         nullptr};
+        m_Ops.push_back(start);
+    }
+
+    BlendOp end = {BlendOp::Sample,
+                   endAnimation,
+                   endAnimation->calcAnimationTimeTicks(m_ElapsedTime),
+                   endAnimation->calcAnimationTimeTicks(prevTime),
+                   m_CurrentCursors.empty() ? nullptr : &m_CurrentCursors[0],
+                   1.0f,
+                   nullptr};
+    m_Ops.push_back(end);
+
+    if (m_Ops.size() > 1) {
+        BlendOp blend = {BlendOp::Blend, nullptr, 0.0f, 0.0f, nullptr, m_BlendFactor, nullptr};
+        m_Ops.push_back(blend);
+    }
+
+    m_RootMotion += BlendTree::EvaluateRootMotion(&m_Ops[0], (unsigned int)m_Ops.size());
+}
+
+glm::vec3 AnimatorInstance::ConsumeRootMotion() {
+    glm::vec3 motion = m_RootMotion;
+    m_RootMotion = glm::vec3(0.0f);
+    return motion;
+}
+
+void AnimatorInstance::EvaluatePose(glm::mat4* boneTransforms, AnimationLOD lod, unsigned int phase) {
+    if (!IsPlaying()) return;
+
+    AnimationLOD prevLOD = m_LOD;
+    m_LOD = lod;
+
+    if (lod == AnimationLOD::Hidden) return;
+
+    if (lod == AnimationLOD::Full) {
+        EvaluatePose(boneTransforms);
+        return;
+    }
+
+    unsigned int level = static_cast<unsigned int>(lod);
+    unsigned int interval = 1u << level;
+    unsigned int numBones = m_Model->skeleton.GetBoneCount();
+
+    if (prevLOD == AnimationLOD::Full || prevLOD == AnimationLOD::Hidden || m_PoseTo.size() != numBones) {
+        // nothing usable cached, start from a fresh pose and stagger the next evaluation
+        m_PoseTo.resize(numBones);
+        EvaluatePose(reinterpret_cast<glm::mat4*>(&m_PoseTo[0]), level);
+        m_PoseFrom = m_PoseTo;
+        m_LODFrame = phase % interval;
+    } else if (m_LODFrame >= interval) {
+        m_PoseFrom.swap(m_PoseTo);
+        EvaluatePose(reinterpret_cast<glm::mat4*>(&m_PoseTo[0]), level);
+        m_LODFrame = 0;
+    }
+
+    m_LODFrame++;
+
+    // a component-wise blend of the skinning matrices is close enough over a few frames
+    float alpha = glm::min(1.0f, (float)m_LODFrame / (float)interval);
+    for (unsigned int i = 0; i < numBones; i++) {
+        boneTransforms[i] = m_PoseFrom[i] + (m_PoseTo[i] - m_PoseFrom[i]) * alpha;
+    }
+}
+
+void AnimatorInstance::EvaluatePose(glm::mat4* boneTransforms, unsigned int skipHeight) {
+    if (!IsPlaying()) return;
+
+    const Skeleton& skeleton = m_Model->skeleton;
+    unsigned int numNodes = skeleton.GetNodeCount();
+
+    m_NodeGlobals.resize(numNodes);
+
+    const BlendOp* ops = m_Ops.empty() ? nullptr : &m_Ops[0];
+    unsigned int numOps = (unsigned int)m_Ops.size();
+
+    // parents come before their children, so one forward pass resolves the whole hierarchy
+    for (unsigned int i = 0; i < numNodes; i++) {
+        glm::aligned_mat4 local;
+
+        bool animated = false;
+        if (skeleton.heights[i] >= skipHeight) {
+            for (unsigned int op = 0; op < numOps && !animated; op++) {
+                animated = ops[op].type == BlendOp::Sample && ops[op].animation != nullptr &&
+                           ops[op].animation->nodeTracks[i] >= 0;
+            }
+        }
+
+        if (!animated) {
+            local = skeleton.bindLocals[i];
+        } else {
+            glm::vec3 translation, scaling;
+            glm::quat rotation;
+            BlendTree::Evaluate(skeleton, i, ops, numOps, translation, rotation, scaling);
+
+            // T * R * S
+            local = glm::mat4_cast(rotation);
+            local[0] *= scaling.x;
+            local[1] *= scaling.y;
+            local[2] *= scaling.z;
+            local[3] = glm::vec4(translation, 1.0f);
+        }
+
+        int parent = skeleton.parents[i];
+        m_NodeGlobals[i] = parent < 0 ? local : m_NodeGlobals[parent] * local;
+
+        int bone = skeleton.boneSlots[i];
+        if (bone >= 0) {
+            boneTransforms[bone] = skeleton.globalInverse * m_NodeGlobals[i] * skeleton.boneOffsets[bone];
+        }
+    }
+}
+
+}  // namespace gdp1
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_aligned.hpp>
+
+#include "skeletal_clip.h"
+#include "blend_tree.h"
+
+namespace gdp1 {
+
+class Model;
+
+// How much pose work a character gets this frame.
+// Half and Quarter evaluate every 2nd/4th frame, interpolate the frames in between and keep the leaf bones (fingers,
+// face) at their bind pose. Hidden characters only advance their time.
+enum class AnimationLOD { Full = 0, Half = 1, Quarter = 2, Hidden = 3 };
+
+// The playback state of one animated game object.
+// The model only holds immutable data (skeleton, compiled clips and blend trees), everything that changes while
+// playing lives here, so any number of game objects can share one model and still animate independently.
+// Either a single clip with a cross-fade or a blend tree drives the pose, both are turned into a BlendOp list by
+// Update and evaluated the same way.
+class AnimatorInstance {
+public:
+    AnimatorInstance(Model* model);
+
+    // Cross-fades from the current clip to the named one and stops the blend tree. Returns false if the model has
+    // no such clip.
+    bool Play(const std::string& clipName);
+
+    // Lets a blend tree of the model drive the pose, starting from its default parameters. nullptr goes back to
+    // plain clip playback.
+    void SetBlendTree(const BlendTree* tree);
+    const BlendTree* GetBlendTree() const { return m_Tree; }
+
+    // Blend tree parameters, look the index up once with BlendTree::FindParameter.
+    void SetParameter(int index, float value);
+    // Returns false if the blend tree has no such parameter.
+    bool SetParameter(const std::string& name, float value);
+    float GetParameter(int index) const;
+
+    // Advances time and the cross-fade, compiles the blend ops for this frame and adds the frame's root motion.
+    void Update(float deltaTime);
+
+    // Root motion in model space accumulated by Update since the last call.
+    glm::vec3 ConsumeRootMotion();
+
+    // Writes one skinning matrix per bone of the model's skeleton to boneTransforms.
+    // Nodes with fewer than skipHeight levels below them are not sampled and keep their bind pose.
+    void EvaluatePose(glm::mat4* boneTransforms, unsigned int skipHeight = 0);
+
+    // Same as EvaluatePose but at the update rate of the given LOD. The frames between two evaluations are
+    // interpolated from the last two evaluated poses. phase staggers the evaluation frames of different characters.
+    // Hidden writes nothing, it only drops the cached poses so they are rebuilt once the character is visible again.
+    void EvaluatePose(glm::mat4* boneTransforms, AnimationLOD lod, unsigned int phase);
+
+    bool IsPlaying() const { return m_CurrentClip >= 0 || m_Tree != nullptr; }
+    int GetCurrentClip() const { return m_CurrentClip; }
+    float GetBlendFactor() const { return m_BlendFactor; }
+
+public:
+    float blendDuration = 0.4f;
+
+private:
+    Model* m_Model;
+
+    int m_CurrentClip = -1;
+    int m_PrevClip = -1;
+
+    float m_ElapsedTime = 0.0f;
+    float m_BlendFactor = 1.0f;
+
+    // keyframe cursors of the previous and the current clip
+    std::vector<TrackCursor> m_PrevCursors;
+    std::vector<TrackCursor> m_CurrentCursors;
+
+    // blend tree state, one phase and cursor set per tree node
+    const BlendTree* m_Tree = nullptr;
+    std::vector<float> m_Parameters;
+    std::vector<float> m_TreePhases;
+    std::vector<std::vector<TrackCursor>> m_TreeCursors;
+
+    // what EvaluatePose runs for every skeleton node
+    std::vector<BlendOp> m_Ops;
+
+    glm::vec3 m_RootMotion = glm::vec3(0.0f);
+
+    // world transforms of the skeleton nodes
+    std::vector<glm::aligned_mat4> m_NodeGlobals;
+
+    // the last two poses evaluated at a reduced rate
+    AnimationLOD m_LOD = AnimationLOD::Full;
+    unsigned int m_LODFrame = 0;
+    std::vector<glm::aligned_mat4> m_PoseFrom;
+    std::vector<glm::aligned_mat4> m_PoseTo;
+};
+
+}  // namespace gdp1
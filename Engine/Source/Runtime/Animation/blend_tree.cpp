@@ -0,0 +1,354 @@
+#include "blend_tree.h"
+
+#include <algorithm>
+
+#include "character_animation.h"
+#include "skeleton.h"
+#include "Render/model.h"
+
+namespace gdp1 {
+
+const int BlendTree::MAX_DEPTH;
+
+BlendTree::BlendTree(Model* model)
+    : m_Model(model) {}
+
+int BlendTree::AddParameter(const std::string& name, float defaultValue) {
+    int index = FindParameter(name);
+    if (index >= 0) {
+        m_Defaults[index] = defaultValue;
+        return index;
+    }
+
+    m_ParameterNames.push_back(name);
+    m_Defaults.push_back(defaultValue);
+    return (int)m_ParameterNames.size() - 1;
+}
+
+int BlendTree::FindParameter(const std::string& name) const {
+    for (size_t i = 0; i < m_ParameterNames.size(); i++) {
+        if (m_ParameterNames[i] == name) return (int)i;
+    }
+
+    return -1;
+}
+
+int BlendTree::AddMask(const std::string& rootNode) {
+    const Skeleton& skeleton = m_Model->skeleton;
+
+    int root = skeleton.FindNode(rootNode);
+    if (root < 0) {
+        LOG_WARN("Blend tree mask root {0} is not in the skeleton", rootNode);
+        return -1;
+    }
+
+    // descendants follow their ancestors in the flattened skeleton
+    std::vector<float> mask(skeleton.GetNodeCount(), 0.0f);
+    mask[root] = 1.0f;
+    for (unsigned int i = root + 1; i < skeleton.GetNodeCount(); i++) {
+        int parent = skeleton.parents[i];
+        if (parent >= 0 && mask[parent] > 0.0f) mask[i] = 1.0f;
+    }
+
+    m_Masks.push_back(mask);
+    return (int)m_Masks.size() - 1;
+}
+
+int BlendTree::AddNode(const BlendNode& node) {
+    m_Nodes.push_back(node);
+    if (m_Root < 0) m_Root = (int)m_Nodes.size() - 1;
+    return (int)m_Nodes.size() - 1;
+}
+
+bool BlendTree::Validate(std::string& error) const {
+    if (m_Root < 0 || m_Root >= (int)m_Nodes.size()) {
+        error = "the root is not a node of the tree";
+        return false;
+    }
+
+    std::vector<char> state(m_Nodes.size(), 0);
+    return ValidateNode(m_Root, state, error);
+}
+
+bool BlendTree::ValidateNode(int node, std::vector<char>& state, std::string& error) const {
+    if (state[node] == 1) {
+        error = "node " + std::to_string(node) + " is its own ancestor";
+        return false;
+    }
+    if (state[node] == 2) return true;
+
+    const BlendNode& n = m_Nodes[node];
+    if (n.type != BlendNodeType::Clip && n.children.empty()) {
+        error = "node " + std::to_string(node) + " has no children";
+        return false;
+    }
+    if (n.type == BlendNodeType::Blend1D && n.thresholds.size() != n.children.size()) {
+        error = "blend node " + std::to_string(node) + " needs one threshold per child";
+        return false;
+    }
+
+    state[node] = 1;
+    for (int child : n.children) {
+        if (child < 0 || child >= (int)m_Nodes.size()) {
+            error = "node " + std::to_string(node) + " has a child index out of range";
+            return false;
+        }
+        if (!ValidateNode(child, state, error)) return false;
+    }
+    state[node] = 2;
+    return true;
+}
+
+void BlendTree::Compile(const float* parameters, float deltaTime, float* phases, std::vector<TrackCursor>* cursors,
+                        std::vector<BlendOp>& ops) const {
+    ops.clear();
+    if (m_Root < 0) return;
+
+    CompileNode(m_Root, parameters, deltaTime, -1.0f, -1.0f, phases, cursors, ops);
+
+    // every Sample pushes and every other op pops two and pushes one, make sure Evaluate stays inside its stack
+    int depth = 0;
+    for (const BlendOp& op : ops) {
+        if (op.type != BlendOp::Sample && depth < 2) {
+            LOG_ERROR("Blend tree combines poses it has not sampled");
+            ops.clear();
+            return;
+        }
+
+        depth += op.type == BlendOp::Sample ? 1 : -1;
+        if (depth > MAX_DEPTH) {
+            LOG_ERROR("Blend tree is deeper than {0} levels", MAX_DEPTH);
+            ops.clear();
+            return;
+        }
+    }
+}
+
+void BlendTree::Evaluate(const Skeleton& skeleton, unsigned int node, const BlendOp* ops, unsigned int numOps,
+                         glm::vec3& translation, glm::quat& rotation, glm::vec3& scaling) {
+    glm::vec3 translations[MAX_DEPTH];
+    glm::quat rotations[MAX_DEPTH];
+    glm::vec3 scalings[MAX_DEPTH];
+    int top = 0;
+
+    const glm::vec3& bindTranslation = skeleton.bindTranslations[node];
+    const glm::quat& bindRotation = skeleton.bindRotations[node];
+    const glm::vec3& bindScaling = skeleton.bindScalings[node];
+
+    for (unsigned int i = 0; i < numOps; i++) {
+        const BlendOp& op = ops[i];
+
+        if (op.type == BlendOp::Sample) {
+            if (op.animation != nullptr) {
+                op.animation->calcLocalTransform(skeleton, node, op.ticks, op.cursors, translations[top],
+                                                 rotations[top], scalings[top]);
+            } else {
+                translations[top] = bindTranslation;
+                rotations[top] = bindRotation;
+                scalings[top] = bindScaling;
+            }
+            top++;
+            continue;
+        }
+
+        // Compile never emits such a list, stop rather than read outside the stack
+        if (top < 2) break;
+
+        top--;
+        int a = top - 1;
+        int b = top;
+
+        switch (op.type) {
+            case BlendOp::Blend:
+            case BlendOp::Layer: {
+                float weight = op.mask != nullptr ? op.weight * op.mask[node] : op.weight;
+                if (weight <= 0.0f) break;
+
+                translations[a] = glm::mix(translations[a], translations[b], weight);
+                rotations[a] = glm::slerp(rotations[a], rotations[b], weight);
+                scalings[a] = glm::mix(scalings[a], scalings[b], weight);
+                break;
+            }
+            case BlendOp::Additive: {
+                // the additive clip is applied as its difference to the bind pose
+                glm::quat delta = glm::inverse(bindRotation) * rotations[b];
+
+                translations[a] += (translations[b] - bindTranslation) * op.weight;
+                rotations[a] = glm::normalize(rotations[a] * glm::slerp(glm::quat(1.0f, 0.0f, 0.0f, 0.0f), delta,
+                                                                        op.weight));
+                scalings[a] *= glm::mix(glm::vec3(1.0f), scalings[b] / bindScaling, op.weight);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    if (top > 0) {
+        translation = translations[0];
+        rotation = rotations[0];
+        scaling = scalings[0];
+    } else {
+        translation = bindTranslation;
+        rotation = bindRotation;
+        scaling = bindScaling;
+    }
+}
+
+glm::vec3 BlendTree::EvaluateRootMotion(const BlendOp* ops, unsigned int numOps) {
+    glm::vec3 motions[MAX_DEPTH];
+    int top = 0;
+
+    for (unsigned int i = 0; i < numOps; i++) {
+        const BlendOp& op = ops[i];
+
+        if (op.type == BlendOp::Sample) {
+            motions[top++] = op.animation != nullptr ? op.animation->calcRootMotion(op.prevTicks, op.ticks)
+                                                     : glm::vec3(0.0f);
+            continue;
+        }
+
+        if (top < 2) break;
+
+        top--;
+        int a = top - 1;
+        int b = top;
+
+        switch (op.type) {
+            case BlendOp::Blend:
+                motions[a] = glm::mix(motions[a], motions[b], op.weight);
+                break;
+            case BlendOp::Layer:
+                if (op.mask == nullptr) motions[a] = glm::mix(motions[a], motions[b], op.weight);
+                break;
+            case BlendOp::Additive:
+                motions[a] += motions[b] * op.weight;
+                break;
+            default:
+                break;
+        }
+    }
+
+    return top > 0 ? motions[0] : glm::vec3(0.0f);
+}
+
+float BlendTree::GetLength(int node, const float* parameters) const {
+    const BlendNode& n = m_Nodes[node];
+
+    switch (n.type) {
+        case BlendNodeType::Clip: {
+            if (n.clip < 0) return 0.0f;
+
+            const CharacterAnimation* animation = m_Model->animations[n.clip];
+            float ticksPerSecond = animation->ticks_per_second != 0.0f ? animation->ticks_per_second : 25.0f;
+            return floorf(animation->duration) / ticksPerSecond;
+        }
+        case BlendNodeType::Blend1D: {
+            unsigned int lower;
+            float t;
+            FindSegment(n, parameters, lower, t);
+
+            float length = GetLength(n.children[lower], parameters);
+            if (t > 0.0f) length = glm::mix(length, GetLength(n.children[lower + 1], parameters), t);
+            return length;
+        }
+        default:
+            return n.children.empty() ? 0.0f : GetLength(n.children[0], parameters);
+    }
+}
+
+void BlendTree::FindSegment(const BlendNode& node, const float* parameters, unsigned int& lower, float& t) const {
+    lower = 0;
+    t = 0.0f;
+
+    unsigned int count = (unsigned int)std::min(node.children.size(), node.thresholds.size());
+    if (count < 2 || node.parameter < 0) return;
+
+    float value = parameters[node.parameter];
+    if (value <= node.thresholds[0]) return;
+
+    if (value >= node.thresholds[count - 1]) {
+        lower = count - 1;
+        return;
+    }
+
+    while (lower + 2 < count && value >= node.thresholds[lower + 1]) lower++;
+
+    float range = node.thresholds[lower + 1] - node.thresholds[lower];
+    t = range > 0.0f ? (value - node.thresholds[lower]) / range : 1.0f;
+}
+
+void BlendTree::CompileNode(int node, const float* parameters, float deltaTime, float syncPhase, float prevSyncPhase,
+                            float* phases, std::vector<TrackCursor>* cursors, std::vector<BlendOp>& ops) const {
+    const BlendNode& n = m_Nodes[node];
+
+    // nodes that are not synced to a parent run through their own cycle
+    float phase = syncPhase;
+    float prevPhase = prevSyncPhase;
+    if (phase < 0.0f && (n.type == BlendNodeType::Clip || n.type == BlendNodeType::Blend1D)) {
+        prevPhase = phases[node];
+        float length = GetLength(node, parameters);
+        if (length > 0.0f) phases[node] += deltaTime / length;
+        phases[node] -= floorf(phases[node]);
+        phase = phases[node];
+    }
+
+    switch (n.type) {
+        case BlendNodeType::Clip: {
+            // a clip the model does not have samples as the bind pose
+            const CharacterAnimation* animation = n.clip >= 0 ? m_Model->animations[n.clip] : nullptr;
+
+            BlendOp op;
+            op.type = BlendOp::Sample;
+            op.animation = animation;
+            op.ticks = animation != nullptr ? phase * floorf(animation->duration) : 0.0f;
+            op.prevTicks = animation != nullptr ? prevPhase * floorf(animation->duration) : 0.0f;
+            op.cursors = cursors[node].empty() ? nullptr : &cursors[node][0];
+            op.weight = 1.0f;
+            op.mask = nullptr;
+            ops.push_back(op);
+            break;
+        }
+        case BlendNodeType::Blend1D: {
+            if (n.children.empty()) break;
+
+            unsigned int lower;
+            float t;
+            FindSegment(n, parameters, lower, t);
+
+            // only the two children around the parameter contribute
+            CompileNode(n.children[lower], parameters, deltaTime, phase, prevPhase, phases, cursors, ops);
+            if (t > 0.0f) {
+                CompileNode(n.children[lower + 1], parameters, deltaTime, phase, prevPhase, phases, cursors, ops);
+
+                BlendOp op = {BlendOp::Blend, nullptr, 0.0f, 0.0f, nullptr, t, nullptr};
+                ops.push_back(op);
+            }
+            break;
+        }
+        case BlendNodeType::Additive:
+        case BlendNodeType::Layer: {
+            if (n.children.empty()) break;
+
+            CompileNode(n.children[0], parameters, deltaTime, syncPhase, prevSyncPhase, phases, cursors, ops);
+
+            float weight = n.parameter >= 0 ? glm::clamp(parameters[n.parameter], 0.0f, 1.0f) : 1.0f;
+            if (weight <= 0.0f || n.children.size() < 2) break;
+
+            CompileNode(n.children[1], parameters, deltaTime, -1.0f, -1.0f, phases, cursors, ops);
+
+            BlendOp op;
+            op.type = n.type == BlendNodeType::Additive ? BlendOp::Additive : BlendOp::Layer;
+            op.animation = nullptr;
+            op.ticks = 0.0f;
+            op.prevTicks = 0.0f;
+            op.cursors = nullptr;
+            op.weight = weight;
+            op.mask = n.mask >= 0 ? &m_Masks[n.mask][0] : nullptr;
+            ops.push_back(op);
+            break;
+        }
+    }
+}
+
+}  // namespace gdp1
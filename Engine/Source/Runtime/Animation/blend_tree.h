@@ -0,0 +1,112 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "skeletal_clip.h"
+
+namespace gdp1 {
+
+class Model;
+class Skeleton;
+class CharacterAnimation;
+
+enum class BlendNodeType { Clip, Blend1D, Additive, Layer };
+
+struct BlendNode {
+    BlendNodeType type = BlendNodeType::Clip;
+    int clip = -1;                  // Clip: index into Model::animations
+    int parameter = -1;             // Blend1D: the blended value, Additive/Layer: weight of the second child
+    std::vector<int> children;      // Additive/Layer: base first
+    std::vector<float> thresholds;  // Blend1D: parameter value of each child, ascending
+    int mask = -1;                  // Layer: index into the tree's masks, -1 for the whole skeleton
+};
+
+// One step of a compiled blend tree. The same op list is run for every skeleton node on a small stack of local
+// transforms: Sample pushes, the other ops pop two entries and push the combined one.
+struct BlendOp {
+    enum Type { Sample, Blend, Additive, Layer };
+
+    Type type;
+    const CharacterAnimation* animation;  // Sample
+    float ticks;                          // Sample
+    float prevTicks;                      // Sample: where the last frame sampled, for root motion
+    TrackCursor* cursors;                 // Sample
+    float weight;                         // Blend, Additive, Layer
+    const float* mask;                    // Layer: weight per skeleton node, nullptr for all nodes
+};
+
+// A data driven description of how a model's clips are combined: N-way 1D blend spaces, additive layers and layers
+// restricted to a part of the skeleton by a mask (e.g. upper body attacking over lower body walking).
+// The tree is immutable and shared by every AnimatorInstance of the model, which hold the parameters, clip phases and
+// keyframe cursors. Each frame the tree is compiled into a flat BlendOp list with the zero weight branches pruned,
+// and the op list is evaluated in one pass over the flattened skeleton.
+class BlendTree {
+public:
+    static const int MAX_DEPTH = 16;
+
+    BlendTree(Model* model);
+
+    int AddParameter(const std::string& name, float defaultValue = 0.0f);
+    // Returns -1 if the tree has no such parameter.
+    int FindParameter(const std::string& name) const;
+
+    // A mask covering the named skeleton node and everything below it. Returns -1 if the skeleton has no such node.
+    int AddMask(const std::string& rootNode);
+
+    int AddNode(const BlendNode& node);
+    void SetRoot(int node) { m_Root = node; }
+
+    unsigned int GetNodeCount() const { return static_cast<unsigned int>(m_Nodes.size()); }
+    const BlendNode& GetNode(unsigned int node) const { return m_Nodes[node]; }
+    const std::vector<float>& GetDefaultParameters() const { return m_Defaults; }
+
+    // Checks that the nodes reachable from the root form a tree Compile can run: children in range and no cycles,
+    // every blend, additive and layer node has a child, and a blend space has a threshold per child.
+    // Returns false and describes the first problem in error otherwise.
+    bool Validate(std::string& error) const;
+
+    // Builds the op list for the given parameters and advances the playback phase of every active node.
+    // phases and cursors hold one entry per tree node and belong to the animator instance.
+    void Compile(const float* parameters, float deltaTime, float* phases, std::vector<TrackCursor>* cursors,
+                 std::vector<BlendOp>& ops) const;
+
+    // Runs the op list for one skeleton node.
+    static void Evaluate(const Skeleton& skeleton, unsigned int node, const BlendOp* ops, unsigned int numOps,
+                         glm::vec3& translation, glm::quat& rotation, glm::vec3& scaling);
+
+    // Runs the op list on the root motion of the sampled clips, in model space. Masked layers only move part of the
+    // body and contribute nothing.
+    static glm::vec3 EvaluateRootMotion(const BlendOp* ops, unsigned int numOps);
+
+private:
+    // depth first from node, state is 0 for unvisited, 1 while on the current path and 2 when done
+    bool ValidateNode(int node, std::vector<char>& state, std::string& error) const;
+
+    // length of one cycle of the node in seconds for the current parameters
+    float GetLength(int node, const float* parameters) const;
+
+    // segment of a Blend1D node the parameter falls into, t is the weight of the upper child
+    void FindSegment(const BlendNode& node, const float* parameters, unsigned int& lower, float& t) const;
+
+    // syncPhase < 0 lets the node run on its own phase, children of a blend space are kept in step with it.
+    // prevSyncPhase is where the synced phase was last frame.
+    void CompileNode(int node, const float* parameters, float deltaTime, float syncPhase, float prevSyncPhase,
+                     float* phases, std::vector<TrackCursor>* cursors, std::vector<BlendOp>& ops) const;
+
+private:
+    Model* m_Model;
+
+    int m_Root = -1;
+    std::vector<BlendNode> m_Nodes;
+
+    std::vector<std::string> m_ParameterNames;
+    std::vector<float> m_Defaults;
+
+    std::vector<std::vector<float>> m_Masks;
+};
+
+}  // namespace gdp1
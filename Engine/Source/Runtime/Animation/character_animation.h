@@ -1,42 +1,25 @@
 #pragma once
 
 #include "Render/model.h"
+#include "skeletal_clip.h"
+#include "skeleton.h"
 
 #include <string>
 #include <vector>
 #include <map>
 
-// #include "stb_image.h"
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-
 namespace gdp1 {
 
 class Model;
 
-struct LocalTransform {
-    aiVector3D Scaling;
-    aiQuaternion Rotation;
-    aiVector3D Translation;
-};
-
-struct NodeInfo {
-    NodeInfo() {}
-
-    NodeInfo(const aiNode* n) { pNode = n; }
-
-    const aiNode* pNode = NULL;
-    bool isRequired = false;
-};
-
+// One clip of a skinned model.
+// The first load imports the FBX with assimp, compresses the clip and writes it next to the source as <file>.clip.
+// Later loads map the .clip file and never touch assimp.
 class CharacterAnimation {
 public:
     CharacterAnimation(const std::string& file, const std::string& name, Model* model);
     ~CharacterAnimation();
 
-    Assimp::Importer importer;
-    const aiScene* scene;
-
     static const unsigned int MAX_BONES = 100;
 
     float ticks_per_second = 0.0f;
@@ -44,40 +27,32 @@ public:
 
     float elapsedTime = 0.0f;
 
-    aiNode* mRootNode;
-
-    unsigned int findPosition(float p_animation_time, const aiNodeAnim* p_node_anim);
-    unsigned int findRotation(float p_animation_time, const aiNodeAnim* p_node_anim);
-    unsigned int findScaling(float p_animation_time, const aiNodeAnim* p_node_anim);
-    const aiNodeAnim* findNodeAnim(const aiAnimation* p_animation, const std::string p_node_name);
+    // Wraps the playback time into the clip, in ticks.
+    float calcAnimationTimeTicks(float timeInSeconds) const;
 
-    // calculate transform matrix
-    void calcInterpolatedPosition(aiVector3D& out, float p_animation_time, const aiNodeAnim* p_node_anim);
-    void calcInterpolatedRotation(aiQuaternion& out, float p_animation_time, const aiNodeAnim* p_node_anim);
-    void calcInterpolatedScaling(aiVector3D& out, float p_animation_time, const aiNodeAnim* p_node_anim);
+    // Samples the clip for a skeleton node, falling back to the bind pose if the clip does not animate it.
+    // cursors holds one TrackCursor per track of this clip and belongs to the caller.
+    void calcLocalTransform(const Skeleton& skeleton, unsigned int node, float animationTimeTicks,
+                            TrackCursor* cursors, glm::vec3& translation, glm::quat& rotation,
+                            glm::vec3& scaling) const;
 
-    void readNodeHierarchy(float p_animation_time, const aiNode* p_node, const aiMatrix4x4 parent_transform);
-    void boneTransform(double time_in_sec, std::vector<aiMatrix4x4>& transforms);
+    // Resolves the clip's tracks against the model's skeleton nodes. Called once when the clip is added to the model,
+    // so sampling never looks up a track by name.
+    void bindSkeleton(const Skeleton& skeleton);
 
-    void boneTransformsBlended(float TimeInSeconds, std::vector<aiMatrix4x4>& blendedTransforms,
-                               unsigned int startAnimIndex, unsigned int endAnimIndex, float blendFactor);
+    // Root movement between two playback times in model space, see SkeletalClip::GetRootMotion.
+    glm::vec3 calcRootMotion(float fromTicks, float toTicks) const;
 
-    void readNodeHierarchyBlended(float startAnimationTimeTicks, float endAnimationTimeTicks, const aiNode* pNode,
-                                  const aiMatrix4x4& parentTransform, const aiAnimation& startAnimation,
-                                  const aiAnimation& endAnimation, float blendFactor);
+    // the compressed keyframes of the file's first animation
+    SkeletalClip clip;
 
-    float calcAnimationTimeTicks(float timeInSeconds, unsigned int animationIndex);
-    void calcLocalTransform(LocalTransform& transform, float animationTimeTicks, const aiNodeAnim* nodeAnim);
+    // track index per skeleton node, -1 if the clip does not animate the node
+    std::vector<int> nodeTracks;
 
-    glm::mat4 aiToGlm(aiMatrix4x4 ai_matr);
-    aiQuaternion nlerp(aiQuaternion a, aiQuaternion b, float blend);
-
-    std::map<std::string, NodeInfo> m_requiredNodeMap;
+    // from the space of the root motion node's parent to model space, in bind pose
+    glm::mat3 rootMotionSpace = glm::mat3(1.0f);
 
     Model* model;
-
-    CharacterAnimation* getAnimationByIndex(std::map<std::string, CharacterAnimation*>& animations, int index);
-
 };
 
 }  // namespace gdp1
@@ -0,0 +1,81 @@
+#include "pose_system.h"
+
+#include "Core/game_object.h"
+#include "Core/job_system.h"
+#include "Physics/bounds.h"
+#include "Render/model.h"
+#include "Render/renderer.h"
+
+namespace gdp1 {
+
+PoseSystem::PoseSystem()
+    : m_LODCounts() {}
+
+void PoseSystem::Update(RenderList& renderList, float deltaTime) {
+    m_Animated.clear();
+    m_LODs.clear();
+    m_LODCounts[0] = m_LODCounts[1] = m_LODCounts[2] = m_LODCounts[3] = 0;
+
+    // assign every animated item its slice of the palette first, so the workers never resize it
+    unsigned int numBones = 0;
+    for (RenderItem& item : renderList.items) {
+        item.boneOffset = 0;
+        item.boneCount = 0;
+
+        GameObject* go = item.gameObject;
+        if (go->hasSoftBody || go->animator == nullptr || !go->animator->IsPlaying()) continue;
+
+        item.boneOffset = numBones;
+        item.boneCount = go->model->skeleton.GetBoneCount();
+        numBones += item.boneCount;
+
+        AnimationLOD lod = SelectLOD(renderList, item);
+        m_LODCounts[static_cast<int>(lod)]++;
+
+        m_Animated.push_back(&item);
+        m_LODs.push_back(lod);
+    }
+
+    // characters outside the view keep their clocks running so they are in step when they come back
+    for (GameObject* go : renderList.hiddenAnimated) {
+        go->animator->Update(deltaTime);
+        go->animator->EvaluatePose(nullptr, AnimationLOD::Hidden, 0);
+    }
+    m_LODCounts[static_cast<int>(AnimationLOD::Hidden)] = static_cast<unsigned int>(renderList.hiddenAnimated.size());
+
+    renderList.bonePalette.resize(numBones);
+    if (m_Animated.empty()) return;
+
+    glm::mat4* palette = &renderList.bonePalette[0];
+    std::vector<RenderItem*>& animated = m_Animated;
+    std::vector<AnimationLOD>& lods = m_LODs;
+
+    JobSystem::ParallelFor((unsigned int)animated.size(), 1, [&](unsigned int begin, unsigned int end) {
+        for (unsigned int i = begin; i < end; i++) {
+            AnimatorInstance* animator = animated[i]->gameObject->animator;
+            animator->Update(deltaTime);
+            animator->EvaluatePose(palette + animated[i]->boneOffset, lods[i], i);
+        }
+    });
+}
+
+AnimationLOD PoseSystem::SelectLOD(const RenderList& renderList, const RenderItem& item) const {
+    const glm::mat4& world = item.worldMatrix;
+
+    // bounding sphere of the model in world units
+    float scale = glm::max(glm::length(glm::vec3(world[0])),
+                           glm::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+    float radius = glm::length(item.gameObject->model->bounds.GetExtents()) * scale;
+
+    float distance = glm::length(glm::vec3(renderList.view * world[3]));
+    if (distance <= radius) return AnimationLOD::Full;
+
+    // projection[1][1] is cot(fov / 2), so this is the fraction of the screen height the sphere covers
+    float screenSize = radius * renderList.projection[1][1] / distance;
+
+    if (screenSize >= halfRateSize) return AnimationLOD::Full;
+    if (screenSize >= quarterRateSize) return AnimationLOD::Half;
+    return AnimationLOD::Quarter;
+}
+
+}  // namespace gdp1
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+#include "animator_instance.h"
+
+namespace gdp1 {
+
+struct RenderList;
+struct RenderItem;
+
+// Evaluates the poses of every visible animated character in one batch, spread over the JobSystem workers.
+// The bone matrices of all characters are written into the render list's contiguous bone palette, and each render
+// item records where its bones start.
+// Characters that cover little of the screen get a cheaper AnimationLOD, characters outside the view only advance
+// their time.
+class PoseSystem {
+public:
+    PoseSystem();
+
+    void Update(RenderList& renderList, float deltaTime);
+
+    unsigned int GetAnimatedCount() const { return static_cast<unsigned int>(m_Animated.size()); }
+    unsigned int GetLODCount(AnimationLOD lod) const { return m_LODCounts[static_cast<int>(lod)]; }
+
+public:
+    // projected height of the model as a fraction of the screen height, below which the update rate drops
+    float halfRateSize = 0.25f;
+    float quarterRateSize = 0.1f;
+
+private:
+    AnimationLOD SelectLOD(const RenderList& renderList, const RenderItem& item) const;
+
+private:
+    // render items that are animated this frame, reused between frames
+    std::vector<RenderItem*> m_Animated;
+    std::vector<AnimationLOD> m_LODs;
+
+    unsigned int m_LODCounts[4];
+};
+
+}  // namespace gdp1
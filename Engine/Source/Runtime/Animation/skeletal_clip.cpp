@@ -0,0 +1,565 @@
+#include "skeletal_clip.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Core/logger.h"
+
+namespace gdp1 {
+
+namespace {
+
+const char CLIP_MAGIC[4] = {'G', 'C', 'L', 'P'};
+const uint32_t CLIP_VERSION = 3;
+
+// start of a .clip file, followed by the tracks, the track names, the key arrays and the root motion keys, each padded
+// to 4 bytes
+struct ClipHeader {
+    char magic[4];
+    uint32_t version;
+    float ticksPerSecond;
+    float duration;
+    uint32_t numTracks;
+    uint32_t numPositions;
+    uint32_t numRotations;
+    uint32_t numScalings;
+    uint32_t namesSize;
+    int32_t rootTrack;
+    uint32_t numRootKeys;
+
+    // the settings the clip was compiled with, a clip compiled with others is stale
+    float positionError;
+    float rotationError;
+    float scalingError;
+    char rootMotionNode[64];  // NUL terminated, cut short if the name is longer
+};
+
+const float QUANTIZED_MAX = 65535.0f;
+// the three smallest components of a unit quaternion are within +-1/sqrt(2)
+const float ROTATION_RANGE = 0.70710678f;
+
+size_t Align4(size_t size) { return (size + 3) & ~(size_t)3; }
+
+void WriteSettings(const ClipCompressionSettings& settings, ClipHeader& header) {
+    header.positionError = settings.positionError;
+    header.rotationError = settings.rotationError;
+    header.scalingError = settings.scalingError;
+
+    memset(header.rootMotionNode, 0, sizeof(header.rootMotionNode));
+    settings.rootMotionNode.copy(header.rootMotionNode, sizeof(header.rootMotionNode) - 1);
+}
+
+bool HasSettings(const ClipHeader& header, const ClipCompressionSettings& settings) {
+    ClipHeader expected;
+    WriteSettings(settings, expected);
+
+    return header.positionError == expected.positionError && header.rotationError == expected.rotationError &&
+           header.scalingError == expected.scalingError &&
+           memcmp(header.rootMotionNode, expected.rootMotionNode, sizeof(expected.rootMotionNode)) == 0;
+}
+
+// whether offset + count keys lie inside an array of size keys
+bool InRange(uint32_t offset, uint32_t count, uint32_t size) { return offset <= size && count <= size - offset; }
+
+void Append(std::vector<char>& blob, const void* data, size_t size) {
+    size_t offset = blob.size();
+    blob.resize(offset + Align4(size), 0);
+    if (size > 0) memcpy(&blob[offset], data, size);
+}
+
+uint16_t Quantize(float value, float min, float scale) {
+    if (scale <= 0.0f) return 0;
+    return (uint16_t)glm::clamp(glm::round((value - min) / scale), 0.0f, QUANTIZED_MAX);
+}
+
+uint16_t QuantizeTime(float time, float timeScale) {
+    return (uint16_t)glm::clamp(glm::round(time * timeScale), 0.0f, QUANTIZED_MAX);
+}
+
+glm::vec3 Interpolate(const glm::vec3& a, const glm::vec3& b, float t) { return glm::mix(a, b, t); }
+glm::quat Interpolate(const glm::quat& a, const glm::quat& b, float t) { return glm::slerp(a, b, t); }
+
+float Error(const glm::vec3& a, const glm::vec3& b) { return glm::length(a - b); }
+float Error(const glm::quat& a, const glm::quat& b) {
+    return 2.0f * acosf(glm::min(1.0f, fabsf(glm::dot(glm::normalize(a), glm::normalize(b)))));
+}
+
+// Keeps the keys that interpolating between the kept neighbours cannot reproduce within the tolerance.
+template <typename T>
+void ReduceKeys(const std::vector<float>& times, const std::vector<T>& values, float tolerance,
+                std::vector<unsigned int>& kept) {
+    kept.clear();
+
+    unsigned int count = (unsigned int)values.size();
+    if (count == 0) return;
+
+    kept.push_back(0);
+
+    // a track that never moves needs a single key
+    bool constant = true;
+    for (unsigned int i = 1; i < count && constant; i++) {
+        constant = Error(values[i], values[0]) <= tolerance;
+    }
+    if (constant) return;
+
+    unsigned int anchor = 0;
+    for (unsigned int i = 1; i + 1 < count; i++) {
+        // can the segment from the anchor to the next key stand in for every key in between?
+        float span = times[i + 1] - times[anchor];
+        bool removable = span > 0.0f;
+        for (unsigned int j = anchor + 1; j <= i && removable; j++) {
+            float t = (times[j] - times[anchor]) / span;
+            removable = Error(Interpolate(values[anchor], values[i + 1], t), values[j]) <= tolerance;
+        }
+
+        if (!removable) {
+            kept.push_back(i);
+            anchor = i;
+        }
+    }
+
+    kept.push_back(count - 1);
+}
+
+// Quantizes the kept keys of a vector track inside their bounding box.
+void QuantizeVectors(const std::vector<glm::vec3>& values, const std::vector<unsigned int>& kept, float* min,
+                     float* scale, std::vector<uint16_t>& packed) {
+    glm::vec3 lo(0.0f), hi(0.0f);
+    if (!kept.empty()) lo = hi = values[kept[0]];
+    for (unsigned int k : kept) {
+        lo = glm::min(lo, values[k]);
+        hi = glm::max(hi, values[k]);
+    }
+
+    glm::vec3 step = (hi - lo) / QUANTIZED_MAX;
+    for (int c = 0; c < 3; c++) {
+        min[c] = lo[c];
+        scale[c] = step[c];
+    }
+
+    for (unsigned int k : kept) {
+        for (int c = 0; c < 3; c++) packed.push_back(Quantize(values[k][c], min[c], scale[c]));
+    }
+}
+
+glm::vec3 DecodeVector(const uint16_t* packed, const float* min, const float* scale) {
+    return glm::vec3(min[0] + packed[0] * scale[0], min[1] + packed[1] * scale[1], min[2] + packed[2] * scale[2]);
+}
+
+}  // namespace
+
+SkeletalClip::SkeletalClip() {}
+
+void SkeletalClip::Compile(const aiAnimation* animation, const ClipCompressionSettings& settings) {
+    m_File.Close();
+    m_Blob.clear();
+    m_TrackNames.clear();
+    m_NumTracks = m_NumPositions = m_NumRotations = m_NumScalings = m_NumRootKeys = 0;
+    m_RootTrack = -1;
+    m_Size = 0;
+
+    if (animation == nullptr) return;
+
+    ClipHeader header;
+    memcpy(header.magic, CLIP_MAGIC, sizeof(CLIP_MAGIC));
+    header.version = CLIP_VERSION;
+    header.ticksPerSecond = animation->mTicksPerSecond != 0.0 ? (float)animation->mTicksPerSecond : 25.0f;
+    header.duration = (float)animation->mDuration;
+    WriteSettings(settings, header);
+
+    float timeScale = header.duration > 0.0f ? QUANTIZED_MAX / header.duration : 0.0f;
+
+    std::vector<SkeletalTrack> tracks(animation->mNumChannels);
+    std::string names;
+    std::vector<uint16_t> positionTimes, positions, rotationTimes, rotations, scalingTimes, scalings;
+
+    std::vector<float> times;
+    std::vector<glm::vec3> vectors;
+    std::vector<glm::quat> quats;
+    std::vector<unsigned int> kept;
+    std::vector<float> rootTimes, rootPositions;
+    int rootTrack = -1;
+    size_t numRawKeys = 0;
+    size_t rawSize = 0;
+
+    for (unsigned int i = 0; i < animation->mNumChannels; i++) {
+        const aiNodeAnim* nodeAnim = animation->mChannels[i];
+        SkeletalTrack& track = tracks[i];
+
+        // positions
+        times.clear();
+        vectors.clear();
+        for (unsigned int k = 0; k < nodeAnim->mNumPositionKeys; k++) {
+            const aiVectorKey& key = nodeAnim->mPositionKeys[k];
+            times.push_back((float)key.mTime);
+            vectors.push_back(glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z));
+        }
+
+        // keep the horizontal path as root motion and pin the node to where it starts
+        if (rootTrack < 0 && vectors.size() > 1 && settings.rootMotionNode == nodeAnim->mNodeName.data) {
+            rootTrack = (int)i;
+            for (size_t k = 0; k < vectors.size(); k++) {
+                rootTimes.push_back(times[k]);
+                rootPositions.push_back(vectors[k].x - vectors[0].x);
+                rootPositions.push_back(0.0f);
+                rootPositions.push_back(vectors[k].z - vectors[0].z);
+
+                vectors[k].x = vectors[0].x;
+                vectors[k].z = vectors[0].z;
+            }
+        }
+
+        ReduceKeys(times, vectors, settings.positionError, kept);
+
+        track.positionOffset = (uint32_t)positionTimes.size();
+        track.positionCount = (uint32_t)kept.size();
+        for (unsigned int k : kept) positionTimes.push_back(QuantizeTime(times[k], timeScale));
+        QuantizeVectors(vectors, kept, track.positionMin, track.positionScale, positions);
+
+        // rotations
+        times.clear();
+        quats.clear();
+        for (unsigned int k = 0; k < nodeAnim->mNumRotationKeys; k++) {
+            const aiQuatKey& key = nodeAnim->mRotationKeys[k];
+            times.push_back((float)key.mTime);
+            quats.push_back(glm::quat(key.mValue.w, key.mValue.x, key.mValue.y, key.mValue.z));
+        }
+        ReduceKeys(times, quats, settings.rotationError, kept);
+
+        track.rotationOffset = (uint32_t)rotationTimes.size();
+        track.rotationCount = (uint32_t)kept.size();
+        for (unsigned int k : kept) {
+            uint16_t packed[3];
+            EncodeRotation(quats[k], packed);
+
+            rotationTimes.push_back(QuantizeTime(times[k], timeScale));
+            rotations.insert(rotations.end(), packed, packed + 3);
+        }
+
+        // scalings
+        times.clear();
+        vectors.clear();
+        for (unsigned int k = 0; k < nodeAnim->mNumScalingKeys; k++) {
+            const aiVectorKey& key = nodeAnim->mScalingKeys[k];
+            times.push_back((float)key.mTime);
+            vectors.push_back(glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z));
+        }
+        ReduceKeys(times, vectors, settings.scalingError, kept);
+
+        track.scalingOffset = (uint32_t)scalingTimes.size();
+        track.scalingCount = (uint32_t)kept.size();
+        for (unsigned int k : kept) scalingTimes.push_back(QuantizeTime(times[k], timeScale));
+        QuantizeVectors(vectors, kept, track.scalingMin, track.scalingScale, scalings);
+
+        names.append(nodeAnim->mNodeName.data);
+        names.push_back('\0');
+
+        numRawKeys += nodeAnim->mNumPositionKeys + nodeAnim->mNumRotationKeys + nodeAnim->mNumScalingKeys;
+
+        // what the uncompressed arrays held: a float time and a vec3 or quat per key
+        rawSize += (nodeAnim->mNumPositionKeys + nodeAnim->mNumScalingKeys) * (sizeof(float) + sizeof(glm::vec3)) +
+                   nodeAnim->mNumRotationKeys * (sizeof(float) + sizeof(glm::quat));
+    }
+
+    header.numTracks = (uint32_t)tracks.size();
+    header.numPositions = (uint32_t)positionTimes.size();
+    header.numRotations = (uint32_t)rotationTimes.size();
+    header.numScalings = (uint32_t)scalingTimes.size();
+    header.namesSize = (uint32_t)names.size();
+    header.rootTrack = rootTrack;
+    header.numRootKeys = (uint32_t)rootTimes.size();
+
+    Append(m_Blob, &header, sizeof(header));
+    Append(m_Blob, tracks.data(), tracks.size() * sizeof(SkeletalTrack));
+    Append(m_Blob, names.data(), names.size());
+    Append(m_Blob, positionTimes.data(), positionTimes.size() * sizeof(uint16_t));
+    Append(m_Blob, positions.data(), positions.size() * sizeof(uint16_t));
+    Append(m_Blob, rotationTimes.data(), rotationTimes.size() * sizeof(uint16_t));
+    Append(m_Blob, rotations.data(), rotations.size() * sizeof(uint16_t));
+    Append(m_Blob, scalingTimes.data(), scalingTimes.size() * sizeof(uint16_t));
+    Append(m_Blob, scalings.data(), scalings.size() * sizeof(uint16_t));
+    Append(m_Blob, rootTimes.data(), rootTimes.size() * sizeof(float));
+    Append(m_Blob, rootPositions.data(), rootPositions.size() * sizeof(float));
+
+    Bind(&m_Blob[0], m_Blob.size());
+
+    LOG_INFO("Compressed clip: {0} keys to {1}, {2} bytes to {3}", numRawKeys, GetKeyCount(), rawSize, m_Size);
+}
+
+bool SkeletalClip::Save(const std::string& path) const {
+    if (m_Size == 0) return false;
+
+    const char* data = m_Blob.empty() ? m_File.GetData() : &m_Blob[0];
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+
+    file.write(data, m_Size);
+    return (bool)file;
+}
+
+bool SkeletalClip::Load(const std::string& path, const ClipCompressionSettings& settings) {
+    m_Blob.clear();
+
+    if (!m_File.Open(path)) return false;
+
+    bool valid = Bind(m_File.GetData(), m_File.GetSize());
+    if (valid) {
+        ClipHeader header;
+        memcpy(&header, m_File.GetData(), sizeof(header));
+        valid = HasSettings(header, settings);
+    }
+
+    if (!valid) {
+        LOG_WARN("Ignoring outdated or damaged clip file {0}", path);
+        m_File.Close();
+        return false;
+    }
+
+    return true;
+}
+
+bool SkeletalClip::Bind(const char* data, size_t size) {
+    m_TrackNames.clear();
+    m_NumTracks = m_NumPositions = m_NumRotations = m_NumScalings = m_NumRootKeys = 0;
+    m_RootTrack = -1;
+    m_Size = 0;
+
+    if (size < sizeof(ClipHeader)) return false;
+
+    ClipHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, CLIP_MAGIC, sizeof(CLIP_MAGIC)) != 0 || header.version != CLIP_VERSION) return false;
+
+    size_t offset = Align4(sizeof(ClipHeader));
+    size_t tracksOffset = offset;
+    offset += Align4(header.numTracks * sizeof(SkeletalTrack));
+    size_t namesOffset = offset;
+    offset += Align4(header.namesSize);
+    size_t positionTimesOffset = offset;
+    offset += Align4(header.numPositions * sizeof(uint16_t));
+    size_t positionsOffset = offset;
+    offset += Align4(header.numPositions * 3 * sizeof(uint16_t));
+    size_t rotationTimesOffset = offset;
+    offset += Align4(header.numRotations * sizeof(uint16_t));
+    size_t rotationsOffset = offset;
+    offset += Align4(header.numRotations * 3 * sizeof(uint16_t));
+    size_t scalingTimesOffset = offset;
+    offset += Align4(header.numScalings * sizeof(uint16_t));
+    size_t scalingsOffset = offset;
+    offset += Align4(header.numScalings * 3 * sizeof(uint16_t));
+    size_t rootTimesOffset = offset;
+    offset += header.numRootKeys * sizeof(float);
+    size_t rootPositionsOffset = offset;
+    offset += header.numRootKeys * 3 * sizeof(float);
+
+    if (offset > size) return false;
+
+    // a damaged file fails here instead of reading past the arrays while playing
+    const SkeletalTrack* tracks = (const SkeletalTrack*)(data + tracksOffset);
+    for (uint32_t i = 0; i < header.numTracks; i++) {
+        const SkeletalTrack& track = tracks[i];
+        if (!InRange(track.positionOffset, track.positionCount, header.numPositions) ||
+            !InRange(track.rotationOffset, track.rotationCount, header.numRotations) ||
+            !InRange(track.scalingOffset, track.scalingCount, header.numScalings)) {
+            return false;
+        }
+    }
+    if (header.rootTrack >= (int32_t)header.numTracks) return false;
+
+    // names are only needed to bind tracks to nodes, keep them as strings. every track has one, each ends in a NUL
+    // inside the names block.
+    std::vector<std::string> names;
+    names.reserve(header.numTracks);
+    const char* name = data + namesOffset;
+    const char* namesEnd = name + header.namesSize;
+    for (uint32_t i = 0; i < header.numTracks; i++) {
+        const char* nameEnd = (const char*)memchr(name, '\0', namesEnd - name);
+        if (nameEnd == nullptr) return false;
+
+        names.push_back(std::string(name, nameEnd));
+        name = nameEnd + 1;
+    }
+
+    m_TicksPerSecond = header.ticksPerSecond;
+    m_Duration = header.duration;
+    m_TimeScale = header.duration > 0.0f ? QUANTIZED_MAX / header.duration : 0.0f;
+
+    m_NumTracks = header.numTracks;
+    m_NumPositions = header.numPositions;
+    m_NumRotations = header.numRotations;
+    m_NumScalings = header.numScalings;
+    m_NumRootKeys = header.numRootKeys;
+    m_RootTrack = header.rootTrack;
+
+    m_Tracks = tracks;
+    m_PositionTimes = (const uint16_t*)(data + positionTimesOffset);
+    m_Positions = (const uint16_t*)(data + positionsOffset);
+    m_RotationTimes = (const uint16_t*)(data + rotationTimesOffset);
+    m_Rotations = (const uint16_t*)(data + rotationsOffset);
+    m_ScalingTimes = (const uint16_t*)(data + scalingTimesOffset);
+    m_Scalings = (const uint16_t*)(data + scalingsOffset);
+    m_RootTimes = (const float*)(data + rootTimesOffset);
+    m_RootPositions = (const float*)(data + rootPositionsOffset);
+
+    m_TrackNames.swap(names);
+
+    m_Size = offset;
+    return true;
+}
+
+int SkeletalClip::FindTrack(const std::string& nodeName) const {
+    for (size_t i = 0; i < m_TrackNames.size(); i++) {
+        if (m_TrackNames[i] == nodeName) return (int)i;
+    }
+
+    return -1;
+}
+
+unsigned int SkeletalClip::GetKeyCount() const { return m_NumPositions + m_NumRotations + m_NumScalings; }
+
+glm::vec3 SkeletalClip::SampleRoot(float ticks) const {
+    const float* end = m_RootTimes + m_NumRootKeys;
+    const float* it = std::upper_bound(m_RootTimes, end, ticks);
+
+    if (it == m_RootTimes) return glm::make_vec3(m_RootPositions);
+    if (it == end) return glm::make_vec3(m_RootPositions + (m_NumRootKeys - 1) * 3);
+
+    unsigned int key = (unsigned int)(it - m_RootTimes) - 1;
+    float deltaTime = m_RootTimes[key + 1] - m_RootTimes[key];
+    float factor = deltaTime > 0.0f ? (ticks - m_RootTimes[key]) / deltaTime : 0.0f;
+
+    return glm::mix(glm::make_vec3(m_RootPositions + key * 3), glm::make_vec3(m_RootPositions + key * 3 + 3), factor);
+}
+
+glm::vec3 SkeletalClip::GetRootMotion(float fromTicks, float toTicks) const {
+    if (!HasRootMotion()) return glm::vec3(0.0f);
+
+    if (toTicks >= fromTicks) return SampleRoot(toTicks) - SampleRoot(fromTicks);
+
+    // looped: the rest of this cycle plus the start of the next one
+    glm::vec3 cycle = glm::make_vec3(m_RootPositions + (m_NumRootKeys - 1) * 3) - glm::make_vec3(m_RootPositions);
+    return cycle - SampleRoot(fromTicks) + SampleRoot(toTicks);
+}
+
+void SkeletalClip::EncodeRotation(const glm::quat& rotation, uint16_t* packed) {
+    glm::quat q = glm::normalize(rotation);
+    float components[4] = {q.x, q.y, q.z, q.w};
+
+    // drop the largest component, it follows from the other three
+    int largest = 0;
+    for (int i = 1; i < 4; i++) {
+        if (fabsf(components[i]) > fabsf(components[largest])) largest = i;
+    }
+
+    // q and -q are the same rotation, make the dropped component positive
+    float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+    // 15 bits per component, the top bits of the first two words hold the index of the dropped one
+    int c = 0;
+    for (int i = 0; i < 4; i++) {
+        if (i == largest) continue;
+
+        float value = (components[i] * sign / ROTATION_RANGE) * 0.5f + 0.5f;
+        packed[c++] = (uint16_t)glm::clamp(glm::round(value * 32767.0f), 0.0f, 32767.0f);
+    }
+
+    packed[0] |= (uint16_t)((largest & 1) << 15);
+    packed[1] |= (uint16_t)((largest >> 1) << 15);
+}
+
+glm::quat SkeletalClip::DecodeRotation(const uint16_t* packed) {
+    int largest = (packed[0] >> 15) | ((packed[1] >> 15) << 1);
+
+    float components[4];
+    float sum = 0.0f;
+    int c = 0;
+    for (int i = 0; i < 4; i++) {
+        if (i == largest) continue;
+
+        float value = (float)(packed[c++] & 0x7fff) / 32767.0f;
+        components[i] = (value * 2.0f - 1.0f) * ROTATION_RANGE;
+        sum += components[i] * components[i];
+    }
+    components[largest] = sqrtf(glm::max(0.0f, 1.0f - sum));
+
+    return glm::quat(components[3], components[0], components[1], components[2]);
+}
+
+unsigned int SkeletalClip::FindKey(const uint16_t* times, unsigned int count, float time, unsigned int& cursor) {
+    unsigned int last = count - 2;
+    unsigned int key = cursor < last ? cursor : last;
+
+    // still inside the cached segment
+    if (times[key] <= time && (key == last || time < times[key + 1])) {
+        cursor = key;
+        return key;
+    }
+
+    // moved on to the next segment
+    if (key < last && times[key + 1] <= time && (key + 1 == last || time < times[key + 2])) {
+        cursor = key + 1;
+        return key + 1;
+    }
+
+    // jumped (looped or scrubbed), fall back to a binary search over the inner keys
+    const uint16_t* it = std::upper_bound(times + 1, times + count - 1, time);
+    key = (unsigned int)(it - times) - 1;
+
+    cursor = key;
+    return key;
+}
+
+float SkeletalClip::Factor(const uint16_t* times, unsigned int key, float time) const {
+    float deltaTime = (float)times[key + 1] - (float)times[key];
+    if (deltaTime <= 0.0f) return 0.0f;
+
+    float factor = (time - times[key]) / deltaTime;
+    return glm::clamp(factor, 0.0f, 1.0f);
+}
+
+void SkeletalClip::Sample(unsigned int trackIndex, float animationTimeTicks, TrackCursor& cursor,
+                          glm::vec3& translation, glm::quat& rotation, glm::vec3& scaling) const {
+    const SkeletalTrack& track = m_Tracks[trackIndex];
+
+    // key times are quantized over the clip's duration
+    float time = animationTimeTicks * m_TimeScale;
+
+    // we need at least two values to interpolate...
+    if (track.positionCount == 1) {
+        translation = DecodeVector(&m_Positions[track.positionOffset * 3], track.positionMin, track.positionScale);
+    } else if (track.positionCount > 1) {
+        const uint16_t* times = &m_PositionTimes[track.positionOffset];
+        const uint16_t* values = &m_Positions[track.positionOffset * 3];
+        unsigned int key = FindKey(times, track.positionCount, time, cursor.position);
+        translation = glm::mix(DecodeVector(values + key * 3, track.positionMin, track.positionScale),
+                               DecodeVector(values + key * 3 + 3, track.positionMin, track.positionScale),
+                               Factor(times, key, time));
+    }
+
+    if (track.rotationCount == 1) {
+        rotation = DecodeRotation(&m_Rotations[track.rotationOffset * 3]);
+    } else if (track.rotationCount > 1) {
+        const uint16_t* times = &m_RotationTimes[track.rotationOffset];
+        const uint16_t* values = &m_Rotations[track.rotationOffset * 3];
+        unsigned int key = FindKey(times, track.rotationCount, time, cursor.rotation);
+        rotation = glm::normalize(glm::slerp(DecodeRotation(values + key * 3), DecodeRotation(values + key * 3 + 3),
+                                             Factor(times, key, time)));
+    }
+
+    if (track.scalingCount == 1) {
+        scaling = DecodeVector(&m_Scalings[track.scalingOffset * 3], track.scalingMin, track.scalingScale);
+    } else if (track.scalingCount > 1) {
+        const uint16_t* times = &m_ScalingTimes[track.scalingOffset];
+        const uint16_t* values = &m_Scalings[track.scalingOffset * 3];
+        unsigned int key = FindKey(times, track.scalingCount, time, cursor.scaling);
+        scaling = glm::mix(DecodeVector(values + key * 3, track.scalingMin, track.scalingScale),
+                           DecodeVector(values + key * 3 + 3, track.scalingMin, track.scalingScale),
+                           Factor(times, key, time));
+    }
+}
+
+}  // namespace gdp1
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <assimp/anim.h>
+
+#include "IO/mapped_file.h"
+
+namespace gdp1 {
+
+// Ranges into the clip's key arrays for one animated node, and the box its quantized positions and scalings live in.
+// Stored as is in .clip files, so only fixed size members.
+struct SkeletalTrack {
+    uint32_t positionOffset = 0;
+    uint32_t positionCount = 0;
+    uint32_t rotationOffset = 0;
+    uint32_t rotationCount = 0;
+    uint32_t scalingOffset = 0;
+    uint32_t scalingCount = 0;
+
+    float positionMin[3] = {0.0f, 0.0f, 0.0f};
+    float positionScale[3] = {0.0f, 0.0f, 0.0f};
+    float scalingMin[3] = {0.0f, 0.0f, 0.0f};
+    float scalingScale[3] = {0.0f, 0.0f, 0.0f};
+};
+
+// Last key segment found on a track. Playback mostly moves forward, so the next lookup usually hits the same or the
+// following segment and never needs to search.
+struct TrackCursor {
+    unsigned int position = 0;
+    unsigned int rotation = 0;
+    unsigned int scaling = 0;
+};
+
+// How far the compressor may move a key when it drops keys that interpolation reproduces.
+struct ClipCompressionSettings {
+    float positionError = 0.001f;  // model units
+    float rotationError = 0.001f;  // radians
+    float scalingError = 0.0001f;
+
+    // the horizontal movement of this node is taken out of the pose and kept as root motion
+    std::string rootMotionNode = "Hips";
+};
+
+// An aiAnimation compiled into compressed flat arrays.
+// Compile drops the keys that interpolating their neighbours reproduces within the error bounds, then quantizes what
+// is left: key times to 16 bits, rotations to 48 bits (smallest three) and positions and scalings to 16 bits per
+// component inside the track's bounding box. Everything lives in one blob with the same layout as a .clip file, so a
+// saved clip is loaded by mapping the file and pointing into it, without assimp and without copying.
+// Compile also extracts root motion: the horizontal path of the root motion node is stored on its own, uncompressed,
+// and removed from the node's track, so the pose stays in place and gameplay moves the object instead.
+class SkeletalClip {
+public:
+    SkeletalClip();
+
+    SkeletalClip(const SkeletalClip&) = delete;
+    SkeletalClip& operator=(const SkeletalClip&) = delete;
+
+    void Compile(const aiAnimation* animation, const ClipCompressionSettings& settings = ClipCompressionSettings());
+
+    // Writes the compiled clip to a .clip file.
+    bool Save(const std::string& path) const;
+    // Maps a .clip file. Returns false if it does not exist, is damaged, or was written by another version or with
+    // other settings.
+    bool Load(const std::string& path, const ClipCompressionSettings& settings = ClipCompressionSettings());
+
+    // Returns -1 if the clip does not animate the node. Load time only.
+    int FindTrack(const std::string& nodeName) const;
+
+    // Samples a track at animationTimeTicks. The cursor must belong to the same track.
+    void Sample(unsigned int track, float animationTimeTicks, TrackCursor& cursor, glm::vec3& translation,
+                glm::quat& rotation, glm::vec3& scaling) const;
+
+    // Horizontal root movement between two playback times, in the space of the root motion node's parent. Wraps
+    // around the end of the clip if toTicks < fromTicks.
+    glm::vec3 GetRootMotion(float fromTicks, float toTicks) const;
+    bool HasRootMotion() const { return m_NumRootKeys > 1; }
+    // Returns -1 if the clip has no root motion.
+    int GetRootTrack() const { return HasRootMotion() ? m_RootTrack : -1; }
+
+    unsigned int GetTrackCount() const { return m_NumTracks; }
+    unsigned int GetKeyCount() const;
+    // bytes of key data, compressed
+    size_t GetMemorySize() const { return m_Size; }
+
+    float GetTicksPerSecond() const { return m_TicksPerSecond; }
+    float GetDuration() const { return m_Duration; }
+
+    // Finds k so that times[k] <= time < times[k + 1], trying the cursor and its successor before a binary search.
+    // count must be at least 2.
+    static unsigned int FindKey(const uint16_t* times, unsigned int count, float time, unsigned int& cursor);
+
+    static void EncodeRotation(const glm::quat& rotation, uint16_t* packed);
+    static glm::quat DecodeRotation(const uint16_t* packed);
+
+private:
+    // points the arrays into a blob laid out like a .clip file
+    bool Bind(const char* data, size_t size);
+
+    float Factor(const uint16_t* times, unsigned int key, float time) const;
+
+    glm::vec3 SampleRoot(float ticks) const;
+
+private:
+    float m_TicksPerSecond = 25.0f;
+    float m_Duration = 0.0f;
+    float m_TimeScale = 0.0f;  // ticks to quantized time
+
+    unsigned int m_NumTracks = 0;
+    unsigned int m_NumPositions = 0;
+    unsigned int m_NumRotations = 0;
+    unsigned int m_NumScalings = 0;
+    unsigned int m_NumRootKeys = 0;
+    int m_RootTrack = -1;
+
+    std::vector<std::string> m_TrackNames;
+
+    const SkeletalTrack* m_Tracks = nullptr;
+    const uint16_t* m_PositionTimes = nullptr;
+    const uint16_t* m_Positions = nullptr;
+    const uint16_t* m_RotationTimes = nullptr;
+    const uint16_t* m_Rotations = nullptr;
+    const uint16_t* m_ScalingTimes = nullptr;
+    const uint16_t* m_Scalings = nullptr;
+    const float* m_RootTimes = nullptr;
+    const float* m_RootPositions = nullptr;  // x, 0, z per key
+
+    // backing memory, either compiled here or mapped from a .clip file
+    std::vector<char> m_Blob;
+    MappedFile m_File;
+    size_t m_Size = 0;
+};
+
+}  // namespace gdp1
@@ -0,0 +1,72 @@
+#include "skeleton.h"
+
+#include "Utils/glm_utils.h"
+
+namespace gdp1 {
+
+Skeleton::Skeleton()
+    : globalInverse(1.0f) {}
+
+void Skeleton::Build(const aiNode* root, const std::map<std::string, unsigned int>& boneMapping,
+                     const std::vector<BoneMatrix>& bones, const aiMatrix4x4& globalInverseTransform) {
+    parents.clear();
+    boneSlots.clear();
+    bindLocals.clear();
+    bindTranslations.clear();
+    bindRotations.clear();
+    bindScalings.clear();
+    nodeNames.clear();
+    heights.clear();
+    boneOffsets.clear();
+
+    globalInverse = GLMUtils::aiMatrix4x4ToGlmMat4(globalInverseTransform);
+
+    boneOffsets.reserve(bones.size());
+    for (const BoneMatrix& bone : bones) {
+        boneOffsets.push_back(GLMUtils::aiMatrix4x4ToGlmMat4(bone.offset_matrix));
+    }
+
+    if (root != nullptr) AddNode(root, -1, boneMapping);
+
+    // children come after their parents, so walking backwards sees every child before its parent
+    heights.assign(parents.size(), 0);
+    for (size_t i = parents.size(); i-- > 1;) {
+        int parent = parents[i];
+        if (parent >= 0 && heights[parent] < heights[i] + 1) {
+            heights[parent] = heights[i] + 1;
+        }
+    }
+}
+
+void Skeleton::AddNode(const aiNode* node, int parent, const std::map<std::string, unsigned int>& boneMapping) {
+    int index = (int)parents.size();
+    std::string name(node->mName.data);
+
+    std::map<std::string, unsigned int>::const_iterator boneIt = boneMapping.find(name);
+
+    aiVector3D scaling, position;
+    aiQuaternion rotation;
+    node->mTransformation.Decompose(scaling, rotation, position);
+
+    parents.push_back(parent);
+    boneSlots.push_back(boneIt != boneMapping.end() ? (int)boneIt->second : -1);
+    bindLocals.push_back(GLMUtils::aiMatrix4x4ToGlmMat4(node->mTransformation));
+    bindTranslations.push_back(glm::vec3(position.x, position.y, position.z));
+    bindRotations.push_back(glm::quat(rotation.w, rotation.x, rotation.y, rotation.z));
+    bindScalings.push_back(glm::vec3(scaling.x, scaling.y, scaling.z));
+    nodeNames.push_back(name);
+
+    for (unsigned int i = 0; i < node->mNumChildren; i++) {
+        AddNode(node->mChildren[i], index, boneMapping);
+    }
+}
+
+int Skeleton::FindNode(const std::string& name) const {
+    for (size_t i = 0; i < nodeNames.size(); i++) {
+        if (nodeNames[i] == name) return (int)i;
+    }
+
+    return -1;
+}
+
+}  // namespace gdp1
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_aligned.hpp>
+
+#include <assimp/scene.h>
+
+#include "Render/mesh.h"
+
+namespace gdp1 {
+
+// The node hierarchy of a skinned model flattened into arrays.
+// Nodes are stored in depth-first pre-order, so a parent always comes before its children and a pose can be
+// evaluated with a single forward loop. Matrices are 16-byte aligned so glm uses SSE for the pose math.
+class Skeleton {
+public:
+    Skeleton();
+
+    void Build(const aiNode* root, const std::map<std::string, unsigned int>& boneMapping,
+               const std::vector<BoneMatrix>& bones, const aiMatrix4x4& globalInverseTransform);
+
+    // Returns -1 if there is no node with that name. Load time only.
+    int FindNode(const std::string& name) const;
+
+    unsigned int GetNodeCount() const { return static_cast<unsigned int>(parents.size()); }
+    unsigned int GetBoneCount() const { return static_cast<unsigned int>(boneOffsets.size()); }
+
+public:
+    // per node
+    std::vector<int> parents;    // -1 for the root
+    std::vector<int> boneSlots;  // index into the bone palette, -1 if the node does not deform the mesh
+    std::vector<glm::aligned_mat4> bindLocals;
+    std::vector<glm::vec3> bindTranslations;
+    std::vector<glm::quat> bindRotations;
+    std::vector<glm::vec3> bindScalings;
+    std::vector<std::string> nodeNames;
+    std::vector<unsigned char> heights;  // levels below the node, 0 for leaves such as finger tips and face bones
+
+    // per bone
+    std::vector<glm::aligned_mat4> boneOffsets;
+
+    glm::aligned_mat4 globalInverse;
+
+private:
+    void AddNode(const aiNode* node, int parent, const std::map<std::string, unsigned int>& boneMapping);
+};
+
+}  // namespace gdp1
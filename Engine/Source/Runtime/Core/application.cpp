@@ -1,6 +1,7 @@
 ﻿#include "application.h"
 
 #include "Core/logger.h"
+#include "Core/job_system.h"
 #include "Input/input.h"
 #include "Input/key_codes.h"
 #include "Input/mouse_button_codes.h"
@@ -13,6 +14,7 @@ using namespace glm;
 namespace gdp1 {
 
 int Application::drawCalls = 0;
+int Application::uniformCalls = 0;
 
 #define BIND_EVENT_FN(x) std::bind(&Application::x, this, std::placeholders::_1)
 
@@ -29,6 +31,8 @@ Application::Application(const std::string& name, unsigned int width, unsigned i
     m_Window = std::unique_ptr<Window>(Window::Create(WindowProps(name, width, height)));
     //if (startFullScreen) m_Window->ToggleFullscreen();
 
+    JobSystem::Init();
+
     lua_state = luaL_newstate();
     luaL_openlibs(lua_state);
 
@@ -38,6 +42,8 @@ Application::Application(const std::string& name, unsigned int width, unsigned i
     PushOverlay(m_ImGuiLayer);
 }
 
+Application::~Application() { JobSystem::Shutdown(); }
+
 void Application::OnEvent(Event& e) {
     EventDispatcher dispatcher(e);
     dispatcher.Dispatch<WindowCloseEvent>(BIND_EVENT_FN(OnWindowClose));
@@ -67,6 +73,7 @@ void Application::PushOverlay(Layer* overlay) { m_LayerStack.PushOverlay(overlay
 void Application::Run() {
     while (m_Running) {
         drawCalls = 0;
+        uniformCalls = 0;
 
         float time = (float)glfwGetTime();
         Timestep timestep = time - m_LastFrameTime;
@@ -99,6 +106,7 @@ void Application::Run() {
         ImGui::Text("MS per Frame: %.3f", m_MS);
         ImGui::Text("Timestep: %.4f", timestep.GetSeconds());
         ImGui::Text("Draw Calls: %d", drawCalls);
+        ImGui::Text("Uniform Calls: %d", uniformCalls);
         ImGui::End();
 
         m_ImGuiLayer->End();
@@ -21,7 +21,7 @@ namespace gdp1 {
 class Application : public CSRunner {
 public:
     Application(const std::string& name = "MiniEngine App", unsigned int width = 0, unsigned int height = 0, bool startFullScreen = false);
-    virtual ~Application() = default;
+    virtual ~Application();
 
     void Run();
 
@@ -37,6 +37,7 @@ public:
     lua_State* lua_state;
 
     static int drawCalls;
+    static int uniformCalls;
 
 private:
     bool OnWindowClose(WindowCloseEvent& e);
@@ -0,0 +1,31 @@
+#pragma once
+
+namespace gdp1 {
+
+class GameObject;
+class Model;
+class AnimatorInstance;
+struct Transform;
+
+// Components the engine's systems iterate. The GameObject stays the owner of the data, a component holds what one
+// system needs from it so the system never has to look an object up.
+
+// Every game object in the scene, for the per-frame Update and root motion.
+struct BehaviourComponent {
+    GameObject* object = nullptr;
+};
+
+// Game objects with a model.
+struct RenderableComponent {
+    GameObject* object = nullptr;
+    Model* model = nullptr;
+    Transform* transform = nullptr;
+};
+
+// Game objects with an animator.
+struct AnimatorComponent {
+    GameObject* object = nullptr;
+    AnimatorInstance* animator = nullptr;
+};
+
+}  // namespace gdp1
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace gdp1 {
+
+typedef uint32_t Entity;
+
+const Entity INVALID_ENTITY = 0xFFFFFFFF;
+
+class ComponentPoolBase {
+public:
+    virtual ~ComponentPoolBase() {}
+
+    virtual void Remove(Entity entity) = 0;
+};
+
+// Components of one type in a sparse set: a dense array of components that systems iterate, the entity each one
+// belongs to, and a sparse array from entity to dense index. Removing swaps the last component into the hole, so the
+// dense arrays never have gaps and iteration order is not stable.
+template <typename T>
+class ComponentPool : public ComponentPoolBase {
+public:
+    T& Add(Entity entity, const T& component) {
+        if (entity >= m_Sparse.size()) m_Sparse.resize(entity + 1, INVALID_INDEX);
+
+        if (m_Sparse[entity] != INVALID_INDEX) {
+            T& existing = m_Components[m_Sparse[entity]];
+            existing = component;
+            return existing;
+        }
+
+        m_Sparse[entity] = static_cast<uint32_t>(m_Components.size());
+        m_Entities.push_back(entity);
+        m_Components.push_back(component);
+        return m_Components.back();
+    }
+
+    void Remove(Entity entity) override {
+        if (!Has(entity)) return;
+
+        uint32_t index = m_Sparse[entity];
+        Entity last = m_Entities.back();
+
+        m_Components[index] = m_Components.back();
+        m_Entities[index] = last;
+        m_Sparse[last] = index;
+
+        m_Components.pop_back();
+        m_Entities.pop_back();
+        m_Sparse[entity] = INVALID_INDEX;
+    }
+
+    bool Has(Entity entity) const { return entity < m_Sparse.size() && m_Sparse[entity] != INVALID_INDEX; }
+
+    // nullptr if the entity has no such component
+    T* Get(Entity entity) { return Has(entity) ? &m_Components[m_Sparse[entity]] : nullptr; }
+
+    size_t Size() const { return m_Components.size(); }
+    T* Components() { return m_Components.empty() ? nullptr : &m_Components[0]; }
+    const Entity* Entities() const { return m_Entities.empty() ? nullptr : &m_Entities[0]; }
+
+private:
+    static const uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+    std::vector<uint32_t> m_Sparse;
+    std::vector<Entity> m_Entities;
+    std::vector<T> m_Components;
+};
+
+// Hands out entities and owns one ComponentPool per component type.
+// Systems query the components they need and walk their dense arrays instead of visiting every game object.
+class EntityRegistry {
+public:
+    Entity Create() {
+        if (!m_FreeEntities.empty()) {
+            Entity entity = m_FreeEntities.back();
+            m_FreeEntities.pop_back();
+            return entity;
+        }
+
+        return m_NextEntity++;
+    }
+
+    // Removes all components of the entity, its id is reused by a later Create.
+    void Destroy(Entity entity) {
+        for (std::unique_ptr<ComponentPoolBase>& pool : m_Pools) {
+            if (pool) pool->Remove(entity);
+        }
+        m_FreeEntities.push_back(entity);
+    }
+
+    template <typename T>
+    T& Add(Entity entity, const T& component = T()) {
+        return GetPool<T>().Add(entity, component);
+    }
+
+    template <typename T>
+    void Remove(Entity entity) {
+        GetPool<T>().Remove(entity);
+    }
+
+    template <typename T>
+    bool Has(Entity entity) {
+        return GetPool<T>().Has(entity);
+    }
+
+    template <typename T>
+    T* Get(Entity entity) {
+        return GetPool<T>().Get(entity);
+    }
+
+    template <typename T>
+    ComponentPool<T>& GetPool() {
+        size_t type = ComponentType<T>();
+        if (type >= m_Pools.size()) m_Pools.resize(type + 1);
+        if (!m_Pools[type]) m_Pools[type].reset(new ComponentPool<T>());
+        return *static_cast<ComponentPool<T>*>(m_Pools[type].get());
+    }
+
+    // Calls func(entity, component) for every T, in dense order.
+    template <typename T, typename Func>
+    void Each(Func func) {
+        ComponentPool<T>& pool = GetPool<T>();
+        T* components = pool.Components();
+        const Entity* entities = pool.Entities();
+        for (size_t i = 0; i < pool.Size(); i++) {
+            func(entities[i], components[i]);
+        }
+    }
+
+    // Calls func(entity, a, b) for every entity that has both components, walking the smaller pool.
+    template <typename A, typename B, typename Func>
+    void Each(Func func) {
+        ComponentPool<A>& poolA = GetPool<A>();
+        ComponentPool<B>& poolB = GetPool<B>();
+
+        if (poolA.Size() <= poolB.Size()) {
+            A* components = poolA.Components();
+            const Entity* entities = poolA.Entities();
+            for (size_t i = 0; i < poolA.Size(); i++) {
+                B* b = poolB.Get(entities[i]);
+                if (b != nullptr) func(entities[i], components[i], *b);
+            }
+        } else {
+            B* components = poolB.Components();
+            const Entity* entities = poolB.Entities();
+            for (size_t i = 0; i < poolB.Size(); i++) {
+                A* a = poolA.Get(entities[i]);
+                if (a != nullptr) func(entities[i], *a, components[i]);
+            }
+        }
+    }
+
+private:
+    // a small index per component type, assigned on first use
+    static size_t NextComponentType() {
+        static size_t s_NextType = 0;
+        return s_NextType++;
+    }
+
+    template <typename T>
+    static size_t ComponentType() {
+        static const size_t s_Type = NextComponentType();
+        return s_Type;
+    }
+
+private:
+    std::vector<std::unique_ptr<ComponentPoolBase>> m_Pools;
+    std::vector<Entity> m_FreeEntities;
+    Entity m_NextEntity = 0;
+};
+
+}  // namespace gdp1
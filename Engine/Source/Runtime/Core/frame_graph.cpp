@@ -0,0 +1,148 @@
+#include "frame_graph.h"
+
+#include "Core/logger.h"
+
+namespace gdp1 {
+
+FrameGraph::FrameGraph() {
+    InitializeCriticalSection(&m_MainQueueCS);
+    InitializeConditionVariable(&m_MainQueueCV);
+}
+
+FrameGraph::~FrameGraph() { DeleteCriticalSection(&m_MainQueueCS); }
+
+size_t FrameGraph::AddTask(const FrameTaskDesc& desc) {
+    FrameTask task;
+    task.desc = desc;
+    m_Tasks.push_back(task);
+    m_Compiled = false;
+    return m_Tasks.size() - 1;
+}
+
+bool FrameGraph::Contains(const std::vector<std::string>& resources, const std::string& resource) {
+    return std::find(resources.begin(), resources.end(), resource) != resources.end();
+}
+
+bool FrameGraph::HasHazard(const FrameTaskDesc& earlier, const FrameTaskDesc& later) {
+    // write after read / write after write
+    for (const std::string& res : later.writes) {
+        if (Contains(earlier.writes, res) || Contains(earlier.reads, res)) return true;
+    }
+    // read after write
+    for (const std::string& res : later.reads) {
+        if (Contains(earlier.writes, res)) return true;
+    }
+    return false;
+}
+
+void FrameGraph::Compile() {
+    for (FrameTask& task : m_Tasks) {
+        task.dependencies.clear();
+        task.dependents.clear();
+    }
+
+    for (size_t later = 0; later < m_Tasks.size(); later++) {
+        for (size_t earlier = 0; earlier < later; earlier++) {
+            if (HasHazard(m_Tasks[earlier].desc, m_Tasks[later].desc)) {
+                m_Tasks[later].dependencies.push_back(earlier);
+                m_Tasks[earlier].dependents.push_back(later);
+            }
+        }
+    }
+
+    m_Compiled = true;
+}
+
+void FrameGraph::Execute(float deltaTime) {
+    if (m_Tasks.empty()) return;
+    if (!m_Compiled) Compile();
+
+    m_DeltaTime = deltaTime;
+    m_RemainingTasks = static_cast<LONG>(m_Tasks.size());
+    m_ReadyMainTasks.clear();
+
+    for (FrameTask& task : m_Tasks) {
+        task.pendingDependencies = static_cast<LONG>(task.dependencies.size());
+    }
+
+    // collect the roots first so a fast task can't make a later root ready twice
+    std::vector<size_t> roots;
+    for (size_t i = 0; i < m_Tasks.size(); i++) {
+        if (m_Tasks[i].dependencies.empty()) roots.push_back(i);
+    }
+    for (size_t root : roots) {
+        Dispatch(root);
+    }
+
+    // the main thread runs its own tasks and otherwise helps the workers
+    while (m_RemainingTasks > 0) {
+        size_t mainTask = m_Tasks.size();
+
+        EnterCriticalSection(&m_MainQueueCS);
+        if (!m_ReadyMainTasks.empty()) {
+            mainTask = m_ReadyMainTasks.back();
+            m_ReadyMainTasks.pop_back();
+        }
+        LeaveCriticalSection(&m_MainQueueCS);
+
+        if (mainTask < m_Tasks.size()) {
+            m_Tasks[mainTask].desc.run(m_DeltaTime);
+            OnTaskFinished(mainTask);
+            continue;
+        }
+
+        if (JobSystem::TryRunPendingJob()) continue;
+
+        EnterCriticalSection(&m_MainQueueCS);
+        if (m_ReadyMainTasks.empty() && m_RemainingTasks > 0) {
+            SleepConditionVariableCS(&m_MainQueueCV, &m_MainQueueCS, 1);
+        }
+        LeaveCriticalSection(&m_MainQueueCS);
+    }
+
+    JobSystem::Wait(&m_Counter);
+}
+
+void FrameGraph::Dispatch(size_t task) {
+    if (m_Tasks[task].desc.affinity == TaskAffinity::MainThread) {
+        EnterCriticalSection(&m_MainQueueCS);
+        m_ReadyMainTasks.push_back(task);
+        WakeAllConditionVariable(&m_MainQueueCV);
+        LeaveCriticalSection(&m_MainQueueCS);
+        return;
+    }
+
+    JobSystem::Execute(
+        [this, task]() {
+            m_Tasks[task].desc.run(m_DeltaTime);
+            OnTaskFinished(task);
+        },
+        &m_Counter);
+}
+
+void FrameGraph::OnTaskFinished(size_t task) {
+    for (size_t dependent : m_Tasks[task].dependents) {
+        if (InterlockedDecrement(&m_Tasks[dependent].pendingDependencies) == 0) {
+            Dispatch(dependent);
+        }
+    }
+
+    EnterCriticalSection(&m_MainQueueCS);
+    InterlockedDecrement(&m_RemainingTasks);
+    WakeAllConditionVariable(&m_MainQueueCV);
+    LeaveCriticalSection(&m_MainQueueCS);
+}
+
+void FrameGraph::LogGraph() const {
+    for (const FrameTask& task : m_Tasks) {
+        std::string deps;
+        for (size_t dep : task.dependencies) {
+            if (!deps.empty()) deps += ", ";
+            deps += m_Tasks[dep].desc.name;
+        }
+        LOG_INFO("FrameGraph task {0} ({1}) after [{2}]", task.desc.name,
+                 task.desc.affinity == TaskAffinity::MainThread ? "main" : "any", deps);
+    }
+}
+
+}  // namespace gdp1
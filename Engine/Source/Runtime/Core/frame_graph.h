@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "job_system.h"
+
+namespace gdp1 {
+
+// Where a frame task is allowed to run. Anything touching GL must stay on the main thread.
+enum class TaskAffinity { Any, MainThread };
+
+struct FrameTaskDesc {
+    std::string name;
+    std::vector<std::string> reads;   // resources the task only reads
+    std::vector<std::string> writes;  // resources the task modifies
+    TaskAffinity affinity = TaskAffinity::Any;
+    std::function<void(float)> run;
+};
+
+// A per-frame task graph. Systems declare the resources they read and write, and the graph orders them so that
+// tasks touching disjoint data run concurrently on the JobSystem while GL work stays on the main thread.
+// Dependencies follow declaration order: a later task waits for every earlier task it has a read/write or
+// write/write hazard with, so declaring tasks in the old sequential order keeps the old semantics.
+class FrameGraph {
+public:
+    FrameGraph();
+    ~FrameGraph();
+
+    // Returns the index of the task. Adding a task invalidates the compiled graph.
+    size_t AddTask(const FrameTaskDesc& desc);
+
+    // Resolves the resource hazards into dependency edges. Called lazily by Execute.
+    void Compile();
+
+    // Runs every task once and returns when all of them have finished.
+    void Execute(float deltaTime);
+
+    size_t GetTaskCount() const { return m_Tasks.size(); }
+    const std::vector<size_t>& GetDependencies(size_t task) const { return m_Tasks[task].dependencies; }
+    const std::string& GetTaskName(size_t task) const { return m_Tasks[task].desc.name; }
+
+    void LogGraph() const;
+
+    // used by the task jobs
+    void OnTaskFinished(size_t task);
+
+private:
+    struct FrameTask {
+        FrameTaskDesc desc;
+        std::vector<size_t> dependencies;
+        std::vector<size_t> dependents;
+        volatile LONG pendingDependencies = 0;
+    };
+
+    static bool HasHazard(const FrameTaskDesc& earlier, const FrameTaskDesc& later);
+    static bool Contains(const std::vector<std::string>& resources, const std::string& resource);
+
+    void Dispatch(size_t task);
+
+private:
+    std::vector<FrameTask> m_Tasks;
+    bool m_Compiled = false;
+
+    float m_DeltaTime = 0.0f;
+    volatile LONG m_RemainingTasks = 0;
+
+    // main thread tasks that became ready while workers were running
+    std::vector<size_t> m_ReadyMainTasks;
+    CRITICAL_SECTION m_MainQueueCS;
+    CONDITION_VARIABLE m_MainQueueCV;
+
+    JobCounter m_Counter;
+};
+
+}  // namespace gdp1
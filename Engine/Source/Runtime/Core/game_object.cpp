@@ -3,7 +3,9 @@
 #include "Physics/bounds.h"
 #include "Render/model.h"
 #include "Utils/unique_id_generator.h"
-#include "Animation/character_animation.h"
+#include "Animation/animator_instance.h"
+#include "Render/scene.h"
+#include "components.h"
 #include "Utils/glm_utils.h"
 
 namespace gdp1 {
@@ -16,6 +18,7 @@ GameObject::GameObject(Scene* scn, const GameObjectDesc& desc)
     , visible(desc.visible)
     , hasFBO(desc.hasFBO)
     , isStatic(desc.isStatic)
+    , isOccluder(desc.isOccluder)
     , setLit(desc.setLit) {
     id = UniqueId::GenerateId();
     transform = new Transform(this, desc.transform);
@@ -34,7 +37,7 @@ GameObject::GameObject(Scene* scn, const std::string& name)
     transform = new Transform(this);
 }
 
-GameObject::~GameObject() {}
+GameObject::~GameObject() { delete animator; }
 
 const Bounds& GameObject::GetBounds() {
     assert(model != nullptr);
@@ -59,65 +62,58 @@ Bounds GameObject::GetTransformedBounds() {
 void GameObject::SetCurrentAnimation(std::string name) {
     if (model == nullptr) return;
 
-    this->currentAnim = name;
-    auto it = model->character_animations.find(name);
-    if (it != model->character_animations.end()) {
-        currentAnimation = it->second;
-        blendFactor = 0.0f;
-    } else {
-        currentAnimation = nullptr;
-    }
+    if (animator == nullptr) CreateAnimator();
 
-    // if (this->prevAnimation == nullptr) this->prevAnimation = this->currentAnimation;
+    this->currentAnim = name;
+    animator->blendDuration = blendDuration;
+    animator->Play(name);
 }
 
-void GameObject::UpdateAnimation(Shader* shader, float deltaTime) {
-    if (currentAnimation) {
-        elapsedAnimationTime += deltaTime;
+void GameObject::SetBlendTree(const std::string& name) {
+    if (model == nullptr) return;
 
-        if (blendFactor < 1.0f) {
-            blendFactor += deltaTime / blendDuration;
-        }
+    const BlendTree* tree = model->FindBlendTree(name);
+    if (tree == nullptr) {
+        LOG_WARN("Model has no blend tree named {0}", name);
+        return;
+    }
 
-        if (blendFactor > 1.0f) {
-            blendFactor = 1.0f;
-            prevAnimation = currentAnimation;
-        }
+    if (animator == nullptr) CreateAnimator();
 
-        std::vector<aiMatrix4x4> transforms;
+    this->currentAnim = name;
+    animator->SetBlendTree(tree);
+}
 
-        uint32_t startAnimIndex = GetAnimationIndex(prevAnimation);
-        uint32_t endAnimIndex = GetAnimationIndex(currentAnimation);
+void GameObject::CreateAnimator() {
+    animator = new AnimatorInstance(model);
 
-        if (startAnimIndex == -1) startAnimIndex = endAnimIndex;
+    if (scene != nullptr && entity != INVALID_ENTITY) {
+        AnimatorComponent component = {this, animator};
+        scene->GetRegistry().Add<AnimatorComponent>(entity, component);
+    }
+}
+
+void GameObject::SetAnimationParameter(const std::string& name, float value) {
+    if (animator != nullptr) animator->SetParameter(name, value);
+}
 
-        currentAnimation->boneTransformsBlended(elapsedAnimationTime, transforms, startAnimIndex, endAnimIndex,
-                                                blendFactor);
+void GameObject::ApplyRootMotion(float dt) {
+    if (animator == nullptr) return;
 
-        shader->SetUniform("u_HasBones", true);
+    // always consume, so switching root motion on does not jump by everything played so far
+    glm::vec3 delta = animator->ConsumeRootMotion();
+    if (!applyRootMotion || dt <= 0.0f) return;
 
-        for (unsigned int i = 0; i < transforms.size(); i++) {
-            std::string name = "bones[" + std::to_string(i) + "]";
-            shader->SetUniform(name, GLMUtils::aiMatrix4x4ToGlmMat4(transforms[i]));
-        }
-    } else {
-        shader->SetUniform("u_HasBones", false);
-    }
-    
-    model->currentAnimation = currentAnimation;
-    model->prevAnimation = prevAnimation;
-}
+    // model space to world space, keeping the object's rotation and scale
+    delta = glm::mat3(transform->WorldMatrix()) * delta;
 
-uint32_t GameObject::GetAnimationIndex(CharacterAnimation* animation) {
-    uint32_t index = 0;
-    for (const auto& pair : model->character_animations) {
-        if (pair.second == animation) {
-            return index;
-        }
-        ++index;
+    if (rigidBody != nullptr && rigidBody->active && rigidBody->applyGravity && rigidBody->invMass != 0.0f) {
+        rigidBody->velocity.x = delta.x / dt;
+        rigidBody->velocity.z = delta.z / dt;
+        return;
     }
 
-    return -1;
+    transform->SetPosition(glm::vec3(transform->WorldMatrix()[3]) + delta);
 }
 
 void GameObject::Update(float dt) {}
@@ -2,6 +2,8 @@
 
 #include "Resource/level_object_description.h"
 #include "transform.h"
+#include "entity_registry.h"
+#include "handle.h"
 #include "Physics/contact.h"
 #include "Physics/rigidbody.h"
 #include "Utils/fly_camera_controller.h"
@@ -16,11 +18,15 @@ class Bounds;
 class Animation;
 class SoftBody;
 class UniqueId;
-class CharacterAnimation;
+class AnimatorInstance;
 
+// The object game code works with. The scene also registers it as an entity with the components the engine's
+// systems iterate (see components.h), so those systems do not have to go through the scene's name map.
 class GameObject {
 public:
     int id;
+    Entity entity = INVALID_ENTITY;  // set when the scene adds the object
+    Handle<GameObject> handle;       // set when the scene adds the object
     std::string name;
     std::string modelName;
     Transform* transform;
@@ -34,6 +40,8 @@ public:
     bool hasFBO = false;
     bool setLit = false;
     bool isStatic = false;
+    bool isOccluder = false;  // solid enough to hide what is behind it, see OcclusionCuller
+    unsigned int lodLevel = 0;  // into model->lodLevels, picked by the LODSystem every frame
 
     // FBO Attributes
     bool UseChromaticAberration = false;
@@ -46,16 +54,15 @@ public:
     std::vector<std::string> childrenNames;
     std::string parentName;
 
-    CharacterAnimation* currentAnimation;
-    CharacterAnimation* prevAnimation;
+    // created by the first SetCurrentAnimation, owns this object's playback state and pose
+    AnimatorInstance* animator = nullptr;
 
     std::string currentAnim = "";
 
     float blendDuration = 0.4f;
 
-private:
-    float elapsedAnimationTime = 0.0f;
-    float blendFactor = 0.0f;
+    // moves the object by the root motion of its animation instead of leaving it in place
+    bool applyRootMotion = false;
 
 public:
     GameObject() = delete;
@@ -71,9 +78,20 @@ public:
 
     Bounds GetTransformedBounds();
 
-    void UpdateAnimation(Shader* shader, float deltaTime);
     void SetCurrentAnimation(std::string name);
-    uint32_t GetAnimationIndex(CharacterAnimation* animation);
+
+    // Lets one of the model's blend trees drive the animation, game code then only changes its parameters.
+    void SetBlendTree(const std::string& name);
+    void SetAnimationParameter(const std::string& name, float value);
+
+    // Moves the object by the root motion the animator accumulated since the last call. A dynamic rigid body gets it
+    // as horizontal velocity so the physics step keeps resolving collisions, anything else is moved directly.
+    void ApplyRootMotion(float dt);
+
+private:
+    void CreateAnimator();
 };
 
+typedef Handle<GameObject> GameObjectHandle;
+
 }  // namespace gdp1
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "string_table.h"
+
+namespace gdp1 {
+
+// Refers to an object in a HandleTable. A handle to a removed object stays invalid even after its slot is reused,
+// because the slot's generation has moved on.
+template <typename T>
+struct Handle {
+    uint32_t index = 0;
+    uint32_t generation = 0;  // 0 is never handed out
+
+    bool IsValid() const { return generation != 0; }
+
+    bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+// Objects of one type addressed by generational handles, optionally by interned name.
+// Resolving a handle is an array access and a generation compare. The table does not own the objects.
+template <typename T>
+class HandleTable {
+public:
+    Handle<T> Add(T* object, StringId name = INVALID_STRING_ID) {
+        uint32_t index;
+        if (!m_FreeSlots.empty()) {
+            index = m_FreeSlots.back();
+            m_FreeSlots.pop_back();
+        } else {
+            index = static_cast<uint32_t>(m_Slots.size());
+            m_Slots.push_back(Slot());
+        }
+
+        Slot& slot = m_Slots[index];
+        slot.object = object;
+        slot.name = name;
+
+        if (name != INVALID_STRING_ID) m_Names[name] = index;
+
+        Handle<T> handle;
+        handle.index = index;
+        handle.generation = slot.generation;
+        return handle;
+    }
+
+    void Remove(Handle<T> handle) {
+        if (Get(handle) == nullptr) return;
+
+        Slot& slot = m_Slots[handle.index];
+        if (slot.name != INVALID_STRING_ID) {
+            // the name may have been given to an object added since, it keeps it then
+            typename std::unordered_map<StringId, uint32_t>::iterator it = m_Names.find(slot.name);
+            if (it != m_Names.end() && it->second == handle.index) m_Names.erase(it);
+        }
+
+        slot.object = nullptr;
+        slot.name = INVALID_STRING_ID;
+        if (++slot.generation == 0) slot.generation = 1;
+        m_FreeSlots.push_back(handle.index);
+    }
+
+    // nullptr if the handle is invalid or its object was removed
+    T* Get(Handle<T> handle) const {
+        if (handle.index >= m_Slots.size()) return nullptr;
+
+        const Slot& slot = m_Slots[handle.index];
+        return slot.generation == handle.generation ? slot.object : nullptr;
+    }
+
+    // an invalid handle if no object has that name
+    Handle<T> Find(StringId name) const {
+        Handle<T> handle;
+
+        typename std::unordered_map<StringId, uint32_t>::const_iterator it = m_Names.find(name);
+        if (it != m_Names.end()) {
+            handle.index = it->second;
+            handle.generation = m_Slots[it->second].generation;
+        }
+
+        return handle;
+    }
+
+    Handle<T> Find(const std::string& name) const { return Find(StringTable::Find(name)); }
+
+private:
+    struct Slot {
+        T* object = nullptr;
+        StringId name = INVALID_STRING_ID;
+        uint32_t generation = 1;
+    };
+
+    std::vector<Slot> m_Slots;
+    std::vector<uint32_t> m_FreeSlots;
+    std::unordered_map<StringId, uint32_t> m_Names;
+};
+
+}  // namespace gdp1
@@ -0,0 +1,170 @@
+#include "job_system.h"
+
+#include "Core/logger.h"
+
+DWORD WINAPI JobWorkerThread(LPVOID lpParameter);
+
+namespace gdp1 {
+
+std::deque<Job> JobSystem::s_Jobs;
+std::vector<HANDLE> JobSystem::s_Workers;
+std::vector<JobWorkerThreadInfo*> JobSystem::s_WorkerInfos;
+CRITICAL_SECTION JobSystem::s_QueueCS;
+CONDITION_VARIABLE JobSystem::s_QueueCV;
+bool JobSystem::s_Initialized = false;
+
+void JobSystem::Init(unsigned int numThreads) {
+    if (s_Initialized) return;
+
+    InitializeCriticalSection(&s_QueueCS);
+    InitializeConditionVariable(&s_QueueCV);
+    s_Initialized = true;
+
+    if (numThreads == 0) {
+        SYSTEM_INFO sysInfo;
+        GetSystemInfo(&sysInfo);
+        numThreads = sysInfo.dwNumberOfProcessors > 1 ? sysInfo.dwNumberOfProcessors - 1 : 1;
+    }
+
+    for (unsigned int i = 0; i < numThreads; i++) {
+        JobWorkerThreadInfo* info = new JobWorkerThreadInfo();
+        info->index = i;
+        info->isAlive = true;
+
+        DWORD threadId;
+        HANDLE hThread = CreateThread(NULL, 0, JobWorkerThread, (LPVOID)info, 0, &(threadId));
+        if (hThread != NULL) {
+            s_Workers.push_back(hThread);
+            s_WorkerInfos.push_back(info);
+        } else {
+            delete info;
+        }
+    }
+
+    LOG_INFO("JobSystem started {0} worker threads", s_Workers.size());
+}
+
+void JobSystem::Shutdown() {
+    if (!s_Initialized) return;
+
+    EnterCriticalSection(&s_QueueCS);
+    for (JobWorkerThreadInfo* info : s_WorkerInfos) {
+        info->isAlive = false;
+    }
+    WakeAllConditionVariable(&s_QueueCV);
+    LeaveCriticalSection(&s_QueueCS);
+
+    if (!s_Workers.empty()) {
+        WaitForMultipleObjects(static_cast<DWORD>(s_Workers.size()), s_Workers.data(), TRUE, INFINITE);
+    }
+
+    for (HANDLE hThread : s_Workers) {
+        CloseHandle(hThread);
+    }
+    for (JobWorkerThreadInfo* info : s_WorkerInfos) {
+        delete info;
+    }
+
+    s_Workers.clear();
+    s_WorkerInfos.clear();
+    s_Jobs.clear();
+
+    DeleteCriticalSection(&s_QueueCS);
+    s_Initialized = false;
+}
+
+void JobSystem::Execute(const std::function<void()>& task, JobCounter* counter) {
+    Job job;
+    job.task = task;
+    job.counter = counter;
+
+    if (counter) InterlockedIncrement(&counter->pending);
+
+    // no workers: run inline so callers don't need to care whether the pool is up
+    if (!s_Initialized || s_Workers.empty()) {
+        RunJob(job);
+        return;
+    }
+
+    EnterCriticalSection(&s_QueueCS);
+    s_Jobs.push_back(job);
+    WakeConditionVariable(&s_QueueCV);
+    LeaveCriticalSection(&s_QueueCS);
+}
+
+void JobSystem::ParallelFor(unsigned int count, unsigned int batchSize,
+                            const std::function<void(unsigned int, unsigned int)>& func) {
+    if (count == 0) return;
+    if (batchSize == 0) batchSize = 1;
+
+    // a single batch is cheaper to run on the calling thread
+    if (count <= batchSize) {
+        func(0, count);
+        return;
+    }
+
+    JobCounter counter;
+    for (unsigned int begin = 0; begin < count; begin += batchSize) {
+        unsigned int end = begin + batchSize < count ? begin + batchSize : count;
+        Execute([&func, begin, end]() { func(begin, end); }, &counter);
+    }
+
+    Wait(&counter);
+}
+
+void JobSystem::Wait(JobCounter* counter) {
+    if (counter == nullptr) return;
+
+    while (!counter->IsDone()) {
+        // help the workers instead of idling
+        if (!TryRunPendingJob()) Sleep(0);
+    }
+}
+
+bool JobSystem::TryRunPendingJob() {
+    Job job;
+    if (!TryPopJob(job)) return false;
+
+    RunJob(job);
+    return true;
+}
+
+bool JobSystem::TryPopJob(Job& job) {
+    if (!s_Initialized) return false;
+
+    bool found = false;
+    EnterCriticalSection(&s_QueueCS);
+    if (!s_Jobs.empty()) {
+        job = s_Jobs.front();
+        s_Jobs.pop_front();
+        found = true;
+    }
+    LeaveCriticalSection(&s_QueueCS);
+
+    return found;
+}
+
+bool JobSystem::WaitForJob(Job& job, volatile bool& isAlive) {
+    EnterCriticalSection(&s_QueueCS);
+    while (s_Jobs.empty() && isAlive) {
+        SleepConditionVariableCS(&s_QueueCV, &s_QueueCS, INFINITE);
+    }
+
+    if (!isAlive) {
+        LeaveCriticalSection(&s_QueueCS);
+        return false;
+    }
+
+    job = s_Jobs.front();
+    s_Jobs.pop_front();
+    LeaveCriticalSection(&s_QueueCS);
+
+    return true;
+}
+
+void JobSystem::RunJob(Job& job) {
+    if (job.task) job.task();
+    if (job.counter) InterlockedDecrement(&job.counter->pending);
+}
+
+}  // namespace gdp1
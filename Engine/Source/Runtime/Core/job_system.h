@@ -0,0 +1,68 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <functional>
+#include <Windows.h>
+
+namespace gdp1 {
+
+// Counts the jobs of a batch that are still in flight. Wait on it with JobSystem::Wait.
+struct JobCounter {
+    volatile LONG pending = 0;
+
+    bool IsDone() const { return pending == 0; }
+};
+
+struct Job {
+    std::function<void()> task;
+    JobCounter* counter = nullptr;
+};
+
+struct JobWorkerThreadInfo;
+
+// A fixed pool of worker threads pulling jobs from a shared queue.
+// Threads that wait on a counter help drain the queue, so waiting from inside a job never deadlocks.
+class JobSystem {
+public:
+    // Starts one worker per hardware thread minus the main thread (numThreads = 0 picks that automatically).
+    static void Init(unsigned int numThreads = 0);
+    static void Shutdown();
+
+    static void Execute(const std::function<void()>& task, JobCounter* counter = nullptr);
+
+    // Splits [0, count) into batches of batchSize and runs func(begin, end) for each batch on the pool.
+    // Blocks until every batch is done.
+    static void ParallelFor(unsigned int count, unsigned int batchSize,
+                            const std::function<void(unsigned int, unsigned int)>& func);
+
+    static void Wait(JobCounter* counter);
+
+    // Pops one queued job and runs it on the calling thread. Returns false if the queue was empty.
+    static bool TryRunPendingJob();
+
+    static unsigned int GetNumWorkers() { return static_cast<unsigned int>(s_Workers.size()); }
+
+    // used by the worker threads
+    static bool WaitForJob(Job& job, volatile bool& isAlive);
+    static void RunJob(Job& job);
+
+private:
+    static bool TryPopJob(Job& job);
+
+private:
+    static std::deque<Job> s_Jobs;
+    static std::vector<HANDLE> s_Workers;
+    static std::vector<JobWorkerThreadInfo*> s_WorkerInfos;
+
+    static CRITICAL_SECTION s_QueueCS;
+    static CONDITION_VARIABLE s_QueueCV;
+    static bool s_Initialized;
+};
+
+struct JobWorkerThreadInfo {
+    unsigned int index = 0;
+    volatile bool isAlive = true;
+};
+
+}  // namespace gdp1
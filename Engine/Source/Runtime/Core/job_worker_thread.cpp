@@ -0,0 +1,15 @@
+#include "job_system.h"
+
+DWORD WINAPI JobWorkerThread(LPVOID lpParameter) {
+    gdp1::JobWorkerThreadInfo* tInfo = reinterpret_cast<gdp1::JobWorkerThreadInfo*>(lpParameter);
+    if (!tInfo) {
+        return 1;
+    }
+
+    gdp1::Job job;
+    while (gdp1::JobSystem::WaitForJob(job, tInfo->isAlive)) {
+        gdp1::JobSystem::RunJob(job);
+    }
+
+    return 0;
+}
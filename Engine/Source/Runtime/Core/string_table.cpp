@@ -0,0 +1,69 @@
+#include "string_table.h"
+
+#include <deque>
+#include <unordered_map>
+#include <Windows.h>
+
+namespace gdp1 {
+
+namespace {
+
+struct StringTableData {
+    StringTableData() {
+        InitializeCriticalSection(&cs);
+        strings.push_back(std::string());  // INVALID_STRING_ID
+    }
+    ~StringTableData() { DeleteCriticalSection(&cs); }
+
+    CRITICAL_SECTION cs;
+    std::unordered_map<std::string, StringId> ids;
+    std::deque<std::string> strings;  // a deque never moves its strings, so references stay valid
+};
+
+StringTableData& GetData() {
+    static StringTableData s_Data;
+    return s_Data;
+}
+
+}  // namespace
+
+StringId StringTable::Intern(const std::string& str) {
+    StringTableData& data = GetData();
+
+    EnterCriticalSection(&data.cs);
+    std::unordered_map<std::string, StringId>::iterator it = data.ids.find(str);
+    StringId id;
+    if (it != data.ids.end()) {
+        id = it->second;
+    } else {
+        id = static_cast<StringId>(data.strings.size());
+        data.strings.push_back(str);
+        data.ids.emplace(str, id);
+    }
+    LeaveCriticalSection(&data.cs);
+
+    return id;
+}
+
+StringId StringTable::Find(const std::string& str) {
+    StringTableData& data = GetData();
+
+    EnterCriticalSection(&data.cs);
+    std::unordered_map<std::string, StringId>::iterator it = data.ids.find(str);
+    StringId id = it != data.ids.end() ? it->second : INVALID_STRING_ID;
+    LeaveCriticalSection(&data.cs);
+
+    return id;
+}
+
+const std::string& StringTable::GetString(StringId id) {
+    StringTableData& data = GetData();
+
+    EnterCriticalSection(&data.cs);
+    const std::string& str = id < data.strings.size() ? data.strings[id] : data.strings[INVALID_STRING_ID];
+    LeaveCriticalSection(&data.cs);
+
+    return str;
+}
+
+}  // namespace gdp1
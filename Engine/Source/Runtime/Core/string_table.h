@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace gdp1 {
+
+typedef uint32_t StringId;
+
+const StringId INVALID_STRING_ID = 0;
+
+// Interns names into small integer ids, so name lookups hash an integer instead of a string.
+// Names are resolved once when something is created or looked up by tooling, hot paths only pass ids around.
+// Thread safe.
+class StringTable {
+public:
+    // Returns the id of the string, adding it if it is new.
+    static StringId Intern(const std::string& str);
+    // Returns INVALID_STRING_ID if the string was never interned.
+    static StringId Find(const std::string& str);
+    // The empty string for INVALID_STRING_ID.
+    static const std::string& GetString(StringId id);
+};
+
+}  // namespace gdp1
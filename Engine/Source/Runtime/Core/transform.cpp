@@ -2,6 +2,8 @@
 
 #include <glm/gtx/matrix_decompose.hpp>
 
+#include "Utils/transform_utils.h"
+
 namespace gdp1 {
 
 Transform::Transform(GameObject* go, const TransformDesc& desc)
@@ -11,6 +13,8 @@ Transform::Transform(GameObject* go, const TransformDesc& desc)
     , localPosition(desc.localPosition)
     , localEulerAngles(desc.localEulerAngles)
     , localScale(desc.localScale)
+    , m_WorldMatrix(glm::mat4(1.0f))
+    , m_InverseWorldMatrix(glm::mat4(1.0f))
     , hasChanged(true)
     , m_NeedToUpdateLocalMatrix(true)
     , m_NeedToUpdateLocalRotation(true) {
@@ -30,6 +34,7 @@ Transform::Transform(GameObject* go)
     , m_Scale(glm::vec3(1.0f))
     , m_Rotation(glm::quat(1.0f, 0.0f, 0.0f, 0.0f))
     , m_WorldMatrix(glm::mat4(1.0f))
+    , m_InverseWorldMatrix(glm::mat4(1.0f))
     , hasChanged(true)
     , m_NeedToUpdateLocalMatrix(true)
     , m_NeedToUpdateLocalRotation(true) {
@@ -95,12 +100,17 @@ glm::mat4 Transform::WorldMatrix() const {
     return m_WorldMatrix;
 }
 
+glm::mat4 Transform::InverseWorldMatrix() const {
+    return m_InverseWorldMatrix;
+}
+
 void Transform::SetWorldMatrix(const glm::mat4& mat) {
     m_LocalMatrix = glm::mat4(WorldToLocalMatrix()) * mat;
     glm::vec3 skew;
     glm::vec4 perspective;
     glm::decompose(m_LocalMatrix, localScale, localRotation, localPosition, skew, perspective);
     m_WorldMatrix = mat;
+    m_InverseWorldMatrix = TransformUtils::AffineInverse(mat);
     m_NeedToUpdateLocalMatrix = false;
     hasChanged = true;
 }
@@ -116,7 +126,7 @@ glm::mat4 Transform::WorldToLocalMatrix() const {
     if (parent == nullptr) {
         return glm::mat4(1.0f);
     }
-    return glm::inverse(parent->WorldMatrix());
+    return parent->InverseWorldMatrix();
 }
 
 void Transform::UpdateLocalMatrix() {
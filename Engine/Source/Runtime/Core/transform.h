@@ -41,6 +41,7 @@ struct Transform {
 
     glm::mat4 LocalMatrix() const;
     glm::mat4 WorldMatrix() const;
+    glm::mat4 InverseWorldMatrix() const;  // cached with the world matrix, kept up to date for transforms with children
     void SetWorldMatrix(const glm::mat4& mat);
 
     glm::mat4 LocalToWorldMatrix()
@@ -51,12 +52,15 @@ struct Transform {
     void UpdateLocalMatrix();
 
 private:
+    friend class TransformHierarchy;
+
     glm::vec3 m_Position;  // The world space position of the Transform.
     glm::quat m_Rotation;  // A Quaternion that stores the rotation of the Transform in world space.
     glm::vec3 m_Scale;     // The global scale of the object (Read Only).
 
     glm::mat4 m_LocalMatrix;  // The local transform matrix.
     glm::mat4 m_WorldMatrix;  // The world transform matrix.
+    glm::mat4 m_InverseWorldMatrix;  // The inverse of the world transform matrix.
 
     bool m_NeedToUpdateLocalMatrix;    // Does the local matrix need to be updated?
     bool m_NeedToUpdateLocalRotation;  // Does the local rotation need to be updated?
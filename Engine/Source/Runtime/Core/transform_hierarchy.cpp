@@ -0,0 +1,106 @@
+#include "transform_hierarchy.h"
+
+#include <algorithm>
+
+#include "transform.h"
+#include "job_system.h"
+#include "Utils/transform_utils.h"
+
+namespace gdp1 {
+
+void TransformHierarchy::Build(Transform* root) {
+    m_Transforms.clear();
+    m_Parents.clear();
+    m_LevelStarts.clear();
+
+    // breadth first, so the transforms of one depth are contiguous
+    for (Transform* child : root->children) {
+        m_Transforms.push_back(child);
+        m_Parents.push_back(-1);
+    }
+
+    unsigned int levelStart = 0;
+    while (levelStart < m_Transforms.size()) {
+        m_LevelStarts.push_back(levelStart);
+
+        unsigned int levelEnd = static_cast<unsigned int>(m_Transforms.size());
+        for (unsigned int i = levelStart; i < levelEnd; i++) {
+            for (Transform* child : m_Transforms[i]->children) {
+                m_Transforms.push_back(child);
+                m_Parents.push_back(static_cast<int>(i));
+            }
+        }
+
+        levelStart = levelEnd;
+    }
+    m_LevelStarts.push_back(static_cast<unsigned int>(m_Transforms.size()));
+
+    size_t count = m_Transforms.size();
+    m_Locals.resize(count);
+    m_Worlds.resize(count);
+    m_Dirty.assign((count + 63) / 64, 0);
+
+    // start from a complete state
+    for (size_t i = 0; i < count; i++) {
+        m_Transforms[i]->hasChanged = true;
+    }
+
+    m_NeedsRebuild = false;
+}
+
+void TransformHierarchy::Update(Transform* root) {
+    if (m_NeedsRebuild) Build(root);
+
+    unsigned int count = GetCount();
+
+    // a transform is dirty if it changed or anything above it did, parents are marked before their children
+    std::fill(m_Dirty.begin(), m_Dirty.end(), 0);
+    m_NumDirty = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        int parent = m_Parents[i];
+        if (m_Transforms[i]->hasChanged || (parent >= 0 && IsDirty(parent))) {
+            m_Dirty[i >> 6] |= uint64_t(1) << (i & 63);
+            m_NumDirty++;
+        }
+    }
+
+    if (m_NumDirty == 0) return;
+
+    for (size_t level = 0; level + 1 < m_LevelStarts.size(); level++) {
+        unsigned int begin = m_LevelStarts[level];
+        unsigned int end = m_LevelStarts[level + 1];
+
+        if (end - begin < PARALLEL_LEVEL_SIZE) {
+            UpdateRange(begin, end);
+        } else {
+            // the level only writes its own transforms and reads finished parents
+            JobSystem::ParallelFor(end - begin, 256, [this, begin](unsigned int first, unsigned int last) {
+                UpdateRange(begin + first, begin + last);
+            });
+        }
+    }
+}
+
+void TransformHierarchy::UpdateRange(unsigned int begin, unsigned int end) {
+    for (unsigned int i = begin; i < end; i++) {
+        if (!IsDirty(i)) continue;
+
+        Transform* xform = m_Transforms[i];
+        if (xform->hasChanged) {
+            xform->UpdateLocalMatrix();
+            m_Locals[i] = xform->m_LocalMatrix;
+        }
+
+        int parent = m_Parents[i];
+        m_Worlds[i] = parent < 0 ? m_Locals[i] : m_Worlds[parent] * m_Locals[i];
+
+        // the local values are already what the transform was set to, no need to decompose the world matrix
+        xform->m_WorldMatrix = m_Worlds[i];
+        // only children read the inverse, when they convert world space values in their setters
+        if (!xform->children.empty()) xform->m_InverseWorldMatrix = TransformUtils::AffineInverse(m_Worlds[i]);
+        xform->m_NeedToUpdateLocalMatrix = false;
+        xform->hasChanged = false;
+    }
+}
+
+}  // namespace gdp1
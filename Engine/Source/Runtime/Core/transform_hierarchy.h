@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_aligned.hpp>
+
+namespace gdp1 {
+
+struct Transform;
+
+// The scene's transform tree flattened into arrays sorted by depth, so every parent comes before its children and
+// the world matrices are resolved in one forward pass.
+// Only transforms that changed since the last update and the subtrees below them are recomputed. Levels with many
+// dirty transforms are split across the job system, a level only reads the level above it.
+class TransformHierarchy {
+public:
+    // Transforms were added, removed or re-parented, the arrays are rebuilt on the next Update.
+    void Invalidate() { m_NeedsRebuild = true; }
+
+    // Recomputes the world matrices of the changed transforms below root and clears their hasChanged flags.
+    // The root itself is not part of the hierarchy, its children are the top level.
+    void Update(Transform* root);
+
+    unsigned int GetCount() const { return static_cast<unsigned int>(m_Transforms.size()); }
+    // transforms recomputed by the last Update
+    unsigned int GetDirtyCount() const { return m_NumDirty; }
+
+private:
+    void Build(Transform* root);
+    void UpdateRange(unsigned int begin, unsigned int end);
+
+    bool IsDirty(unsigned int index) const { return (m_Dirty[index >> 6] >> (index & 63)) & 1; }
+
+private:
+    // levels with at least this many transforms are updated in parallel
+    static const unsigned int PARALLEL_LEVEL_SIZE = 1024;
+
+    bool m_NeedsRebuild = true;
+
+    // per transform, sorted by depth
+    std::vector<Transform*> m_Transforms;
+    std::vector<int> m_Parents;  // -1 for the top level
+    std::vector<glm::aligned_mat4> m_Locals;
+    std::vector<glm::aligned_mat4> m_Worlds;
+    std::vector<uint64_t> m_Dirty;  // one bit per transform
+
+    // first transform of each depth, plus the end
+    std::vector<unsigned int> m_LevelStarts;
+
+    unsigned int m_NumDirty = 0;
+};
+
+}  // namespace gdp1
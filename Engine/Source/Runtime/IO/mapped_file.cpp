@@ -0,0 +1,55 @@
+#include "mapped_file.h"
+
+#include <Windows.h>
+
+namespace gdp1 {
+
+MappedFile::MappedFile()
+    : m_File(INVALID_HANDLE_VALUE)
+    , m_Mapping(nullptr)
+    , m_Data(nullptr)
+    , m_Size(0) {}
+
+MappedFile::~MappedFile() { Close(); }
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+
+    m_File = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                         nullptr);
+    if (m_File == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_File, &size) || size.QuadPart == 0) {
+        Close();
+        return false;
+    }
+
+    m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_Mapping == nullptr) {
+        Close();
+        return false;
+    }
+
+    m_Data = (const char*)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+    if (m_Data == nullptr) {
+        Close();
+        return false;
+    }
+
+    m_Size = (size_t)size.QuadPart;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_Data != nullptr) UnmapViewOfFile(m_Data);
+    if (m_Mapping != nullptr) CloseHandle(m_Mapping);
+    if (m_File != INVALID_HANDLE_VALUE) CloseHandle(m_File);
+
+    m_File = INVALID_HANDLE_VALUE;
+    m_Mapping = nullptr;
+    m_Data = nullptr;
+    m_Size = 0;
+}
+
+}  // namespace gdp1
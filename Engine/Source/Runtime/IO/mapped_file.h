@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+namespace gdp1 {
+
+// A read-only memory mapped file. The OS pages the contents in on first touch, so loading costs next to nothing and
+// the data can be used in place.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return m_Data != nullptr; }
+    const char* GetData() const { return m_Data; }
+    size_t GetSize() const { return m_Size; }
+
+private:
+    void* m_File;
+    void* m_Mapping;
+    const char* m_Data;
+    size_t m_Size;
+};
+
+}  // namespace gdp1
@@ -88,9 +88,6 @@ ParticleSystem::ParticleSystem(std::shared_ptr<Scene> scene, unsigned int numPar
 void ParticleSystem::Render(std::shared_ptr<Camera> camera) {
     mat4 projection = camera->GetProjectionMatrix();
     mat4 view = camera->GetViewMatrix();
-    mat4 umodel = mat4(1.0f);
-    mat4 mv = view * umodel;
-    mat3 normalMatrix = mat3(vec3(mv[0]), vec3(mv[1]), vec3(mv[2]));
 
     std::unordered_map<std::string, GameObject*> culledParticles;
 
@@ -111,17 +108,8 @@ void ParticleSystem::Render(std::shared_ptr<Camera> camera) {
     particleModel->ResetInstancing();
     particleModel->SetupInstancing(instanceMatrices);*/
 
-    DirectionalLight* dirLight = scene->FindDirectionalLightByName("Sun");
-
-    vec3 lightDirViewSpace = normalMatrix * dirLight->direction;
-
+    // the camera and the lights come from the uniform blocks the renderer wrote for the frame
     scene->inst_shader_ptr_->Use();
-    scene->inst_shader_ptr_->SetUniform("u_View", view);
-    scene->inst_shader_ptr_->SetUniform("u_Proj", projection);
-    scene->inst_shader_ptr_->SetUniform("u_NormalMat", normalMatrix);
-
-    scene->inst_shader_ptr_->SetUniform("u_DirLight.dir", lightDirViewSpace);
-    scene->inst_shader_ptr_->SetUniform("u_NumPointLights", (int)scene->m_PointLightMap.size());
     scene->inst_shader_ptr_->SetUniform("u_UseLights", true);
 
     particleModel->Draw(scene->inst_shader_ptr_);
@@ -2,6 +2,8 @@
 
 #include <common.h>
 
+#include "Render/light.h"
+
 namespace gdp1 {
 
 class Scene;
@@ -87,12 +87,17 @@ glm::vec3 Bounds::GetMax() const { return max_; }
 
 glm::vec3 Bounds::GetSize() const { return max_ - min_; }
 
-void Bounds::TransformBounds(glm::mat4& worldMatrix) {
-    // Transform the min and max points of the bounding box by the world matrix
-    glm::vec3 transformedMin = glm::vec3(worldMatrix * glm::vec4(min_, 1.0f));
-    glm::vec3 transformedMax = glm::vec3(worldMatrix * glm::vec4(max_, 1.0f));
+void Bounds::TransformBounds(const glm::mat4& worldMatrix) {
+    // Arvo's method: the center moves with the matrix, and each new extent is the sum of the old extents projected
+    // onto that axis. Only transforming min and max would cut corners off a rotated box.
+    glm::vec3 center = glm::vec3(worldMatrix * glm::vec4(GetCenter(), 1.0f));
+    glm::vec3 extents = GetExtents();
 
-    SetMinMax(glm::min(transformedMin, transformedMax), glm::max(transformedMin, transformedMax));
+    glm::vec3 newExtents = glm::abs(glm::vec3(worldMatrix[0])) * extents.x +
+                           glm::abs(glm::vec3(worldMatrix[1])) * extents.y +
+                           glm::abs(glm::vec3(worldMatrix[2])) * extents.z;
+
+    SetMinMax(center - newExtents, center + newExtents);
 }
 
 }  // namespace gdp1
@@ -33,7 +33,8 @@ public:
 
     glm::vec3 GetSize() const;
 
-    void TransformBounds(glm::mat4& worldMatrix);
+    // Makes this the world space box around the transformed box, also under rotation.
+    void TransformBounds(const glm::mat4& worldMatrix);
 
 private:
     glm::vec3 min_;
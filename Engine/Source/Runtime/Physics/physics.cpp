@@ -7,6 +7,7 @@
 #include "collider.h"
 #include "contact.h"
 #include "Core/game_object.h"
+#include "Core/components.h"
 #include "intersections.h"
 #include "octree.h"
 #include "rigidbody.h"
@@ -28,7 +29,7 @@ Physics::~Physics() {
         delete rigidbodies_[i];
     }
     rigidbodies_.clear();
-    body_map_.clear();
+    body_handles_ = HandleTable<Rigidbody>();
 }
 
 void Physics::Init(Scene* scene, const LevelDesc& levelDesc) {
@@ -58,7 +59,7 @@ void Physics::Init(Scene* scene, const LevelDesc& levelDesc) {
 
         rigidbodies_.push_back(body);
 
-        body_map_.insert({objName, body});
+        body_handles_.Add(body, StringTable::Intern(objName));
     }
 
     // Init Soft bodies
@@ -83,7 +84,7 @@ void Physics::Init(Scene* scene, const LevelDesc& levelDesc) {
 
         softbodies_.push_back(body);
 
-        soft_body_map_.insert({objName, body});
+        soft_body_handles_.Add(body, StringTable::Intern(objName));
     }
 
     //CreateBVH();
@@ -100,6 +101,14 @@ void Physics::CreateBVH() {
 }
 
 void Physics::FixedUpdate(float deltaTime) {
+    Simulate(deltaTime);
+    UpdateGameObjects(deltaTime);
+    Integrate(deltaTime);
+}
+
+void Physics::Simulate(float deltaTime) {
+    contacts_.clear();
+
     for (Rigidbody* body : rigidbodies_) {
         if (body->invMass == 0.0 || !body->active || !body->applyGravity) continue;
 
@@ -135,18 +144,22 @@ void Physics::FixedUpdate(float deltaTime) {
         Contact contact;
         if (Intersect(bodyA, bodyB, contact)) {
             ResolveContact(contact);
-            bodyA->object->OnCollision(&contact);
-            // bodyA->object->OnCollision(info);
+            contacts_.push_back(contact);
         }
     }
+}
 
-    std::unordered_map<std::string, GameObject*> m_GameObjectMap = scene->GetGameObjectMap();
-
-    for (auto& pair : m_GameObjectMap) {
-        GameObject* gameObject = pair.second;
-        gameObject->Update(deltaTime);
+void Physics::UpdateGameObjects(float deltaTime) {
+    for (Contact& contact : contacts_) {
+        contact.bodyA->object->OnCollision(&contact);
     }
+    contacts_.clear();
 
+    scene->GetRegistry().Each<BehaviourComponent>([deltaTime](Entity entity, BehaviourComponent& behaviour) {
+        behaviour.object->ApplyRootMotion(deltaTime);
+        behaviour.object->Update(deltaTime);
+    });
+}
 
 #if 0
 	// the brute force way
@@ -174,6 +187,7 @@ void Physics::FixedUpdate(float deltaTime) {
 	}
 #endif
 
+void Physics::Integrate(float deltaTime) {
     // update position
     for (Rigidbody* body : rigidbodies_) {
         if (body->invMass == 0.0 || !body->applyGravity) continue;
@@ -212,18 +226,20 @@ bool Physics::AddImpulseToObject(const std::string& objectName, const glm::vec3&
     return true;
 }
 
-Rigidbody* Physics::FindRigidBodyByName(const std::string& name) const {
-    std::map<std::string, Rigidbody*>::const_iterator it = body_map_.find(name);
-    if (it == body_map_.end()) return nullptr;
+bool Physics::AddImpulseToObject(Handle<Rigidbody> handle, const glm::vec3& impulse) {
+    Rigidbody* body = body_handles_.Get(handle);
+    if (body == nullptr) return false;
 
-    return it->second;
+    body->ApplyImpulse(impulse);
+    return true;
 }
 
-SoftBody* Physics::FindSoftBodyByName(const std::string& name) const {
-    std::map<std::string, SoftBody*>::const_iterator it = soft_body_map_.find(name);
-    if (it == soft_body_map_.end()) return nullptr;
+Rigidbody* Physics::FindRigidBodyByName(const std::string& name) const {
+    return body_handles_.Get(body_handles_.Find(name));
+}
 
-    return it->second;
+SoftBody* Physics::FindSoftBodyByName(const std::string& name) const {
+    return soft_body_handles_.Get(soft_body_handles_.Find(name));
 }
 
 void Physics::DrawBVH(std::shared_ptr<Shader> shader) const {
@@ -5,13 +5,14 @@
 #include <map>
 
 #include "Resource/level_loader.h"
+#include "Physics/contact.h"
+#include "Core/handle.h"
 
 namespace gdp1 {
 
 // forward declaration
 class Rigidbody;
 class SoftBody;
-struct Contact;
 class Scene;
 class Octree;
 class Shader;
@@ -21,11 +22,27 @@ public:
     Physics(Scene* scene, const LevelDesc& levelDesc);
     ~Physics();
 
+    // Runs the three stages below in order.
     void FixedUpdate(float deltaTime);
 
+    // Gravity, broad phase and narrow phase. Touches only rigidbodies, safe to run on a worker thread. The contacts
+    // are kept for UpdateGameObjects, collision callbacks are game code and may touch anything.
+    void Simulate(float deltaTime);
+
+    // Reports the contacts of the last Simulate, then applies root motion and calls Update on every game object.
+    // Game objects may poll input, so this stays on the main thread.
+    void UpdateGameObjects(float deltaTime);
+
+    // Integrates velocities and writes the new positions to the transforms.
+    void Integrate(float deltaTime);
+
     bool AddImpulseToObject(const std::string& objectName, const glm::vec3& impulse);
+    bool AddImpulseToObject(Handle<Rigidbody> body, const glm::vec3& impulse);
 
     Rigidbody* FindRigidBodyByName(const std::string& name) const;
+    // Resolve the name once and keep the handle for code that runs every frame.
+    Handle<Rigidbody> FindRigidBodyHandle(const std::string& name) const { return body_handles_.Find(name); }
+    Rigidbody* GetRigidBody(Handle<Rigidbody> body) const { return body_handles_.Get(body); }
 
     SoftBody* FindSoftBodyByName(const std::string& name) const;
 
@@ -44,10 +61,13 @@ private:
     std::vector<Rigidbody*> rigidbodies_;
     std::vector<SoftBody*> softbodies_;
 
-    std::map<std::string, Rigidbody*> body_map_;
-    std::map<std::string, SoftBody*> soft_body_map_;
+    // by interned object name
+    HandleTable<Rigidbody> body_handles_;
+    HandleTable<SoftBody> soft_body_handles_;
 
     std::unique_ptr<Octree> octree_;
+
+    std::vector<Contact> contacts_;  // found by Simulate, reported by UpdateGameObjects
 };
 
 }  // namespace gdp1
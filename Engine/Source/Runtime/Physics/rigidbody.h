@@ -2,6 +2,7 @@
 
 #include "common.h"
 #include "bounds.h"
+#include "Core/handle.h"
 
 namespace gdp1 {
 
@@ -36,4 +37,6 @@ public:
     Bounds GetBounds() const;
 };
 
+typedef Handle<Rigidbody> RigidbodyHandle;
+
 }  // namespace gdp1
@@ -0,0 +1,132 @@
+#include "geometry_arena.h"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace gdp1 {
+
+namespace {
+
+const unsigned int INITIAL_VERTICES = 1 << 16;
+const unsigned int INITIAL_INDICES = 1 << 18;
+
+// Moves the first size bytes of buffer into a new buffer of capacity bytes and returns it.
+GLuint GrowBuffer(GLuint buffer, GLsizeiptr size, GLsizeiptr capacity) {
+    GLuint grown;
+    glGenBuffers(1, &grown);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+    glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_STATIC_DRAW);
+
+    if (buffer != 0) {
+        if (size > 0) {
+            glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &buffer);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return grown;
+}
+
+}  // namespace
+
+GeometryArena& GeometryArena::Get() {
+    static GeometryArena arena;
+    return arena;
+}
+
+GeometryArena::GeometryArena()
+    : m_VertexBuffer(0)
+    , m_IndexBuffer(0)
+    , m_VertexCapacity(0)
+    , m_IndexCapacity(0)
+    , m_NumVertices(0)
+    , m_NumIndices(0) {
+    m_VAO.ID = 0;
+}
+
+GeometryRange GeometryArena::Allocate(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
+    Reserve(m_NumVertices + (unsigned int)vertices.size(), m_NumIndices + (unsigned int)indices.size());
+
+    GeometryRange range;
+    range.firstIndex = m_NumIndices;
+    range.numIndices = (unsigned int)indices.size();
+    range.baseVertex = (int)m_NumVertices;
+    range.numVertices = (unsigned int)vertices.size();
+
+    // the copy targets leave the element buffer binding of whatever vertex array is bound alone
+    if (!vertices.empty()) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_VertexBuffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)m_NumVertices * sizeof(Vertex),
+                        (GLsizeiptr)vertices.size() * sizeof(Vertex), &vertices[0]);
+    }
+    if (!indices.empty()) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_IndexBuffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)m_NumIndices * sizeof(unsigned int),
+                        (GLsizeiptr)indices.size() * sizeof(unsigned int), &indices[0]);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    m_NumVertices += range.numVertices;
+    m_NumIndices += range.numIndices;
+    return range;
+}
+
+void GeometryArena::Reserve(unsigned int numVertices, unsigned int numIndices) {
+    if (m_VAO.ID == 0) m_VAO.Generate();
+
+    bool relink = false;
+
+    if (numVertices > m_VertexCapacity || m_VertexBuffer == 0) {
+        unsigned int capacity = std::max(numVertices, std::max(m_VertexCapacity * 2, INITIAL_VERTICES));
+        m_VertexBuffer = GrowBuffer(m_VertexBuffer, (GLsizeiptr)m_NumVertices * sizeof(Vertex),
+                                    (GLsizeiptr)capacity * sizeof(Vertex));
+        m_VertexCapacity = capacity;
+        relink = true;
+    }
+
+    if (numIndices > m_IndexCapacity || m_IndexBuffer == 0) {
+        unsigned int capacity = std::max(numIndices, std::max(m_IndexCapacity * 2, INITIAL_INDICES));
+        m_IndexBuffer = GrowBuffer(m_IndexBuffer, (GLsizeiptr)m_NumIndices * sizeof(unsigned int),
+                                   (GLsizeiptr)capacity * sizeof(unsigned int));
+        m_IndexCapacity = capacity;
+        relink = true;
+    }
+
+    // the vertex array keeps its name, draws recorded with it stay valid
+    if (relink) LinkAttributes();
+}
+
+void GeometryArena::LinkAttributes() {
+    m_VAO.Bind();
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_VertexBuffer);
+    m_VAO.LinkAttrib(0, 3, GL_FLOAT, sizeof(Vertex), (void*)0);
+    m_VAO.LinkAttrib(1, 3, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+    m_VAO.LinkAttrib(2, 2, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+    m_VAO.LinkAttrib(3, 3, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, tangent));
+    m_VAO.LinkAttrib(4, 3, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, bitangent));
+    m_VAO.Link_iAttrib(5, 4, GL_INT, sizeof(Vertex), (void*)offsetof(Vertex, boneIDs));
+    m_VAO.LinkAttrib(6, 4, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, weights));
+
+    // the element buffer binding is part of the vertex array's state
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBuffer);
+
+    m_VAO.Unbind();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GeometryArena::Delete() {
+    if (m_VAO.ID != 0) m_VAO.Delete();
+    if (m_VertexBuffer != 0) glDeleteBuffers(1, &m_VertexBuffer);
+    if (m_IndexBuffer != 0) glDeleteBuffers(1, &m_IndexBuffer);
+
+    m_VAO.ID = 0;
+    m_VertexBuffer = m_IndexBuffer = 0;
+    m_VertexCapacity = m_IndexCapacity = 0;
+    m_NumVertices = m_NumIndices = 0;
+}
+
+}  // namespace gdp1
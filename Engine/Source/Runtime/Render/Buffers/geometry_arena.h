@@ -0,0 +1,54 @@
+#pragma once
+#include <glad/glad.h>
+#include <vector>
+
+#include "vao.h"
+#include "vbo.h"
+
+namespace gdp1 {
+
+// Where a mesh's geometry lives in the arena. firstIndex counts indices, baseVertex is added to every index.
+struct GeometryRange {
+    unsigned int firstIndex = 0;
+    unsigned int numIndices = 0;
+    int baseVertex = 0;
+    unsigned int numVertices = 0;
+};
+
+// One vertex buffer and one index buffer shared by all static meshes, behind a single vertex array.
+// Meshes are appended one after the other and never freed, the buffers double when they run full and their contents
+// are copied on the GPU, so ranges handed out before stay valid. Drawing any mesh in the arena only needs the arena's
+// vertex array bound, which lets a whole pass go out with one glMultiDrawElementsIndirect.
+class GeometryArena {
+public:
+    static GeometryArena& Get();
+
+    // Copies the geometry into the arena. Creates the buffers on first use, needs a GL context.
+    GeometryRange Allocate(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+
+    GLuint GetVertexArray() const { return m_VAO.ID; }
+    unsigned int GetVertexCount() const { return m_NumVertices; }
+    unsigned int GetIndexCount() const { return m_NumIndices; }
+
+    // Deletes the buffers, the ranges handed out are invalid afterwards
+    void Delete();
+
+private:
+    GeometryArena();
+
+    void Reserve(unsigned int numVertices, unsigned int numIndices);
+    // points the vertex array at the current buffers
+    void LinkAttributes();
+
+private:
+    VAO m_VAO;
+    GLuint m_VertexBuffer;
+    GLuint m_IndexBuffer;
+
+    unsigned int m_VertexCapacity;
+    unsigned int m_IndexCapacity;
+    unsigned int m_NumVertices;
+    unsigned int m_NumIndices;
+};
+
+}  // namespace gdp1
@@ -0,0 +1,82 @@
+#include "ring_buffer.h"
+
+namespace gdp1 {
+
+RingBuffer::RingBuffer()
+    : ID(0)
+    , m_Target(GL_SHADER_STORAGE_BUFFER)
+    , m_RegionSize(0)
+    , m_NumRegions(0)
+    , m_Region(0)
+    , m_Mapped(nullptr) {}
+
+RingBuffer::~RingBuffer() { Delete(); }
+
+void RingBuffer::Create(GLenum target, GLsizeiptr regionSize, unsigned int numRegions) {
+    Delete();
+
+    // regions are bound with glBindBufferRange, keep every region start on the strictest offset alignment
+    GLint alignment = 256;
+    glGetIntegerv(target == GL_UNIFORM_BUFFER ? GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+                                              : GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT,
+                  &alignment);
+    if (alignment <= 0) alignment = 256;
+
+    m_Target = target;
+    m_RegionSize = (regionSize + alignment - 1) / alignment * alignment;
+    m_NumRegions = numRegions;
+    m_Region = numRegions - 1;
+    m_Fences.assign(numRegions, (GLsync)0);
+
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glGenBuffers(1, &ID);
+    glBindBuffer(m_Target, ID);
+    glBufferStorage(m_Target, m_RegionSize * m_NumRegions, nullptr, flags);
+    m_Mapped = (char*)glMapBufferRange(m_Target, 0, m_RegionSize * m_NumRegions, flags);
+    glBindBuffer(m_Target, 0);
+}
+
+void* RingBuffer::BeginRegion() {
+    m_Region = (m_Region + 1) % m_NumRegions;
+
+    GLsync& fence = m_Fences[m_Region];
+    if (fence) {
+        // only blocks when the CPU runs more than numRegions frames ahead of the GPU
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {
+        }
+        glDeleteSync(fence);
+        fence = (GLsync)0;
+    }
+
+    return m_Mapped + GetRegionOffset();
+}
+
+void RingBuffer::EndRegion() {
+    GLsync& fence = m_Fences[m_Region];
+    if (fence) glDeleteSync(fence);
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void RingBuffer::BindRange(GLuint index, GLsizeiptr offset, GLsizeiptr size) {
+    glBindBufferRange(m_Target, index, ID, GetRegionOffset() + offset, size);
+}
+
+void RingBuffer::Delete() {
+    for (GLsync& fence : m_Fences) {
+        if (fence) glDeleteSync(fence);
+        fence = (GLsync)0;
+    }
+
+    if (m_Mapped) {
+        glBindBuffer(m_Target, ID);
+        glUnmapBuffer(m_Target);
+        glBindBuffer(m_Target, 0);
+        m_Mapped = nullptr;
+    }
+
+    if (ID) glDeleteBuffers(1, &ID);
+    ID = 0;
+}
+
+}  // namespace gdp1
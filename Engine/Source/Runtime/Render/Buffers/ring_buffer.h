@@ -0,0 +1,46 @@
+#pragma once
+#include <glad/glad.h>
+#include <vector>
+
+namespace gdp1 {
+
+// A persistently mapped buffer split into one region per frame in flight.
+// The CPU writes the current region through a plain pointer while the GPU still reads the previous ones, and a fence
+// per region keeps the CPU from overwriting data that has not been consumed yet.
+class RingBuffer {
+public:
+    // ID reference of the buffer object
+    GLuint ID;
+
+    RingBuffer();
+    ~RingBuffer();
+
+    // Allocates numRegions regions of at least regionSize bytes each. Recreates the buffer if it already exists.
+    void Create(GLenum target, GLsizeiptr regionSize, unsigned int numRegions = 3);
+
+    // Moves to the next region, waits until the GPU is done with it and returns its mapped memory.
+    void* BeginRegion();
+    // Fences the current region. Call after the last draw that reads it.
+    void EndRegion();
+
+    // Binds [offset, offset + size) of the current region to an indexed binding point (SSBO/UBO).
+    void BindRange(GLuint index, GLsizeiptr offset, GLsizeiptr size);
+
+    GLsizeiptr GetRegionSize() const { return m_RegionSize; }
+    GLintptr GetRegionOffset() const { return (GLintptr)m_Region * m_RegionSize; }
+    bool IsCreated() const { return m_Mapped != nullptr; }
+
+    // Deletes the buffer
+    void Delete();
+
+private:
+    GLenum m_Target;
+    GLsizeiptr m_RegionSize;
+    unsigned int m_NumRegions;
+    unsigned int m_Region;
+
+    char* m_Mapped;
+    std::vector<GLsync> m_Fences;
+};
+
+}  // namespace gdp1
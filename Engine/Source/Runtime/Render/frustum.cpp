@@ -1,7 +1,10 @@
 #include "frustum.h"
 
-#include <Render/model.h>
-#include <Core/game_object.h>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#include <xmmintrin.h>
 
 namespace gdp1 {
 
@@ -45,7 +48,7 @@ void Frustum::Update(const glm::mat4& viewProjectionMatrix) {
                           viewProjectionMatrix[3][3] - viewProjectionMatrix[3][2]);
 }
 
-bool Frustum::IsBoxInFrustum(const glm::vec3& min, const glm::vec3& max) {
+bool Frustum::IsBoxInFrustum(const glm::vec3& min, const glm::vec3& max) const {
     for (int i = 0; i < 6; ++i) {
         if ((glm::dot(planes[i], glm::vec4(min.x, min.y, min.z, 1.0f)) < 0.0f) &&
             (glm::dot(planes[i], glm::vec4(max.x, min.y, min.z, 1.0f)) < 0.0f) &&
@@ -61,24 +64,170 @@ bool Frustum::IsBoxInFrustum(const glm::vec3& min, const glm::vec3& max) {
     return true;
 }
 
-std::unordered_map<std::string, GameObject*> Frustum::GetCulledObjects(
-    std::unordered_map<std::string, GameObject*>& gameObjectMap) {
-    std::unordered_map<std::string, GameObject*> culledObjects;
+int Frustum::ClassifyBox(const glm::vec3& min, const glm::vec3& max, unsigned int& planeMask, int& lastPlane) const {
+    glm::vec3 center = (min + max) * 0.5f;
+    glm::vec3 extents = (max - min) * 0.5f;
 
- #pragma omp parallel for
-    for (std::unordered_map<std::string, GameObject*>::iterator it = gameObjectMap.begin(); it != gameObjectMap.end();
-         it++) {
-        if (!it->second->visible) continue;
+    for (int k = 0; k < 6; ++k) {
+        // the plane that rejected the box last time first, then the others in order
+        int i = k == 0 ? lastPlane : (k <= lastPlane ? k - 1 : k);
+        if ((planeMask & (1u << i)) == 0) continue;
 
-        Bounds bounds = it->second->model->bounds;
-        bounds.TransformBounds(it->second->transform->WorldMatrix());
+        glm::vec3 normal = glm::vec3(planes[i]);
+        float distance = glm::dot(normal, center) + planes[i].w;
+        float radius = glm::dot(glm::abs(normal), extents);
 
-        if (IsBoxInFrustum(bounds.GetMin(), bounds.GetMax())) {
-            culledObjects[it->first] = it->second;
+        if (distance + radius < 0.0f) {
+            lastPlane = i;
+            return -1;
         }
+
+        if (distance - radius >= 0.0f) planeMask &= ~(1u << i);
+    }
+
+    return planeMask == 0 ? 1 : 0;
+}
+
+void Frustum::CullBoxes(const float* centerX, const float* centerY, const float* centerZ, const float* extentX,
+                        const float* extentY, const float* extentZ, unsigned int count, unsigned char* visible,
+                        unsigned int planeMask) const {
+    // the planes to test, with the absolute normals for the extents broadcast once
+    __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+    __m128 absX[6], absY[6], absZ[6];
+    int numPlanes = 0;
+    for (int i = 0; i < 6; ++i) {
+        if ((planeMask & (1u << i)) == 0) continue;
+
+        planeX[numPlanes] = _mm_set1_ps(planes[i].x);
+        planeY[numPlanes] = _mm_set1_ps(planes[i].y);
+        planeZ[numPlanes] = _mm_set1_ps(planes[i].z);
+        planeW[numPlanes] = _mm_set1_ps(planes[i].w);
+        absX[numPlanes] = _mm_set1_ps(fabsf(planes[i].x));
+        absY[numPlanes] = _mm_set1_ps(fabsf(planes[i].y));
+        absZ[numPlanes] = _mm_set1_ps(fabsf(planes[i].z));
+        numPlanes++;
+    }
+
+    const __m128 zero = _mm_setzero_ps();
+
+    unsigned int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // two groups of four, so the dependent multiply-adds of one group hide the latency of the other
+        __m128 cx0 = _mm_loadu_ps(centerX + i), cx1 = _mm_loadu_ps(centerX + i + 4);
+        __m128 cy0 = _mm_loadu_ps(centerY + i), cy1 = _mm_loadu_ps(centerY + i + 4);
+        __m128 cz0 = _mm_loadu_ps(centerZ + i), cz1 = _mm_loadu_ps(centerZ + i + 4);
+        __m128 ex0 = _mm_loadu_ps(extentX + i), ex1 = _mm_loadu_ps(extentX + i + 4);
+        __m128 ey0 = _mm_loadu_ps(extentY + i), ey1 = _mm_loadu_ps(extentY + i + 4);
+        __m128 ez0 = _mm_loadu_ps(extentZ + i), ez1 = _mm_loadu_ps(extentZ + i + 4);
+
+        __m128 outside0 = zero;
+        __m128 outside1 = zero;
+
+        for (int p = 0; p < numPlanes; ++p) {
+            // outside if distance + radius < 0
+            __m128 d0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], cx0), _mm_mul_ps(planeY[p], cy0)),
+                                   _mm_add_ps(_mm_mul_ps(planeZ[p], cz0), planeW[p]));
+            __m128 d1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], cx1), _mm_mul_ps(planeY[p], cy1)),
+                                   _mm_add_ps(_mm_mul_ps(planeZ[p], cz1), planeW[p]));
+            __m128 r0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absX[p], ex0), _mm_mul_ps(absY[p], ey0)),
+                                   _mm_mul_ps(absZ[p], ez0));
+            __m128 r1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absX[p], ex1), _mm_mul_ps(absY[p], ey1)),
+                                   _mm_mul_ps(absZ[p], ez1));
+
+            outside0 = _mm_or_ps(outside0, _mm_cmplt_ps(_mm_add_ps(d0, r0), zero));
+            outside1 = _mm_or_ps(outside1, _mm_cmplt_ps(_mm_add_ps(d1, r1), zero));
+        }
+
+        int outside = _mm_movemask_ps(outside0) | (_mm_movemask_ps(outside1) << 4);
+        for (int j = 0; j < 8; ++j) {
+            visible[i + j] = ((outside >> j) & 1) ^ 1;
+        }
+    }
+
+    for (; i < count; ++i) {
+        bool outside = false;
+        for (int p = 0; p < 6 && !outside; ++p) {
+            if ((planeMask & (1u << p)) == 0) continue;
+
+            float distance = planes[p].x * centerX[i] + planes[p].y * centerY[i] + planes[p].z * centerZ[i] +
+                             planes[p].w;
+            float radius = fabsf(planes[p].x) * extentX[i] + fabsf(planes[p].y) * extentY[i] +
+                           fabsf(planes[p].z) * extentZ[i];
+            outside = distance + radius < 0.0f;
+        }
+        visible[i] = outside ? 0 : 1;
+    }
+}
+
+void Frustum::Benchmark(const glm::mat4& viewProjectionMatrix, unsigned int numBoxes) {
+    typedef std::chrono::high_resolution_clock Clock;
+    const int RUNS = 10;
+
+    Frustum frustum;
+    frustum.Update(viewProjectionMatrix);
+
+    // boxes scattered around the origin, about what a large level holds
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> size(0.5f, 10.0f);
+
+    std::vector<glm::vec3> mins(numBoxes), maxs(numBoxes);
+    std::vector<float> centerX(numBoxes), centerY(numBoxes), centerZ(numBoxes);
+    std::vector<float> extentX(numBoxes), extentY(numBoxes), extentZ(numBoxes);
+    for (unsigned int i = 0; i < numBoxes; i++) {
+        glm::vec3 center(position(rng), position(rng) * 0.1f, position(rng));
+        glm::vec3 extents(size(rng), size(rng), size(rng));
+
+        mins[i] = center - extents;
+        maxs[i] = center + extents;
+        centerX[i] = center.x;
+        centerY[i] = center.y;
+        centerZ[i] = center.z;
+        extentX[i] = extents.x;
+        extentY[i] = extents.y;
+        extentZ[i] = extents.z;
+    }
+
+    std::vector<unsigned char> visible(numBoxes);
+    unsigned int cornerCount = 0, classifyCount = 0, batchCount = 0;
+
+    Clock::time_point start = Clock::now();
+    for (int run = 0; run < RUNS; run++) {
+        cornerCount = 0;
+        for (unsigned int i = 0; i < numBoxes; i++) {
+            if (frustum.IsBoxInFrustum(mins[i], maxs[i])) cornerCount++;
+        }
+    }
+    Clock::time_point cornerEnd = Clock::now();
+
+    for (int run = 0; run < RUNS; run++) {
+        classifyCount = 0;
+        for (unsigned int i = 0; i < numBoxes; i++) {
+            unsigned int mask = ALL_PLANES;
+            int lastPlane = 0;
+            if (frustum.ClassifyBox(mins[i], maxs[i], mask, lastPlane) >= 0) classifyCount++;
+        }
+    }
+    Clock::time_point classifyEnd = Clock::now();
+
+    for (int run = 0; run < RUNS; run++) {
+        frustum.CullBoxes(&centerX[0], &centerY[0], &centerZ[0], &extentX[0], &extentY[0], &extentZ[0], numBoxes,
+                          &visible[0]);
+    }
+    Clock::time_point batchEnd = Clock::now();
+
+    for (unsigned int i = 0; i < numBoxes; i++) {
+        batchCount += visible[i];
     }
 
-    return culledObjects;
+    typedef std::chrono::microseconds Micros;
+    LOG_INFO("Frustum benchmark, {0} boxes, microseconds per run", numBoxes);
+    LOG_INFO("  8 corners x 6 planes: {0} ({1} visible)",
+             std::chrono::duration_cast<Micros>(cornerEnd - start).count() / RUNS, cornerCount);
+    LOG_INFO("  center-extents:       {0} ({1} visible)",
+             std::chrono::duration_cast<Micros>(classifyEnd - cornerEnd).count() / RUNS, classifyCount);
+    LOG_INFO("  SoA SSE, 8 per loop:  {0} ({1} visible)",
+             std::chrono::duration_cast<Micros>(batchEnd - classifyEnd).count() / RUNS, batchCount);
 }
 
 }  // namespace gdp1
\ No newline at end of file
@@ -10,11 +10,24 @@ class Frustum {
 public:
     Frustum() = default;
 
+    static const unsigned int ALL_PLANES = 0x3F;
+
     void Update(const glm::mat4& viewProjectionMatrix);
-    bool IsBoxInFrustum(const glm::vec3& min, const glm::vec3& max);
+    bool IsBoxInFrustum(const glm::vec3& min, const glm::vec3& max) const;
+
+    // Tests a box against the planes set in planeMask, one bit per plane, starting with lastPlane.
+    // Returns -1 if the box is outside, lastPlane is then the plane that rejected it. Otherwise the planes the box is
+    // completely inside are cleared from planeMask, and the result is 1 if none are left and 0 if it straddles some.
+    int ClassifyBox(const glm::vec3& min, const glm::vec3& max, unsigned int& planeMask, int& lastPlane) const;
+
+    // Tests count boxes given as center and extents arrays against the planes in planeMask, eight boxes per
+    // iteration with SSE. Writes 1 to visible for every box that is not outside a plane, 0 otherwise.
+    void CullBoxes(const float* centerX, const float* centerY, const float* centerZ, const float* extentX,
+                   const float* extentY, const float* extentZ, unsigned int count, unsigned char* visible,
+                   unsigned int planeMask = ALL_PLANES) const;
 
-    std::unordered_map<std::string, GameObject*> GetCulledObjects(
-        std::unordered_map<std::string, GameObject*>& gameObjectMap);
+    // Times IsBoxInFrustum, ClassifyBox and CullBoxes on numBoxes random boxes and logs the results.
+    static void Benchmark(const glm::mat4& viewProjectionMatrix, unsigned int numBoxes = 100000);
 
 public:
     glm::mat4 viewProjectionMatrix;
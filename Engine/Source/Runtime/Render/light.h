@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common.h"
+#include "Core/handle.h"
 
 namespace gdp1 {
 
@@ -51,4 +52,8 @@ struct SpotLight {
     void DisableCookie(std::shared_ptr<Shader> shader);
 };
 
+typedef Handle<DirectionalLight> DirectionalLightHandle;
+typedef Handle<PointLight> PointLightHandle;
+typedef Handle<SpotLight> SpotLightHandle;
+
 }  // namespace gdp1
@@ -0,0 +1,157 @@
+#include "light_clusterer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "light.h"
+#include "Core/job_system.h"
+
+namespace gdp1 {
+
+LightClusterer::LightClusterer()
+    : m_Projection(0.0f)
+    , m_Near(0.1f)
+    , m_Far(100.0f)
+    , m_SliceScale(0.0f)
+    , m_SliceBias(0.0f)
+    , m_Boxes(NUM_CLUSTERS)
+    , m_SliceDepths(SLICES_Z + 1)
+    , m_Clusters(NUM_CLUSTERS)
+    , m_SliceIndices(SLICES_Z)
+    , m_SliceCandidates(SLICES_Z) {}
+
+float LightClusterer::GetLightRadius(const PointLight& light, float cutoff) {
+    // solve intensity * color / (c + l * d + q * d^2) = cutoff for d, the attenuation in lit.frag.glsl
+    float brightest = std::max(light.color.r, std::max(light.color.g, light.color.b)) * light.intensity;
+    float c = light.constant - brightest / cutoff;
+    if (c >= 0.0f) return 0.0f;  // never bright enough to matter
+
+    if (light.quadratic > 0.0f) {
+        float l = light.linear;
+        return (-l + sqrtf(l * l - 4.0f * light.quadratic * c)) / (2.0f * light.quadratic);
+    }
+    if (light.linear > 0.0f) return -c / light.linear;
+    return FLT_MAX;
+}
+
+void LightClusterer::Build(const glm::mat4& projection, const std::vector<glm::vec4>& lightSpheres) {
+    if (projection != m_Projection) UpdateBoxes(projection);
+
+    JobSystem::ParallelFor(SLICES_Z, 1, [this, &lightSpheres](unsigned int begin, unsigned int end) {
+        for (unsigned int z = begin; z < end; z++) {
+            BinSlice(z, lightSpheres);
+        }
+    });
+
+    // join the lists of the slices, the cluster offsets were relative to their slice's list
+    m_LightIndices.clear();
+    m_MaxLightsPerCluster = 0;
+    for (int z = 0; z < SLICES_Z; z++) {
+        uint32_t base = static_cast<uint32_t>(m_LightIndices.size());
+        Cluster* cluster = &m_Clusters[z * TILES_X * TILES_Y];
+        for (int i = 0; i < TILES_X * TILES_Y; i++) {
+            cluster[i].offset += base;
+            m_MaxLightsPerCluster = std::max(m_MaxLightsPerCluster, cluster[i].count);
+        }
+        m_LightIndices.insert(m_LightIndices.end(), m_SliceIndices[z].begin(), m_SliceIndices[z].end());
+    }
+}
+
+void LightClusterer::UpdateBoxes(const glm::mat4& projection) {
+    m_Projection = projection;
+
+    // the planes of a glm::perspective matrix
+    m_Near = projection[3][2] / (projection[2][2] - 1.0f);
+    m_Far = projection[3][2] / (projection[2][2] + 1.0f);
+
+    // exponential slices keep the clusters roughly cubic, near ones stay small
+    float logRatio = logf(m_Far / m_Near);
+    m_SliceScale = SLICES_Z / logRatio;
+    m_SliceBias = SLICES_Z * logf(m_Near) / logRatio;
+    for (int z = 0; z <= SLICES_Z; z++) {
+        m_SliceDepths[z] = m_Near * powf(m_Far / m_Near, (float)z / SLICES_Z);
+    }
+
+    // a tile spans [x0, x1] in normalized device coordinates, that is x0 * depth / P[0][0] in view space. The scale
+    // is negative when the projection is flipped to render into a framebuffer, min and max are taken over the corners.
+    glm::vec2 scale(projection[0][0], projection[1][1]);
+    for (int z = 0; z < SLICES_Z; z++) {
+        float d0 = m_SliceDepths[z];
+        float d1 = m_SliceDepths[z + 1];
+        for (int y = 0; y < TILES_Y; y++) {
+            float y0 = -1.0f + 2.0f * y / TILES_Y;
+            float y1 = -1.0f + 2.0f * (y + 1) / TILES_Y;
+            for (int x = 0; x < TILES_X; x++) {
+                float x0 = -1.0f + 2.0f * x / TILES_X;
+                float x1 = -1.0f + 2.0f * (x + 1) / TILES_X;
+
+                Box& box = m_Boxes[(z * TILES_Y + y) * TILES_X + x];
+                glm::vec2 near0 = glm::vec2(x0, y0) * d0 / scale;
+                glm::vec2 near1 = glm::vec2(x1, y1) * d0 / scale;
+                glm::vec2 far0 = glm::vec2(x0, y0) * d1 / scale;
+                glm::vec2 far1 = glm::vec2(x1, y1) * d1 / scale;
+                box.min = glm::vec3(glm::min(glm::min(near0, near1), glm::min(far0, far1)), -d1);
+                box.max = glm::vec3(glm::max(glm::max(near0, near1), glm::max(far0, far1)), -d0);
+            }
+        }
+    }
+}
+
+void LightClusterer::BinSlice(int z, const std::vector<glm::vec4>& lightSpheres) {
+    float d0 = m_SliceDepths[z];
+    float d1 = m_SliceDepths[z + 1];
+    glm::vec2 scale(m_Projection[0][0], m_Projection[1][1]);
+
+    // the lights reaching into the slice and the tiles their spheres can cover there
+    std::vector<Candidate>& candidates = m_SliceCandidates[z];
+    candidates.clear();
+    for (size_t i = 0; i < lightSpheres.size(); i++) {
+        const glm::vec4& sphere = lightSpheres[i];
+        float depth = -sphere.z;
+        float radius = sphere.w;
+        if (depth + radius < d0 || depth - radius > d1) continue;
+
+        // the part of the sphere's bounding box inside the slice projects inside the corners' projections
+        float a = std::max(d0, depth - radius);
+        float b = std::min(d1, depth + radius);
+        glm::vec2 low = (glm::vec2(sphere) - radius) * scale;
+        glm::vec2 high = (glm::vec2(sphere) + radius) * scale;
+        glm::vec2 minNdc = glm::min(glm::min(low / a, low / b), glm::min(high / a, high / b));
+        glm::vec2 maxNdc = glm::max(glm::max(low / a, low / b), glm::max(high / a, high / b));
+        if (maxNdc.x < -1.0f || minNdc.x > 1.0f || maxNdc.y < -1.0f || minNdc.y > 1.0f) continue;
+
+        Candidate candidate;
+        candidate.light = static_cast<uint32_t>(i);
+        candidate.minX = std::max(0, (int)floorf((minNdc.x * 0.5f + 0.5f) * TILES_X));
+        candidate.maxX = std::min(TILES_X - 1, (int)floorf((maxNdc.x * 0.5f + 0.5f) * TILES_X));
+        candidate.minY = std::max(0, (int)floorf((minNdc.y * 0.5f + 0.5f) * TILES_Y));
+        candidate.maxY = std::min(TILES_Y - 1, (int)floorf((maxNdc.y * 0.5f + 0.5f) * TILES_Y));
+        candidates.push_back(candidate);
+    }
+
+    std::vector<uint32_t>& indices = m_SliceIndices[z];
+    indices.clear();
+    for (int y = 0; y < TILES_Y; y++) {
+        for (int x = 0; x < TILES_X; x++) {
+            int index = (z * TILES_Y + y) * TILES_X + x;
+            const Box& box = m_Boxes[index];
+
+            Cluster& cluster = m_Clusters[index];
+            cluster.offset = static_cast<uint32_t>(indices.size());
+            for (const Candidate& candidate : candidates) {
+                if (x < candidate.minX || x > candidate.maxX || y < candidate.minY || y > candidate.maxY) continue;
+
+                // exact sphere against box test, the tile range above is only conservative
+                const glm::vec4& sphere = lightSpheres[candidate.light];
+                glm::vec3 center(sphere);
+                glm::vec3 closest = glm::clamp(center, box.min, box.max);
+                glm::vec3 offset = closest - center;
+                if (glm::dot(offset, offset) <= sphere.w * sphere.w) indices.push_back(candidate.light);
+            }
+            cluster.count = static_cast<uint32_t>(indices.size()) - cluster.offset;
+        }
+    }
+}
+
+}  // namespace gdp1
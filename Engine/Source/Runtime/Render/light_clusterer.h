@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace gdp1 {
+
+struct PointLight;
+
+// Clustered light assignment for forward shading.
+// The view frustum is split into a grid of froxels, TILES_X x TILES_Y screen tiles by SLICES_Z depth slices spaced
+// exponentially, and every point light is binned into the froxels its sphere of influence touches. The lit shader
+// then only shades the lights listed for the froxel of the fragment. The slices are binned in parallel, every slice
+// owns its clusters and its part of the index list. Nothing here touches GL, the binning can run headless through
+// Build and GetCluster.
+class LightClusterer {
+public:
+    static const int TILES_X = 16;
+    static const int TILES_Y = 9;
+    static const int SLICES_Z = 24;
+    static const int NUM_CLUSTERS = TILES_X * TILES_Y * SLICES_Z;
+
+    // the lights of a cluster are lightIndices[offset, offset + count)
+    struct Cluster {
+        uint32_t offset;
+        uint32_t count;
+    };
+
+    // a light is cut off where it adds less than this to a color channel
+    float attenuationCutoff = 1.0f / 256.0f;
+
+    LightClusterer();
+
+    // Distance at which the light falls below cutoff, or FLT_MAX if it never does.
+    static float GetLightRadius(const PointLight& light, float cutoff);
+
+    // Bins the view space spheres (xyz center, w radius) into the froxels of a perspective projection.
+    void Build(const glm::mat4& projection, const std::vector<glm::vec4>& lightSpheres);
+
+    // the cluster of tile x, y (0, 0 is the bottom left) in slice z (0 is at the near plane)
+    const Cluster& GetCluster(int x, int y, int z) const { return m_Clusters[(z * TILES_Y + y) * TILES_X + x]; }
+
+    const std::vector<Cluster>& GetClusters() const { return m_Clusters; }
+    const std::vector<uint32_t>& GetLightIndices() const { return m_LightIndices; }
+
+    // slice = log(viewDepth) * scale - bias, the shader's mapping from depth to slice
+    float GetSliceScale() const { return m_SliceScale; }
+    float GetSliceBias() const { return m_SliceBias; }
+
+    // the clusters a light was binned into, summed over all lights of the last Build
+    unsigned int GetAssignmentCount() const { return static_cast<unsigned int>(m_LightIndices.size()); }
+    unsigned int GetMaxLightsPerCluster() const { return m_MaxLightsPerCluster; }
+
+private:
+    struct Box {
+        glm::vec3 min, max;
+    };
+
+    // a light reaching into a slice and the tiles it may cover there
+    struct Candidate {
+        uint32_t light;
+        int minX, maxX, minY, maxY;
+    };
+
+    // recomputes the view space boxes of the clusters, only when the projection changed
+    void UpdateBoxes(const glm::mat4& projection);
+    void BinSlice(int z, const std::vector<glm::vec4>& lightSpheres);
+
+private:
+    glm::mat4 m_Projection;
+    float m_Near, m_Far;
+    float m_SliceScale, m_SliceBias;
+
+    std::vector<Box> m_Boxes;
+    std::vector<float> m_SliceDepths;  // SLICES_Z + 1 boundaries, positive distances in front of the camera
+
+    std::vector<Cluster> m_Clusters;
+    std::vector<uint32_t> m_LightIndices;
+    // every slice bins into its own list, they are joined into m_LightIndices afterwards
+    std::vector<std::vector<uint32_t>> m_SliceIndices;
+    std::vector<std::vector<Candidate>> m_SliceCandidates;
+
+    unsigned int m_MaxLightsPerCluster = 0;
+};
+
+}  // namespace gdp1
@@ -24,6 +24,16 @@ void Mesh::Setup() {
     // now that we have all the required data, set the vertex buffers and its attribute pointers.
     SetupMesh();
     SetupDebugData();
+    SetupSlotTextures();
+
+    // dynamic meshes rewrite their vertices, they keep drawing from their own buffers only
+    if (!isDynamicBuffer) {
+        geometryRange = GeometryArena::Get().Allocate(vertices, indices);
+        inArena = true;
+    } else {
+        geometryRange.numIndices = static_cast<unsigned int>(indices.size());
+        geometryRange.numVertices = static_cast<unsigned int>(vertices.size());
+    }
 }
 
 void Mesh::DrawTextures(Shader* shader) {
@@ -119,6 +129,27 @@ void Mesh::DrawDebug(Shader* shader) {
     Application::drawCalls++;
 }
 
+void Mesh::SetTextures(const std::vector<TextureInfo*>& textures) {
+    this->textures = textures;
+    SetupSlotTextures();
+}
+
+void Mesh::SetupSlotTextures() {
+    // resolved once here so the render queue never compares texture type names
+    std::fill(slotTextures, slotTextures + NUM_TEXTURE_SLOTS, 0u);
+    for (int i = (int)textures.size() - 1; i >= 0; i--) {
+        const std::string& type = textures[i]->type;
+        if (type == "texture_diffuse")
+            slotTextures[DiffuseSlot] = textures[i]->id;
+        else if (type == "texture_normal")
+            slotTextures[NormalSlot] = textures[i]->id;
+        else if (type == "texture_height")
+            slotTextures[HeightSlot] = textures[i]->id;
+        else if (type == "texture_opacity")
+            slotTextures[OpacitySlot] = textures[i]->id;
+    }
+}
+
 void Mesh::SetupMesh() {
     // create buffers/arrays
     _VAO.Generate();
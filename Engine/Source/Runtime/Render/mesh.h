@@ -4,11 +4,13 @@
 
 #include "Physics/bounds.h"
 #include "shader.h"
+#include "render_queue.h"
 
 #include "assimp/Importer.hpp"
 #include "Buffers/vao.h"
 #include "Buffers/vbo.h"
 #include "Buffers/ebo.h"
+#include "Buffers/geometry_arena.h"
 #include "Resource/texture.h"
 
 #include <Core/cs_runner.h>
@@ -52,11 +54,26 @@ public:
 
     void Setup();
 
+    // replaces the textures and the texture slots the render queue binds
+    void SetTextures(const std::vector<TextureInfo*>& textures);
+
+    // the arena's vertex array for static meshes, the mesh's own for dynamic ones
+    unsigned int GetVertexArray() const { return inArena ? GeometryArena::Get().GetVertexArray() : _VAO.ID; }
+    // the mesh's own vertex array, also tells meshes apart
+    unsigned int GetLocalVertexArray() const { return _VAO.ID; }
+    // where the mesh's geometry is in GetVertexArray
+    const GeometryRange& GetGeometryRange() const { return geometryRange; }
+    unsigned int GetIndexCount() const { return static_cast<unsigned int>(indices.size()); }
+    unsigned int GetInstanceCount() const { return numInstances; }
+    // the first texture of each kind by TextureSlot, 0 where there is none
+    const unsigned int* GetSlotTextures() const { return slotTextures; }
+
 private:
     // initializes all the buffer objects/arrays
     void SetupMesh();
 
     void SetupDebugData();
+    void SetupSlotTextures();
 
 private:
     // render data
@@ -70,6 +87,12 @@ private:
     std::vector<unsigned int> boundsIndices;
 
     unsigned int numInstances = 1;
+
+    unsigned int slotTextures[NUM_TEXTURE_SLOTS] = {0};
+
+    // a copy of the geometry in the GeometryArena, for the render queue
+    GeometryRange geometryRange;
+    bool inArena = false;
 };
 
 }  // namespace gdp1
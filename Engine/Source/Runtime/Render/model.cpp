@@ -1,7 +1,11 @@
 #include "model.h"
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 #include <iostream>
 
+#include "Resource/mesh_simplifier.h"
 #include "Resource/texture.h"
 
 namespace gdp1 {
@@ -13,7 +17,6 @@ Model::Model(const std::string const& path, const std::string& shader, const std
     , shaderName(shader)
     , num_vertices_(0)
     , num_triangles_(0)
-    , currentAnimation(nullptr)
     , texturesToLoad(textures)
     , instanceMatrix(instanceMatrix)
     , instancing(instancing) {
@@ -25,27 +28,27 @@ Model::Model(const Model& other)
     : CSRunner()
     , textures_loaded(other.textures_loaded)
     , meshes(other.meshes)
+    , lodLevels(other.lodLevels)
     , directory(other.directory)
     , gammaCorrection(other.gammaCorrection)
     , shaderName(other.shaderName)
+    , shaderHandle(other.shaderHandle)
     , bounds(other.bounds)
     , m_global_inverse_transform(other.m_global_inverse_transform)
-    , character_animations(other.character_animations)
-    , currentAnimation(other.currentAnimation)
-    , prevAnimation(other.prevAnimation)
+    , skeleton(other.skeleton)
+    , animations(other.animations)
+    , animationIndices(other.animationIndices)
+    , blendTrees(other.blendTrees)
     , num_vertices_(other.num_vertices_)
     , num_triangles_(other.num_triangles_)
     , m_bone_mapping(other.m_bone_mapping)
     , m_num_bones(other.m_num_bones)
     , m_bone_matrices(other.m_bone_matrices)
-    , elapsedTime(other.elapsedTime)
     , texturesToLoad(other.texturesToLoad)
     , scene(other.scene) {}
 
 void Model::Draw(Shader* shader) {
-    if (currentLODLevel < lodLevels.size()) lodLevels[currentLODLevel].mesh->Draw(shader);
-
-    // for (unsigned int i = 0; i < meshes.size(); i++) meshes[i].Draw(shader);
+    for (unsigned int i = 0; i < meshes.size(); i++) meshes[i]->Draw(shader);
 }
 
 void Model::DrawDebug(Shader* shader) {
@@ -65,42 +68,23 @@ unsigned int Model::GetVertexCount() const { return num_vertices_; }
 unsigned int Model::GetTriangleCount() const { return num_triangles_; }
 
 void Model::AddCharacterAnimation(std::string animationName, std::string animationPath) {
-    CharacterAnimation* animation = new CharacterAnimation(animationPath, animationName, this);
-    character_animations[animationName] = animation;
-}
+    if (animationIndices.find(animationName) != animationIndices.end()) return;
 
-uint32_t Model::GetAnimationIndex(CharacterAnimation* animation) {
-    uint32_t index = 0;
-    for (const auto& pair : character_animations) {
-        if (pair.second == animation) {
-            return index;
-        }
-        ++index;
-    }
+    CharacterAnimation* animation = new CharacterAnimation(animationPath, animationName, this);
+    animation->bindSkeleton(skeleton);
 
-    return -1;
+    animationIndices[animationName] = (unsigned int)animations.size();
+    animations.push_back(animation);
 }
 
-void Model::UpdateAnimation(float deltaTime) {
-    blendFactor += 0.001f;
-    elapsedTime += deltaTime;
-
-    if (blendFactor > 1.0f) {
-        blendFactor = 1.0f;
-        prevAnimation = currentAnimation;
-    }
+int Model::FindAnimation(const std::string& name) const {
+    std::map<std::string, unsigned int>::const_iterator it = animationIndices.find(name);
+    return it != animationIndices.end() ? (int)it->second : -1;
 }
 
-void Model::SetCurrentAnimation(std::string name) {
-    auto it = character_animations.find(name);
-    if (it != character_animations.end()) {
-        if (currentAnimation == nullptr) prevAnimation = it->second;
-        currentAnimation = it->second;
-        blendFactor = 0.0f;
-        elapsedTime = 0.0f;
-    } else {
-        currentAnimation = nullptr;
-    }
+const BlendTree* Model::FindBlendTree(const std::string& name) const {
+    std::map<std::string, BlendTree*>::const_iterator it = blendTrees.find(name);
+    return it != blendTrees.end() ? it->second : nullptr;
 }
 
 void Model::LoadModel(std::string const& path) {
@@ -123,6 +107,10 @@ void Model::LoadModel(std::string const& path) {
 
     // process ASSIMP's root node recursively
     ProcessNode(scene->mRootNode, scene);
+    lodLevels.push_back(LODLevel(0, meshes, 0.0f));
+
+    // the bones are known now, flatten the hierarchy for pose evaluation
+    skeleton.Build(scene->mRootNode, m_bone_mapping, m_bone_matrices, m_global_inverse_transform);
 
     LOG_INFO("Loaded model {0} with {1} meshes", path, meshes.size());
 }
@@ -134,11 +122,8 @@ void Model::ProcessNode(aiNode* node, const aiScene* scene) {
         // the scene_ptr_ contains all the data, node is just to keep stuff organized (like relations between nodes).
         aiMesh* aiMesh = scene->mMeshes[node->mMeshes[i]];
         Mesh* mesh = ProcessMesh(aiMesh, scene);
-        mesh->Setup();
         meshes.push_back(mesh);
 
-        lodLevels.push_back(LODLevel(i + 1, mesh));
-
         num_vertices_ += aiMesh->mNumVertices;
         num_triangles_ += aiMesh->mNumFaces;
     }
@@ -254,6 +239,66 @@ void Model::SetupMeshes() {
     for (Mesh* mesh : meshes) {
         mesh->Setup();
     }
+    for (Mesh* mesh : m_GeneratedMeshes) {
+        mesh->Setup();
+    }
+}
+
+void Model::GenerateLODs(unsigned int numLevels, float reduction) {
+    if (lodLevels.empty()) return;
+
+    for (unsigned int level = 1; level < numLevels; level++) {
+        const LODLevel& previous = lodLevels.back();
+        float ratio = powf(reduction, (float)level);
+
+        std::vector<Mesh*> levelMeshes;
+        std::vector<Mesh*> newMeshes;
+        float levelError = previous.error;
+        size_t previousIndexCount = 0;
+        size_t levelIndexCount = 0;
+        for (size_t i = 0; i < meshes.size(); i++) {
+            const Mesh* source = meshes[i];
+            Mesh* coarser = previous.meshes[i];
+            previousIndexCount += coarser->indices.size();
+
+            // always simplified from the full detail mesh, the errors of the levels do not add up
+            std::vector<unsigned int> indices;
+            float error = 0.0f;
+            if (!source->vertices.empty()) {
+                unsigned int target = (unsigned int)(source->indices.size() * ratio) / 3 * 3;
+                indices = MeshSimplifier::Simplify(&source->vertices[0].position, sizeof(Vertex),
+                                                   (unsigned int)source->vertices.size(), source->indices, target,
+                                                   FLT_MAX, &error);
+            }
+
+            // meshes that hardly simplify any further, or would vanish, keep their previous level
+            if (indices.empty() || indices.size() > coarser->indices.size() * 9 / 10) {
+                levelMeshes.push_back(coarser);
+                levelIndexCount += coarser->indices.size();
+                continue;
+            }
+
+            std::vector<unsigned int> remap;
+            MeshSimplifier::CompactVertices(indices, (unsigned int)source->vertices.size(), remap);
+            std::vector<Vertex> vertices(remap.size());
+            for (size_t v = 0; v < remap.size(); v++) vertices[v] = source->vertices[remap[v]];
+
+            Mesh* mesh = new Mesh(vertices, indices, source->textures, source->bounds, source->isDynamicBuffer);
+            newMeshes.push_back(mesh);
+            levelMeshes.push_back(mesh);
+            levelIndexCount += indices.size();
+            levelError = std::max(levelError, error);
+        }
+
+        // a level that is hardly cheaper than the one before is not worth switching to
+        if (newMeshes.empty() || levelIndexCount > previousIndexCount * 9 / 10) {
+            for (Mesh* mesh : newMeshes) delete mesh;
+            break;
+        }
+
+        m_GeneratedMeshes.insert(m_GeneratedMeshes.end(), newMeshes.begin(), newMeshes.end());
+        lodLevels.push_back(LODLevel(level, levelMeshes, levelError));
+    }
 }
 
 void Model::LoadTextures() {
@@ -294,7 +339,16 @@ void Model::LoadTextures() {
             if (texture != nullptr) textures.push_back(texture);
         }
 
-        meshData->textures = textures;
+        // the meshes are set up before their textures are loaded
+        meshData->SetTextures(textures);
+    }
+
+    // the simplified meshes use the textures of the mesh they came from
+    for (size_t level = 1; level < lodLevels.size(); level++) {
+        std::vector<Mesh*>& levelMeshes = lodLevels[level].meshes;
+        for (size_t i = 0; i < levelMeshes.size() && i < meshes.size(); i++) {
+            if (levelMeshes[i] != meshes[i]) levelMeshes[i]->SetTextures(meshes[i]->textures);
+        }
     }
 }
 
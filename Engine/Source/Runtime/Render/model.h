@@ -3,6 +3,7 @@
 #include "mesh.h"
 #include "shader.h"
 #include "Animation/character_animation.h"
+#include "Animation/skeleton.h"
 #include "Resource/level_object_description.h"
 #include "Resource/lod_level.h"
 #include "Resource/texture.h"
@@ -21,13 +22,12 @@
 namespace gdp1 {
 
 class CharacterAnimation;
+class BlendTree;
 
 class Model : public CSRunner {
 public:
     static const unsigned int MAX_BONES = 100;
 
-    int currentLODLevel = 0;
-
     // model data
     std::vector<TextureInfo*> textures_loaded;  // stores all the textures loaded so far, optimization to make sure textures
 
@@ -39,18 +39,22 @@ public:
     unsigned int instancing;
     std::vector<glm::mat4> instanceMatrix;
 
+    // level 0 is the loaded meshes, every further level is coarser. Game objects pick theirs in GameObject::lodLevel.
     std::vector<LODLevel> lodLevels;
 
     std::string shaderName;
+    ShaderHandle shaderHandle;  // shaderName resolved by the scene once its shaders are loaded
 
     Bounds bounds;
 
     aiMatrix4x4 m_global_inverse_transform;
 
-    std::map<std::string, CharacterAnimation*> character_animations;
+    Skeleton skeleton;
 
-    CharacterAnimation* currentAnimation;
-    CharacterAnimation* prevAnimation;
+    // immutable after loading, the playback state lives in each game object's AnimatorInstance
+    std::vector<CharacterAnimation*> animations;
+    std::map<std::string, unsigned int> animationIndices;
+    std::map<std::string, BlendTree*> blendTrees;
 
 public:
 
@@ -83,18 +87,21 @@ public:
 
     unsigned int GetNumBones();
 
-    void SetCurrentAnimation(std::string name);
-
     void AddCharacterAnimation(std::string animationName, std::string animationPath);
 
-    uint32_t GetAnimationIndex(CharacterAnimation* animation);
-
-    void UpdateAnimation(float deltaTime);
+    // Returns -1 if the model has no animation with that name.
+    int FindAnimation(const std::string& name) const;
 
-    void UpdateBoneMatrices(const std::vector<aiMatrix4x4>& transforms);
+    // Returns nullptr if the model has no blend tree with that name.
+    const BlendTree* FindBlendTree(const std::string& name) const;
 
     void SetupMeshes();
 
+    // Appends up to numLevels - 1 simplified levels, each with reduction times the triangles of the one before.
+    // Stops early once a level hardly gets any cheaper. Only touches CPU data, the loader threads run it before
+    // SetupMeshes.
+    void GenerateLODs(unsigned int numLevels, float reduction);
+
 private:
     // loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
     void LoadModel(std::string const& path);
@@ -119,15 +126,15 @@ private:
     unsigned int m_num_bones = 0;
     std::vector<BoneMatrix> m_bone_matrices;
 
-    double elapsedTime = 0.0f;
-    float blendFactor = 0.0f;
-
     std::vector<TexturesDesc> texturesToLoad;
 
     std::map<aiMesh*, Mesh*> m_MeshMap;
+    std::vector<Mesh*> m_GeneratedMeshes;  // the meshes of lodLevels past level 0
 
     Assimp::Importer importer;
     const aiScene* scene;
 };
 
+typedef Handle<Model> ModelHandle;
+
 }  // namespace gdp1
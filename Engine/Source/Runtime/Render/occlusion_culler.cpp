@@ -0,0 +1,249 @@
+#include "occlusion_culler.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include <xmmintrin.h>
+
+#include "model.h"
+#include "Core/game_object.h"
+#include "Core/job_system.h"
+
+namespace gdp1 {
+
+OcclusionCuller::OcclusionCuller()
+    : m_ViewProjection(1.0f)
+    , m_Depth(WIDTH * HEIGHT, 1.0f) {}
+
+void OcclusionCuller::Begin(const glm::mat4& viewProjection) {
+    m_ViewProjection = viewProjection;
+    std::fill(m_Depth.begin(), m_Depth.end(), 1.0f);
+    m_Triangles.clear();
+    m_NumOccluders = 0;
+}
+
+void OcclusionCuller::AddOccluder(const glm::mat4& world, const glm::vec3* positions, size_t stride,
+                                  unsigned int numVertices, const unsigned int* indices, unsigned int numIndices) {
+    glm::mat4 worldViewProjection = m_ViewProjection * world;
+
+    m_ClipVertices.resize(numVertices);
+    const char* position = reinterpret_cast<const char*>(positions);
+    for (unsigned int i = 0; i < numVertices; i++) {
+        m_ClipVertices[i] = worldViewProjection * glm::vec4(*reinterpret_cast<const glm::vec3*>(position), 1.0f);
+        position += stride;
+    }
+
+    // a mirroring transform turns the winding around
+    glm::mat3 basis(world);
+    bool mirrored = glm::determinant(basis) < 0.0f;
+
+    for (unsigned int i = 0; i + 2 < numIndices; i += 3) {
+        const glm::vec4& c0 = m_ClipVertices[indices[i]];
+        const glm::vec4& c1 = m_ClipVertices[mirrored ? indices[i + 2] : indices[i + 1]];
+        const glm::vec4& c2 = m_ClipVertices[mirrored ? indices[i + 1] : indices[i + 2]];
+
+        // triangles crossing the near plane are left out, drawing less of an occluder is always safe
+        if (c0.z < -c0.w || c1.z < -c1.w || c2.z < -c2.w) continue;
+
+        Triangle triangle;
+        glm::vec3* screen[3] = {&triangle.v0, &triangle.v1, &triangle.v2};
+        const glm::vec4* clip[3] = {&c0, &c1, &c2};
+        for (int v = 0; v < 3; v++) {
+            float invW = 1.0f / clip[v]->w;
+            screen[v]->x = (clip[v]->x * invW * 0.5f + 0.5f) * WIDTH;
+            screen[v]->y = (clip[v]->y * invW * 0.5f + 0.5f) * HEIGHT;
+            screen[v]->z = clip[v]->z * invW;
+        }
+
+        // counter-clockwise triangles face the camera
+        float area = (triangle.v1.x - triangle.v0.x) * (triangle.v2.y - triangle.v0.y) -
+                     (triangle.v1.y - triangle.v0.y) * (triangle.v2.x - triangle.v0.x);
+        if (area <= 0.0f) continue;
+
+        float minX = std::min(triangle.v0.x, std::min(triangle.v1.x, triangle.v2.x));
+        float maxX = std::max(triangle.v0.x, std::max(triangle.v1.x, triangle.v2.x));
+        float minY = std::min(triangle.v0.y, std::min(triangle.v1.y, triangle.v2.y));
+        float maxY = std::max(triangle.v0.y, std::max(triangle.v1.y, triangle.v2.y));
+        if (maxX < 0.0f || minX >= WIDTH || maxY < 0.0f || minY >= HEIGHT) continue;
+
+        triangle.minY = std::max(0, (int)floorf(minY));
+        triangle.maxY = std::min(HEIGHT - 1, (int)ceilf(maxY));
+        m_Triangles.push_back(triangle);
+    }
+
+    m_NumOccluders++;
+}
+
+void OcclusionCuller::Rasterize() {
+    const int numBands = (HEIGHT + BAND_HEIGHT - 1) / BAND_HEIGHT;
+    JobSystem::ParallelFor(numBands, 1, [this](unsigned int begin, unsigned int end) {
+        for (unsigned int band = begin; band < end; band++) {
+            RasterizeBand(band);
+        }
+    });
+}
+
+void OcclusionCuller::RasterizeBand(int band) {
+    int bandMinY = band * BAND_HEIGHT;
+    int bandMaxY = std::min(HEIGHT, bandMinY + BAND_HEIGHT) - 1;
+
+    for (const Triangle& triangle : m_Triangles) {
+        if (triangle.maxY < bandMinY || triangle.minY > bandMaxY) continue;
+
+        RasterizeTriangle(triangle, bandMinY, bandMaxY);
+    }
+}
+
+void OcclusionCuller::RasterizeTriangle(const Triangle& triangle, int bandMinY, int bandMaxY) {
+    const glm::vec3& v0 = triangle.v0;
+    const glm::vec3& v1 = triangle.v1;
+    const glm::vec3& v2 = triangle.v2;
+
+    int minX = std::max(0, (int)floorf(std::min(v0.x, std::min(v1.x, v2.x))));
+    int maxX = std::min(WIDTH - 1, (int)ceilf(std::max(v0.x, std::max(v1.x, v2.x))));
+    int minY = std::max(bandMinY, triangle.minY);
+    int maxY = std::min(bandMaxY, triangle.maxY);
+
+    float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+    float invArea = 1.0f / area;
+
+    // edge functions, each is positive on the inner side of the edge opposite its vertex
+    float a0 = v1.y - v2.y, b0 = v2.x - v1.x;
+    float a1 = v2.y - v0.y, b1 = v0.x - v2.x;
+    float a2 = v0.y - v1.y, b2 = v1.x - v0.x;
+
+    float px = minX + 0.5f;
+    for (int y = minY; y <= maxY; y++) {
+        float py = y + 0.5f;
+        float w0 = a0 * (px - v1.x) + b0 * (py - v1.y);
+        float w1 = a1 * (px - v2.x) + b1 * (py - v2.y);
+        float w2 = a2 * (px - v0.x) + b2 * (py - v0.y);
+
+        float* row = &m_Depth[y * WIDTH];
+        for (int x = minX; x <= maxX; x++) {
+            if (w0 >= 0.0f && w1 >= 0.0f && w2 >= 0.0f) {
+                float depth = (w0 * v0.z + w1 * v1.z + w2 * v2.z) * invArea;
+                if (depth < row[x]) row[x] = depth;
+            }
+
+            w0 += a0;
+            w1 += a1;
+            w2 += a2;
+        }
+    }
+}
+
+bool OcclusionCuller::IsVisible(const glm::vec3& min, const glm::vec3& max) const {
+    // the box's footprint on screen and its nearest depth
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    float nearest = FLT_MAX;
+    for (int corner = 0; corner < 8; corner++) {
+        glm::vec4 position((corner & 1) ? max.x : min.x, (corner & 2) ? max.y : min.y, (corner & 4) ? max.z : min.z,
+                           1.0f);
+        glm::vec4 clip = m_ViewProjection * position;
+
+        // reaching through the near plane, the box is right in front of the camera
+        if (clip.z < -clip.w) return true;
+
+        float invW = 1.0f / clip.w;
+        float x = (clip.x * invW * 0.5f + 0.5f) * WIDTH;
+        float y = (clip.y * invW * 0.5f + 0.5f) * HEIGHT;
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        nearest = std::min(nearest, clip.z * invW);
+    }
+
+    int x0 = std::max(0, (int)floorf(minX));
+    int x1 = std::min(WIDTH - 1, (int)floorf(maxX));
+    int y0 = std::max(0, (int)floorf(minY));
+    int y1 = std::min(HEIGHT - 1, (int)floorf(maxY));
+    if (x0 > x1 || y0 > y1) return true;
+
+    // visible as soon as one pixel of the footprint is farther away than the box's nearest point
+    __m128 boxDepth = _mm_set1_ps(nearest);
+    for (int y = y0; y <= y1; y++) {
+        const float* row = &m_Depth[y * WIDTH];
+
+        int x = x0;
+        for (; x + 4 <= x1 + 1; x += 4) {
+            if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), boxDepth)) != 0) return true;
+        }
+        for (; x <= x1; x++) {
+            if (row[x] >= nearest) return true;
+        }
+    }
+
+    return false;
+}
+
+void OcclusionCuller::RenderOccluders(const glm::mat4& viewProjection, const glm::vec3& eye,
+                                      const std::vector<GameObject*>& candidates) {
+    Begin(viewProjection);
+
+    // rank the occluders by their rough size on screen, radius over distance
+    m_Candidates.clear();
+    for (GameObject* go : candidates) {
+        if (!go->isOccluder || go->model == nullptr || go->model->meshes.empty()) continue;
+
+        Bounds bounds = go->model->bounds;
+        bounds.TransformBounds(go->transform->WorldMatrix());
+        float radius = glm::length(bounds.GetExtents());
+        float distance = std::max(glm::length(bounds.GetCenter() - eye), radius);
+        m_Candidates.push_back(std::make_pair(radius / distance, go));
+    }
+
+    size_t numOccluders = std::min(m_Candidates.size(), (size_t)maxOccluders);
+    std::partial_sort(m_Candidates.begin(), m_Candidates.begin() + numOccluders, m_Candidates.end(),
+                      [](const std::pair<float, GameObject*>& a, const std::pair<float, GameObject*>& b) {
+                          return a.first > b.first;
+                      });
+
+    for (size_t i = 0; i < numOccluders; i++) {
+        GameObject* go = m_Candidates[i].second;
+        Model* model = go->model;
+
+        // the coarsest level of detail is enough for depth
+        const std::vector<Mesh*>& meshes = model->lodLevels.empty() ? model->meshes : model->lodLevels.back().meshes;
+        size_t numTriangles = 0;
+        for (const Mesh* mesh : meshes) numTriangles += mesh->indices.size() / 3;
+        if (numTriangles > maxOccluderTriangles) continue;
+
+        for (const Mesh* mesh : meshes) {
+            if (mesh->vertices.empty() || mesh->indices.empty()) continue;
+            AddOccluder(go->transform->WorldMatrix(), &mesh->vertices[0].position, sizeof(Vertex),
+                        (unsigned int)mesh->vertices.size(), &mesh->indices[0], (unsigned int)mesh->indices.size());
+        }
+    }
+
+    if (!m_Triangles.empty()) Rasterize();
+}
+
+void OcclusionCuller::CullObjects(std::vector<GameObject*>& objects) {
+    m_NumCulled = 0;
+    if (m_Triangles.empty()) return;
+
+    // occluders stay in the list, their own surface is never in front of their box
+    size_t kept = 0;
+    for (size_t i = 0; i < objects.size(); i++) {
+        GameObject* go = objects[i];
+
+        bool visible = true;
+        if (go->model != nullptr) {
+            Bounds bounds = go->model->bounds;
+            bounds.TransformBounds(go->transform->WorldMatrix());
+            visible = IsVisible(bounds.GetMin(), bounds.GetMax());
+        }
+
+        if (visible) {
+            objects[kept++] = go;
+        } else {
+            m_NumCulled++;
+        }
+    }
+    objects.resize(kept);
+}
+
+}  // namespace gdp1
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace gdp1 {
+
+class GameObject;
+
+// Occlusion culling against a small depth buffer rasterized on the CPU.
+// Each frame the largest occluders on screen (game objects marked isOccluder) are drawn into the buffer, then the
+// bounding boxes of the other objects are tested against it and the ones completely behind it are dropped. The buffer
+// is rasterized in horizontal bands in parallel, every band owns its rows so the jobs never write the same pixel.
+// Nothing here touches GL, the culler can run headless on synthetic occluders through Begin, AddOccluder,
+// Rasterize and IsVisible.
+class OcclusionCuller {
+public:
+    static const int WIDTH = 320;
+    static const int HEIGHT = 192;
+    static const int BAND_HEIGHT = 16;
+
+    unsigned int maxOccluders = 32;
+    // occluders with more triangles cost more to draw than they usually save
+    unsigned int maxOccluderTriangles = 4096;
+
+    OcclusionCuller();
+
+    // Clears the depth buffer and the occluders for a frame seen through viewProjection.
+    void Begin(const glm::mat4& viewProjection);
+
+    // Adds a triangle mesh, positions in model space stride bytes apart.
+    void AddOccluder(const glm::mat4& world, const glm::vec3* positions, size_t stride, unsigned int numVertices,
+                     const unsigned int* indices, unsigned int numIndices);
+
+    // Draws the added occluders into the depth buffer.
+    void Rasterize();
+
+    // False if the world space box is completely behind the rasterized occluders.
+    bool IsVisible(const glm::vec3& min, const glm::vec3& max) const;
+
+    // Begins a frame and rasterizes the largest occluders among candidates.
+    void RenderOccluders(const glm::mat4& viewProjection, const glm::vec3& eye,
+                         const std::vector<GameObject*>& candidates);
+    // Removes the objects hidden behind the rendered occluders.
+    void CullObjects(std::vector<GameObject*>& objects);
+
+    unsigned int GetOccluderCount() const { return m_NumOccluders; }
+    unsigned int GetTriangleCount() const { return static_cast<unsigned int>(m_Triangles.size()); }
+    // objects removed by the last CullObjects
+    unsigned int GetCulledCount() const { return m_NumCulled; }
+
+    // WIDTH x HEIGHT normalized device depths, bottom row first, 1 where nothing was drawn
+    const float* GetDepthBuffer() const { return &m_Depth[0]; }
+
+private:
+    struct Triangle {
+        glm::vec3 v0, v1, v2;  // pixel x, pixel y, depth
+        int minY, maxY;
+    };
+
+    void RasterizeBand(int band);
+    void RasterizeTriangle(const Triangle& triangle, int bandMinY, int bandMaxY);
+
+private:
+    glm::mat4 m_ViewProjection;
+
+    std::vector<float> m_Depth;
+    std::vector<glm::vec4> m_ClipVertices;
+    std::vector<Triangle> m_Triangles;
+
+    // occluder candidates by screen size, reused every frame
+    std::vector<std::pair<float, GameObject*>> m_Candidates;
+
+    unsigned int m_NumOccluders = 0;
+    unsigned int m_NumCulled = 0;
+};
+
+}  // namespace gdp1
@@ -0,0 +1,122 @@
+#include "render_backend.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "shader.h"
+#include "Buffers/ring_buffer.h"
+#include "Core/application.h"
+
+namespace gdp1 {
+
+void GLRenderBackend::UseProgram(Shader* shader) { shader->Use(); }
+
+void GLRenderBackend::BindTexture(unsigned int unit, unsigned int texture) {
+    if (unit != m_ActiveUnit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        m_ActiveUnit = unit;
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void GLRenderBackend::BindVertexArray(unsigned int vertexArray) { glBindVertexArray(vertexArray); }
+
+void GLRenderBackend::SetUniform(Shader* shader, const char* name, const glm::mat4& value) {
+    shader->SetUniform(name, value);
+}
+
+void GLRenderBackend::SetUniform(Shader* shader, const char* name, int value) { shader->SetUniform(name, value); }
+
+void GLRenderBackend::DrawElements(const DrawElementsIndirectCommand& command) {
+    glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, command.count, GL_UNSIGNED_INT,
+                                                  (void*)((size_t)command.firstIndex * sizeof(unsigned int)),
+                                                  command.instanceCount, command.baseVertex, command.baseInstance);
+    Application::drawCalls++;
+}
+
+void GLRenderBackend::SetIndirectCommands(const DrawElementsIndirectCommand* commands, unsigned int count) {
+    if (count == 0) return;
+
+    GLsizeiptr size = (GLsizeiptr)count * sizeof(DrawElementsIndirectCommand);
+    if (m_IndirectBuffer == nullptr) m_IndirectBuffer = new RingBuffer();
+    if (!m_IndirectBuffer->IsCreated() || m_IndirectBuffer->GetRegionSize() < size) {
+        m_IndirectBuffer->Create(GL_DRAW_INDIRECT_BUFFER, size * 2);
+    }
+
+    void* mapped = m_IndirectBuffer->BeginRegion();
+    std::copy(commands, commands + count, (DrawElementsIndirectCommand*)mapped);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBuffer->ID);
+}
+
+void GLRenderBackend::MultiDrawElementsIndirect(unsigned int first, unsigned int count) {
+    GLintptr offset = m_IndirectBuffer->GetRegionOffset() + (GLintptr)first * sizeof(DrawElementsIndirectCommand);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)offset, count, 0);
+    Application::drawCalls++;
+}
+
+void GLRenderBackend::Finish() {
+    // the GPU may not touch this frame's commands again until the fence has passed
+    if (m_IndirectBuffer != nullptr && m_IndirectBuffer->IsCreated()) {
+        m_IndirectBuffer->EndRegion();
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    glBindVertexArray(0);
+    glActiveTexture(GL_TEXTURE0);
+    m_ActiveUnit = 0;
+}
+
+void RecordingRenderBackend::UseProgram(Shader* shader) { Record(UseProgramCommand, shader, 0, 0); }
+
+void RecordingRenderBackend::BindTexture(unsigned int unit, unsigned int texture) {
+    Record(BindTextureCommand, nullptr, unit, texture);
+}
+
+void RecordingRenderBackend::BindVertexArray(unsigned int vertexArray) {
+    Record(BindVertexArrayCommand, nullptr, vertexArray, 0);
+}
+
+void RecordingRenderBackend::SetUniform(Shader* shader, const char* name, const glm::mat4& value) {
+    Record(SetUniformCommand, shader, 0, 0, name);
+}
+
+void RecordingRenderBackend::SetUniform(Shader* shader, const char* name, int value) {
+    Record(SetUniformCommand, shader, 0, (unsigned int)value, name);
+}
+
+void RecordingRenderBackend::DrawElements(const DrawElementsIndirectCommand& command) {
+    Record(DrawCommand, nullptr, command.count, command.instanceCount);
+}
+
+void RecordingRenderBackend::SetIndirectCommands(const DrawElementsIndirectCommand* commands, unsigned int count) {
+    m_IndirectCommands.assign(commands, commands + count);
+}
+
+void RecordingRenderBackend::MultiDrawElementsIndirect(unsigned int first, unsigned int count) {
+    Record(MultiDrawCommand, nullptr, first, count);
+}
+
+unsigned int RecordingRenderBackend::GetCount(CommandType type) const {
+    unsigned int count = 0;
+    for (const Command& command : m_Commands) {
+        if (command.type == type) count++;
+    }
+    return count;
+}
+
+unsigned int RecordingRenderBackend::GetUniformCount(const char* name) const {
+    unsigned int count = 0;
+    for (const Command& command : m_Commands) {
+        if (command.type == SetUniformCommand && std::strcmp(command.name, name) == 0) count++;
+    }
+    return count;
+}
+
+void RecordingRenderBackend::Record(CommandType type, Shader* shader, unsigned int first, unsigned int second,
+                                    const char* name) {
+    Command command = {type, shader, first, second, name};
+    m_Commands.push_back(command);
+}
+
+}  // namespace gdp1
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace gdp1 {
+
+class Shader;
+class RingBuffer;
+
+// One draw of glMultiDrawElementsIndirect, laid out as GL reads it from the indirect buffer.
+struct DrawElementsIndirectCommand {
+    unsigned int count;          // indices
+    unsigned int instanceCount;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int baseInstance;  // gl_BaseInstance in the shaders
+};
+
+// The few GL calls the render queue issues. The queue only calls it when the state really changes, so a backend
+// sees exactly the work a frame costs.
+class RenderBackend {
+public:
+    virtual ~RenderBackend() {}
+
+    virtual void UseProgram(Shader* shader) = 0;
+    virtual void BindTexture(unsigned int unit, unsigned int texture) = 0;
+    virtual void BindVertexArray(unsigned int vertexArray) = 0;
+
+    virtual void SetUniform(Shader* shader, const char* name, const glm::mat4& value) = 0;
+    virtual void SetUniform(Shader* shader, const char* name, int value) = 0;
+
+    virtual void DrawElements(const DrawElementsIndirectCommand& command) = 0;
+
+    // Makes the frame's indirect commands available to MultiDrawElementsIndirect, before the first draw.
+    virtual void SetIndirectCommands(const DrawElementsIndirectCommand* commands, unsigned int count) = 0;
+    // Issues count commands starting at first of the ones set for the frame with a single call.
+    virtual void MultiDrawElementsIndirect(unsigned int first, unsigned int count) = 0;
+
+    // Leaves GL in its default state for the code drawing after the queue.
+    virtual void Finish() {}
+};
+
+// Issues the calls to GL.
+class GLRenderBackend : public RenderBackend {
+public:
+    void UseProgram(Shader* shader) override;
+    void BindTexture(unsigned int unit, unsigned int texture) override;
+    void BindVertexArray(unsigned int vertexArray) override;
+
+    void SetUniform(Shader* shader, const char* name, const glm::mat4& value) override;
+    void SetUniform(Shader* shader, const char* name, int value) override;
+
+    void DrawElements(const DrawElementsIndirectCommand& command) override;
+
+    void SetIndirectCommands(const DrawElementsIndirectCommand* commands, unsigned int count) override;
+    void MultiDrawElementsIndirect(unsigned int first, unsigned int count) override;
+
+    void Finish() override;
+
+private:
+    unsigned int m_ActiveUnit = 0;
+    // the commands of the frames in flight, persistently mapped
+    RingBuffer* m_IndirectBuffer = nullptr;
+};
+
+// Records the calls instead of issuing them, for checking what a frame submits without a GL context.
+class RecordingRenderBackend : public RenderBackend {
+public:
+    enum CommandType {
+        UseProgramCommand,
+        BindTextureCommand,
+        BindVertexArrayCommand,
+        SetUniformCommand,
+        DrawCommand,
+        MultiDrawCommand
+    };
+
+    struct Command {
+        CommandType type;
+        Shader* shader;
+        unsigned int first;   // texture unit, vertex array, number of indices or first indirect command
+        unsigned int second;  // texture, number of instances or number of indirect commands
+        const char* name;     // the uniform of a SetUniformCommand, nullptr for the others
+    };
+
+    void UseProgram(Shader* shader) override;
+    void BindTexture(unsigned int unit, unsigned int texture) override;
+    void BindVertexArray(unsigned int vertexArray) override;
+
+    void SetUniform(Shader* shader, const char* name, const glm::mat4& value) override;
+    void SetUniform(Shader* shader, const char* name, int value) override;
+
+    void DrawElements(const DrawElementsIndirectCommand& command) override;
+
+    void SetIndirectCommands(const DrawElementsIndirectCommand* commands, unsigned int count) override;
+    void MultiDrawElementsIndirect(unsigned int first, unsigned int count) override;
+
+    void Clear() {
+        m_Commands.clear();
+        m_IndirectCommands.clear();
+    }
+    const std::vector<Command>& GetCommands() const { return m_Commands; }
+    const std::vector<DrawElementsIndirectCommand>& GetIndirectCommands() const { return m_IndirectCommands; }
+    unsigned int GetCount(CommandType type) const;
+    // how often the uniform called name was set
+    unsigned int GetUniformCount(const char* name) const;
+
+private:
+    void Record(CommandType type, Shader* shader, unsigned int first, unsigned int second,
+                const char* name = nullptr);
+
+private:
+    std::vector<Command> m_Commands;
+    std::vector<DrawElementsIndirectCommand> m_IndirectCommands;
+};
+
+}  // namespace gdp1
@@ -0,0 +1,261 @@
+#include "render_queue.h"
+
+#include <climits>
+#include <cstring>
+
+#include "render_backend.h"
+
+namespace gdp1 {
+
+namespace {
+
+const int PASS_SHIFT = 62;
+const int PROGRAM_SHIFT = 52;
+const int MATERIAL_SHIFT = 36;
+const int MESH_SHIFT = 20;
+
+const unsigned int PROGRAM_MASK = 0x3FF;
+const unsigned int MATERIAL_MASK = 0xFFFF;
+const unsigned int MESH_MASK = 0xFFFF;
+const unsigned int DEPTH_MASK = 0xFFFFF;
+
+// sampler uniforms of the texture slots, in TextureSlot order
+const char* const SLOT_SAMPLERS[NUM_TEXTURE_SLOTS] = {"u_Material.texture_diffuse1", "u_Material.texture_normal1",
+                                                      "u_Material.texture_height1", "u_Material.texture_opacity1"};
+
+}  // namespace
+
+uint64_t RenderQueue::MakeKey(RenderPass pass, unsigned int program, unsigned int material, unsigned int mesh,
+                              float viewDepth) {
+    // the bits of a positive float grow with its value, their top bits make a depth with logarithmic precision
+    uint32_t depthBits = 0;
+    if (viewDepth > 0.0f) std::memcpy(&depthBits, &viewDepth, sizeof(depthBits));
+
+    return ((uint64_t)pass << PASS_SHIFT) | ((uint64_t)(program & PROGRAM_MASK) << PROGRAM_SHIFT) |
+           ((uint64_t)(material & MATERIAL_MASK) << MATERIAL_SHIFT) |
+           ((uint64_t)(mesh & MESH_MASK) << MESH_SHIFT) | ((depthBits >> 11) & DEPTH_MASK);
+}
+
+unsigned int RenderQueue::HashTextures(const unsigned int* textures) {
+    // a collision only puts two texture sets next to each other, the binds are still checked one by one
+    uint32_t hash = 2166136261u;
+    for (int slot = 0; slot < NUM_TEXTURE_SLOTS; slot++) {
+        hash = (hash ^ textures[slot]) * 16777619u;
+    }
+    return (hash ^ (hash >> 16)) & MATERIAL_MASK;
+}
+
+void RenderQueue::Sort() {
+    size_t count = m_Packets.size();
+    m_Sorted.resize(count);
+    m_Scratch.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+        m_Sorted[i].key = m_Packets[i].key;
+        m_Sorted[i].packet = static_cast<uint32_t>(i);
+    }
+
+    // least significant byte first, every pass is a stable counting sort on one byte
+    for (int shift = 0; shift < 64 && count > 1; shift += 8) {
+        size_t offsets[256] = {0};
+        for (size_t i = 0; i < count; i++) {
+            offsets[(m_Sorted[i].key >> shift) & 0xFF]++;
+        }
+
+        // most bytes are the same for every key in a frame, such as the pass or the top bits of the depth
+        if (offsets[(m_Sorted[0].key >> shift) & 0xFF] == count) continue;
+
+        size_t sum = 0;
+        for (int bucket = 0; bucket < 256; bucket++) {
+            size_t bucketSize = offsets[bucket];
+            offsets[bucket] = sum;
+            sum += bucketSize;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            m_Scratch[offsets[(m_Sorted[i].key >> shift) & 0xFF]++] = m_Sorted[i];
+        }
+        m_Sorted.swap(m_Scratch);
+    }
+
+    BuildCommands();
+}
+
+bool RenderQueue::CanInstance(const DrawPacket& a, const DrawPacket& b) {
+    // skinned packets have a bone offset each, and meshes instanced on their own already draw several copies
+    return a.instanced && b.instanced && a.shader == b.shader && a.vertexArray == b.vertexArray &&
+           a.firstIndex == b.firstIndex && a.numIndices == b.numIndices && a.baseVertex == b.baseVertex &&
+           a.numInstances == 1 && b.numInstances == 1 && a.boneOffset < 0 && b.boneOffset < 0 &&
+           a.setLit == b.setLit && std::memcmp(a.textures, b.textures, sizeof(a.textures)) == 0;
+}
+
+bool RenderQueue::CanMultiDraw(const DrawPacket& a, const DrawPacket& b) {
+    // the commands of a multi draw only differ in their geometry and instances, everything else is shared
+    return a.instanced && b.instanced && a.shader == b.shader && a.vertexArray == b.vertexArray &&
+           a.boneOffset < 0 && b.boneOffset < 0 && a.setLit == b.setLit &&
+           std::memcmp(a.textures, b.textures, sizeof(a.textures)) == 0;
+}
+
+void RenderQueue::BuildCommands() {
+    m_Draws.clear();
+    m_Commands.clear();
+    m_InstanceMatrices.clear();
+
+    uint32_t count = static_cast<uint32_t>(m_Sorted.size());
+    for (uint32_t first = 0; first < count;) {
+        const DrawPacket& packet = m_Packets[m_Sorted[first].packet];
+
+        // equal state sorts next to each other, so a run ends at the first packet that differs
+        uint32_t end = first + 1;
+        while (end < count && end - first < maxInstances && CanInstance(packet, m_Packets[m_Sorted[end].packet])) {
+            end++;
+        }
+
+        DrawElementsIndirectCommand command;
+        command.count = packet.numIndices;
+        command.instanceCount = packet.numInstances * (end - first);
+        command.firstIndex = packet.firstIndex;
+        command.baseVertex = packet.baseVertex;
+        command.baseInstance = 0;
+
+        if (packet.instanced) {
+            command.baseInstance = static_cast<unsigned int>(m_InstanceMatrices.size());
+            for (uint32_t i = first; i < end; i++) {
+                m_InstanceMatrices.push_back(*m_Packets[m_Sorted[i].packet].model);
+            }
+        }
+
+        bool joined = false;
+        if (multiDraw && !m_Draws.empty()) {
+            const DrawPacket& previous = m_Packets[m_Sorted[m_Draws.back().packet].packet];
+            joined = CanMultiDraw(previous, packet);
+        }
+
+        if (joined) {
+            m_Draws.back().numCommands++;
+        } else {
+            Draw draw;
+            draw.packet = first;
+            draw.firstCommand = static_cast<uint32_t>(m_Commands.size());
+            draw.numCommands = 1;
+            m_Draws.push_back(draw);
+        }
+
+        m_Commands.push_back(command);
+        first = end;
+    }
+}
+
+void RenderQueue::Submit(RenderBackend& backend) {
+    m_Stats = RenderStats();
+    m_Stats.packets = static_cast<unsigned int>(m_Sorted.size());
+
+    // nothing is known about the state other code left behind, the first packet binds everything
+    Shader* program = nullptr;
+    unsigned int textures[NUM_TEXTURE_SLOTS] = {0};
+    unsigned int vertexArray = 0;
+    int setLit = INT_MIN;
+    int boneOffset = INT_MIN;
+    int instanceBase = -1;
+
+    if (!m_Commands.empty()) backend.SetIndirectCommands(&m_Commands[0], static_cast<unsigned int>(m_Commands.size()));
+
+    for (const Draw& draw : m_Draws) {
+        const DrawPacket& packet = m_Packets[m_Sorted[draw.packet].packet];
+
+        if (packet.shader != program) {
+            ResetInstanceBase(backend, program, instanceBase);
+
+            program = packet.shader;
+            backend.UseProgram(program);
+            m_Stats.programBinds++;
+
+            // uniforms are program state, a newly bound program gets the fixed sampler units once
+            for (int slot = 0; slot < NUM_TEXTURE_SLOTS; slot++) {
+                backend.SetUniform(program, SLOT_SAMPLERS[slot], slot);
+            }
+            backend.SetUniform(program, "u_UseLights", 1);
+            m_Stats.uniformUpdates += NUM_TEXTURE_SLOTS + 1;
+
+            setLit = INT_MIN;
+            boneOffset = INT_MIN;
+        } else {
+            m_Stats.redundantBinds++;
+        }
+
+        for (int slot = 0; slot < NUM_TEXTURE_SLOTS; slot++) {
+            // after sorting any packet may come before this one, so an untextured packet must not sample the diffuse
+            // texture it left behind. the other slots are only sampled when the mesh has them.
+            unsigned int texture = packet.textures[slot];
+            if (texture == 0 && slot == DiffuseSlot) texture = defaultDiffuse;
+            if (texture == 0) continue;
+
+            if (texture != textures[slot]) {
+                textures[slot] = texture;
+                backend.BindTexture(slot, textures[slot]);
+                m_Stats.textureBinds++;
+            } else {
+                m_Stats.redundantBinds++;
+            }
+        }
+
+        if (packet.vertexArray != vertexArray) {
+            vertexArray = packet.vertexArray;
+            backend.BindVertexArray(vertexArray);
+            m_Stats.vertexArrayBinds++;
+        } else {
+            m_Stats.redundantBinds++;
+        }
+
+        if (packet.instanced) {
+            // the commands carry their first matrix as base instance, the uniform only switches the buffer on
+            if (instanceBase != 0) {
+                instanceBase = 0;
+                backend.SetUniform(program, "u_InstanceBase", instanceBase);
+                m_Stats.uniformUpdates++;
+            }
+        } else {
+            backend.SetUniform(program, "u_Model", *packet.model);
+            m_Stats.uniformUpdates++;
+        }
+
+        if (packet.setLit != setLit) {
+            setLit = packet.setLit;
+            backend.SetUniform(program, "u_SetLit", setLit);
+            m_Stats.uniformUpdates++;
+        }
+
+        if (packet.boneOffset != boneOffset) {
+            boneOffset = packet.boneOffset;
+            backend.SetUniform(program, "u_BoneOffset", boneOffset);
+            m_Stats.uniformUpdates++;
+        }
+
+        if (draw.numCommands > 1) {
+            backend.MultiDrawElementsIndirect(draw.firstCommand, draw.numCommands);
+            m_Stats.multiDraws++;
+            m_Stats.indirectCommands += draw.numCommands;
+        } else {
+            backend.DrawElements(m_Commands[draw.firstCommand]);
+        }
+        m_Stats.drawCalls++;
+
+        for (uint32_t command = draw.firstCommand; command < draw.firstCommand + draw.numCommands; command++) {
+            if (m_Commands[command].instanceCount > 1) m_Stats.instancedDraws++;
+        }
+    }
+
+    ResetInstanceBase(backend, program, instanceBase);
+    backend.Finish();
+}
+
+void RenderQueue::ResetInstanceBase(RenderBackend& backend, Shader* program, int& instanceBase) {
+    // code drawing with the program outside the queue sets u_Model and expects it to be used
+    if (instanceBase < 0) return;
+
+    backend.SetUniform(program, "u_InstanceBase", -1);
+    m_Stats.uniformUpdates++;
+    instanceBase = -1;
+}
+
+}  // namespace gdp1
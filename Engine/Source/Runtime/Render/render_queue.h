@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "render_backend.h"
+
+namespace gdp1 {
+
+enum class RenderPass { Opaque = 0, AlphaTest = 1 };
+
+// Texture units of the material samplers, the same for every program so a texture stays bound across draws.
+enum TextureSlot { DiffuseSlot = 0, NormalSlot, HeightSlot, OpacitySlot, NUM_TEXTURE_SLOTS };
+
+// Everything one draw needs, copied out of the mesh so sorting and submitting do not touch it again.
+struct DrawPacket {
+    uint64_t key;
+    Shader* shader;
+    const glm::mat4* model;  // owned by the render list, lives until the queue is submitted
+    unsigned int vertexArray;
+    unsigned int firstIndex;  // of the mesh in the vertex array's index buffer
+    unsigned int numIndices;
+    int baseVertex;
+    unsigned int numInstances;
+    unsigned int textures[NUM_TEXTURE_SLOTS];  // 0 where the mesh has no texture of that kind
+    int boneOffset;                            // -1 if not skinned
+    int setLit;
+    bool instanced;  // the program reads its model matrix from the instance buffer, see u_InstanceBase
+};
+
+// GL state changes of the last submitted frame
+struct RenderStats {
+    unsigned int packets = 0;
+    unsigned int instancedDraws = 0;  // commands drawing more than one instance
+    unsigned int multiDraws = 0;      // glMultiDrawElementsIndirect calls
+    unsigned int indirectCommands = 0;
+    unsigned int programBinds = 0;
+    unsigned int textureBinds = 0;
+    unsigned int vertexArrayBinds = 0;
+    unsigned int uniformUpdates = 0;
+    unsigned int drawCalls = 0;
+    // binds that were skipped because the state was already set
+    unsigned int redundantBinds = 0;
+
+    unsigned int GetStateChanges() const { return programBinds + textureBinds + vertexArrayBinds; }
+};
+
+// Draws a frame's opaque geometry in state order.
+// The packets are sorted by a 64 bit key, from the most significant bits down: pass (2), program (10), texture set
+// (16), mesh (16), depth (20). Draws sharing a program are therefore adjacent, within a program the ones sharing
+// textures, and so on, and the nearest come first among identical state to help the depth test.
+// Sorting then turns the packets into indirect draw commands: a run of packets drawing the same mesh with the same
+// state becomes one instanced command, and the commands of neighbouring meshes that share a vertex array (the
+// GeometryArena) and all other state are issued together by one glMultiDrawElementsIndirect. The model matrices of
+// the instanced packets are gathered into one array, each command finds its own through gl_BaseInstance.
+// Submitting keeps the bound program, textures and vertex array and only calls the backend when they change.
+// Everything up to the backend calls is plain CPU work and can be checked with a RecordingRenderBackend.
+class RenderQueue {
+public:
+    void Clear() {
+        m_Packets.clear();
+        m_Sorted.clear();
+        m_Draws.clear();
+        m_Commands.clear();
+        m_InstanceMatrices.clear();
+    }
+    void Add(const DrawPacket& packet) { m_Packets.push_back(packet); }
+
+    // Radix sorts the packets by key and builds the draw commands.
+    void Sort();
+    // Issues the sorted packets through backend and counts the state changes.
+    void Submit(RenderBackend& backend);
+
+    // viewDepth is the distance along the view direction, negative depths sort as 0
+    // mesh tells meshes apart, only equal values get merged into instances
+    static uint64_t MakeKey(RenderPass pass, unsigned int program, unsigned int material, unsigned int mesh,
+                            float viewDepth);
+    // folds a texture set into the 16 bits of the key, equal sets always get the same value
+    static unsigned int HashTextures(const unsigned int* textures);
+
+    unsigned int GetPacketCount() const { return static_cast<unsigned int>(m_Packets.size()); }
+    const DrawPacket& GetSortedPacket(unsigned int index) const { return m_Packets[m_Sorted[index].packet]; }
+    const RenderStats& GetStats() const { return m_Stats; }
+
+    // model matrices of the instanced packets in draw order, upload them before Submit
+    const std::vector<glm::mat4>& GetInstanceMatrices() const { return m_InstanceMatrices; }
+    // the commands built by Sort, in draw order
+    const std::vector<DrawElementsIndirectCommand>& GetCommands() const { return m_Commands; }
+
+    // at most this many packets are merged into one command
+    unsigned int maxInstances = 1024;
+    // whether commands may be merged into multi draws
+    bool multiDraw = true;
+    // bound for packets without a diffuse texture, the shaders always sample it. 0 leaves the unit as it is.
+    unsigned int defaultDiffuse = 0;
+
+private:
+    struct SortEntry {
+        uint64_t key;
+        uint32_t packet;
+    };
+
+    struct Draw {
+        uint32_t packet;        // into m_Sorted, the first packet, whose state the draw uses
+        uint32_t firstCommand;  // into m_Commands
+        uint32_t numCommands;   // more than one goes out as a multi draw
+    };
+
+    void BuildCommands();
+    // whether b can be another instance of a
+    static bool CanInstance(const DrawPacket& a, const DrawPacket& b);
+    // whether b can be another command in the multi draw of a
+    static bool CanMultiDraw(const DrawPacket& a, const DrawPacket& b);
+    // sets u_InstanceBase of the bound program back to -1 if a draw changed it
+    void ResetInstanceBase(RenderBackend& backend, Shader* program, int& instanceBase);
+
+private:
+    std::vector<DrawPacket> m_Packets;
+    // keys and packet indices, sorting them moves 16 bytes per packet instead of the whole packet
+    std::vector<SortEntry> m_Sorted;
+    std::vector<SortEntry> m_Scratch;
+
+    std::vector<Draw> m_Draws;
+    std::vector<DrawElementsIndirectCommand> m_Commands;
+    std::vector<glm::mat4> m_InstanceMatrices;
+
+    RenderStats m_Stats;
+};
+
+}  // namespace gdp1
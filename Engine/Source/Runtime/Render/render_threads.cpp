@@ -15,6 +15,12 @@ DWORD WINAPI LoadModelThread(LPVOID lpParameter) {
     gdp1::Model* model =
         new gdp1::Model(params->modelDesc.filepath, params->modelDesc.shader, params->modelDesc.textures, 1, {});
 
+    // simplifying is the slow part of loading, it runs here on the loader thread, the GL setup follows on the main thread
+    if (params->modelDesc.lodLevels > 1) {
+        model->GenerateLODs(params->modelDesc.lodLevels, params->modelDesc.lodReduction);
+        LOG_INFO("Generated {0} levels of detail for {1}", model->lodLevels.size() - 1, params->modelDesc.name);
+    }
+
     // Lock the mutex before modifying shared data
     std::lock_guard<std::mutex> lock(g_Mutex);
 
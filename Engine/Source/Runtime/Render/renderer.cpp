@@ -7,10 +7,20 @@
 #include "Utils/camera.h"
 #include "Core/game_object.h"
 #include "Core/application.h"
+#include "Core/components.h"
 #include "Physics/softbody.h"
 #include "Core/timestep.h"
 #include "Render/frustum.h"
+#include "Render/scene_bvh.h"
+#include "Render/occlusion_culler.h"
+#include "Render/light_clusterer.h"
+#include "Render/render_queue.h"
+#include "Render/render_backend.h"
+#include "Render/uniform_blocks.h"
 #include "Resource/lod_system.h"
+#include "Resource/texture.h"
+#include "Animation/pose_system.h"
+#include "Render/Buffers/ring_buffer.h"
 #include "Utils/timer.h"
 
 #include <GLFW/glfw3.h>
@@ -23,11 +33,26 @@ namespace gdp1 {
 Renderer::Renderer() {
     this->viewFrustum = new Frustum();
     this->lodSystem = new LODSystem();
+    this->poseSystem = new PoseSystem();
+    this->occlusionCuller = new OcclusionCuller();
+    this->lightClusterer = new LightClusterer();
+    this->renderQueue = new RenderQueue();
+    this->renderBackend = new GLRenderBackend();
+    this->boneBuffer = new RingBuffer();
+    this->instanceBuffer = new RingBuffer();
+    this->uniformBuffer = new RingBuffer();
+    this->lightBuffer = new RingBuffer();
     this->projectionMatrix = glm::mat4(1.0f);
     this->viewMatrix = glm::mat4(1.0f);
 }
 
 void Renderer::Render(std::shared_ptr<Scene> scene, std::shared_ptr<Camera> camera, Timestep ts) {
+    BuildRenderList(scene, camera);
+    UpdateAnimations(ts);
+    Submit(scene, camera, ts);
+}
+
+void Renderer::BuildRenderList(std::shared_ptr<Scene> scene, std::shared_ptr<Camera> camera) {
     if (!scene || !camera) {
         LOG_ERROR("Scene or camera is null");
         return;
@@ -35,87 +60,232 @@ void Renderer::Render(std::shared_ptr<Scene> scene, std::shared_ptr<Camera> came
 
     mat4 projection = camera->GetProjectionMatrix();
     mat4 view = camera->GetViewMatrix();
-    mat4 umodel = mat4(1.0f);
-    mat4 mv = view * umodel;
-    mat3 normalMatrix = mat3(vec3(mv[0]), vec3(mv[1]), vec3(mv[2]));
 
     glm::mat4 viewProjectionMatrix = projection * view;
 
-    if (scene->HasFBO()) {
-        scene->UseFBO();
-        projection = glm::scale(projection, glm::vec3(1.0f, -1.0f, 1.0f));
-    }
-
-    ResetFrameBuffers();
-    SetupShaders(scene, projection, view, umodel, normalMatrix);
-
     updateViewFrustum = isInstanced != setInstanced;
 
     if (viewFrustum->viewProjectionMatrix != viewProjectionMatrix || updateViewFrustum) {
         viewFrustum->Update(viewProjectionMatrix);
-        culledObjects.clear();
-        culledObjects = viewFrustum->GetCulledObjects(scene->GetGameObjectMap());
         updateViewFrustum = false;
     }
 
+    // objects move too, so the hierarchy is culled every frame, it only visits the nodes on the frustum's border
+    SceneBVH& bvh = scene->GetBVH();
+    bvh.Cull(*viewFrustum, visibleIndices);
+
+    culledObjects.clear();
+    for (uint32_t index : visibleIndices) {
+        culledObjects.push_back(bvh.GetGameObject(index));
+    }
+
+    // the occluders are picked from everything in view, instanced static objects included
+    if (occlusionCulling) occlusionCuller->RenderOccluders(viewProjectionMatrix, camera->GetEye(), culledObjects);
+
     isInstanced = setInstanced;
 
     if (setInstanced) {
-        if (projectionMatrix != projection || viewMatrix != view)
+        if (projectionMatrix != projection || viewMatrix != view) {
             SetupInstancedRendering(projection, view, culledObjects);
+        }
+
+        culledObjects = dynamicObjects;
+    }
+
+    if (occlusionCulling) occlusionCuller->CullObjects(culledObjects);
+
+    lodSystem->Update(camera->GetEye(), projection, (float)Application::Get().GetWindow().GetHeight(), culledObjects);
+
+    renderList.projection = projection;
+    renderList.view = view;
+    renderList.items.clear();
+
+    for (GameObject* go : culledObjects) {
+        if (go != nullptr && go->visible && go->model != nullptr) {
+            RenderItem item = {go, go->transform->WorldMatrix()};
+            item.lodLevel = go->lodLevel;
+            renderList.items.push_back(item);
+        }
+    }
+
+    renderList.hiddenAnimated.clear();
+
+    // flag the culled set once by entity instead of looking every animated object up by name
+    std::fill(entityInView.begin(), entityInView.end(), 0);
+    for (GameObject* go : culledObjects) {
+        if (go == nullptr || go->entity == INVALID_ENTITY) continue;
+
+        if (go->entity >= entityInView.size()) entityInView.resize(go->entity + 1, 0);
+        entityInView[go->entity] = 1;
+    }
+
+    scene->GetRegistry().Each<AnimatorComponent>([this](Entity entity, AnimatorComponent& animated) {
+        GameObject* go = animated.object;
+        if (!animated.animator->IsPlaying()) return;
+
+        bool inView = entity < entityInView.size() && entityInView[entity] != 0;
+        if (!inView || !go->visible) {
+            renderList.hiddenAnimated.push_back(go);
+        }
+    });
+
+    renderList.valid = true;
+}
+
+void Renderer::UpdateAnimations(float deltaTime) { poseSystem->Update(renderList, deltaTime); }
+
+void Renderer::Submit(std::shared_ptr<Scene> scene, std::shared_ptr<Camera> camera, Timestep ts) {
+    if (!scene || !camera) {
+        LOG_ERROR("Scene or camera is null");
+        return;
+    }
+
+    // the very first frame has nothing built yet
+    if (!renderList.valid) BuildRenderList(scene, camera);
+
+    mat4 projection = renderList.projection;
+    mat4 view = renderList.view;
+    mat4 umodel = mat4(1.0f);
+    mat4 mv = view * umodel;
+    mat3 normalMatrix = mat3(vec3(mv[0]), vec3(mv[1]), vec3(mv[2]));
+
+    if (scene->HasFBO()) {
+        scene->UseFBO();
+        projection = glm::scale(projection, glm::vec3(1.0f, -1.0f, 1.0f));
+    }
+
+    ResetFrameBuffers();
+    UploadFrameUniforms(scene, projection, view, normalMatrix);
+    UploadBonePalette();
+
+    if (isInstanced) {
+        if (instancesDirty) UploadInstances();
 
         for (unordered_map<Model*, vector<glm::mat4>>::iterator it = instancesMap.begin(); it != instancesMap.end();
              it++) {
             scene->inst_shader_ptr_->Use();
             scene->inst_shader_ptr_->SetUniform("u_SetLit", false);
             scene->inst_shader_ptr_->SetUniform("u_UseLights", true);
-            it->first->currentLODLevel = 0;
             it->first->Draw(scene->inst_shader_ptr_);
         }
-
-        culledObjects = dynamicGoMap;
     }
 
-    lodSystem->Update(camera, culledObjects);
-    
-    for (std::unordered_map<std::string, GameObject*>::iterator it = culledObjects.begin(); it != culledObjects.end();
-         it++) {
-        GameObject* go = it->second;
-        if (go != nullptr && go->visible) {
-            Model* model = go->model;
-            if (model != nullptr) {
-                // find shader
-                unordered_map<string, Shader*>::const_iterator shaderIt = scene->m_ShaderMap.find(model->shaderName);
-                if (shaderIt == scene->m_ShaderMap.end()) {
-                    LOG_ERROR("Cannot find shader: " + model->shaderName);
-                    continue;
-                }
-
-                Shader* shader = shaderIt->second;
+    renderQueue->Clear();
+    // meshes without a diffuse texture sample white, the first frame has a GL context to make it in
+    if (renderQueue->defaultDiffuse == 0) renderQueue->defaultDiffuse = Texture::CreateWhiteTexture();
+
+    Shader* lastShader = nullptr;
+    bool instanced = false;
+
+    for (const RenderItem& item : renderList.items) {
+        GameObject* go = item.gameObject;
+        Model* model = go->model;
+
+        // models made after the scene loaded resolve their shader name on their first draw
+        Shader* shader = scene->GetShader(model->shaderHandle);
+        if (shader == nullptr) {
+            model->shaderHandle = scene->FindShaderHandle(model->shaderName);
+            shader = scene->GetShader(model->shaderHandle);
+            if (shader == nullptr) {
+                LOG_ERROR("Cannot find shader: " + model->shaderName);
+                continue;
+            }
+        }
+
+        if (go->hasSoftBody) {
+            if (go->softBody) {
                 shader->Use();
-                shader->SetUniform("u_Model", go->transform->WorldMatrix());
+                shader->SetUniform("u_Model", item.worldMatrix);
                 shader->SetUniform("u_SetLit", go->setLit);
                 shader->SetUniform("u_UseLights", true);
-
-                if (!go->hasSoftBody) {
-                    if (go->currentAnim != "") {
-                        go->UpdateAnimation(shader, ts);
-
-                        model->currentAnimation = go->currentAnimation;
-                        model->prevAnimation = go->prevAnimation;
-                    }
-                    model->ResetInstancing();
-                    model->Draw(shader);
-                } else {
-                    if (go->softBody) go->softBody->Draw(shader);
-                }
+                go->softBody->Draw(shader);
             }
+            continue;
+        }
+
+        model->ResetInstancing();
+        if (item.lodLevel >= model->lodLevels.size()) continue;
+
+        // programs that can read their model matrix from the instance buffer get their equal draws merged
+        if (shader != lastShader) {
+            lastShader = shader;
+            instanced = shader->HasUniform("u_InstanceBase");
+        }
+
+        float viewDepth = -(view * item.worldMatrix[3]).z;
+        for (const Mesh* mesh : model->lodLevels[item.lodLevel].meshes) {
+            const unsigned int* textures = mesh->GetSlotTextures();
+            const GeometryRange& geometry = mesh->GetGeometryRange();
+
+            DrawPacket packet;
+            packet.shader = shader;
+            packet.model = &item.worldMatrix;
+            packet.vertexArray = mesh->GetVertexArray();
+            packet.firstIndex = geometry.firstIndex;
+            packet.numIndices = geometry.numIndices;
+            packet.baseVertex = geometry.baseVertex;
+            packet.numInstances = mesh->GetInstanceCount();
+            std::copy(textures, textures + NUM_TEXTURE_SLOTS, packet.textures);
+            // the palette is already on the GPU, a skinned draw only needs to know where its bones start
+            packet.boneOffset = item.boneCount > 0 ? (int)item.boneOffset : -1;
+            packet.setLit = go->setLit ? 1 : 0;
+            packet.instanced = instanced;
+
+            RenderPass pass = textures[OpacitySlot] != 0 ? RenderPass::AlphaTest : RenderPass::Opaque;
+            packet.key = RenderQueue::MakeKey(pass, shader->GetHandle(), RenderQueue::HashTextures(packet.textures),
+                                              mesh->GetLocalVertexArray(), viewDepth);
+            renderQueue->Add(packet);
         }
     }
 
+    renderQueue->Sort();
+    UploadInstanceMatrices();
+    renderQueue->Submit(*renderBackend);
+
     // always draw the skybox at last
     if (renderSkybox) scene->skybox_ptr_->Draw(scene->skybox_shader_ptr_, view, projection);
     if (drawDebug) RenderDebug(scene, camera, ts);
+
+    // the GPU may not touch this frame's bone region again until the fence has passed
+    if (boneBuffer->IsCreated()) boneBuffer->EndRegion();
+    if (instanceBuffer->IsCreated()) instanceBuffer->EndRegion();
+}
+
+const RenderStats& Renderer::GetRenderStats() const { return renderQueue->GetStats(); }
+
+void Renderer::UploadBonePalette() {
+    if (renderList.bonePalette.empty()) return;
+
+    GLsizeiptr size = (GLsizeiptr)(renderList.bonePalette.size() * sizeof(glm::mat4));
+
+    // grow with some headroom so a few more characters do not reallocate every frame
+    if (!boneBuffer->IsCreated() || boneBuffer->GetRegionSize() < size) {
+        boneBuffer->Create(GL_SHADER_STORAGE_BUFFER, size + size / 2);
+    }
+
+    void* bones = boneBuffer->BeginRegion();
+    std::copy(renderList.bonePalette.begin(), renderList.bonePalette.end(), (glm::mat4*)bones);
+
+    // binding point 0 is the BonePalette block in lit.vert.glsl
+    boneBuffer->BindRange(0, 0, size);
+}
+
+void Renderer::UploadInstanceMatrices() {
+    const std::vector<glm::mat4>& matrices = renderQueue->GetInstanceMatrices();
+    if (matrices.empty()) return;
+
+    GLsizeiptr size = (GLsizeiptr)(matrices.size() * sizeof(glm::mat4));
+
+    // the buffer is mapped once and only recreated when the scene outgrows it
+    if (!instanceBuffer->IsCreated() || instanceBuffer->GetRegionSize() < size) {
+        instanceBuffer->Create(GL_SHADER_STORAGE_BUFFER, std::max(size * 2, (GLsizeiptr)(4096 * sizeof(glm::mat4))));
+    }
+
+    void* instances = instanceBuffer->BeginRegion();
+    std::copy(matrices.begin(), matrices.end(), (glm::mat4*)instances);
+
+    // binding point 1 is the InstanceMatrices block in lit.vert.glsl
+    instanceBuffer->BindRange(1, 0, size);
 }
 
 void Renderer::RenderDebug(std::shared_ptr<Scene> scene, std::shared_ptr<Camera> camera, Timestep ts) {
@@ -124,67 +294,48 @@ void Renderer::RenderDebug(std::shared_ptr<Scene> scene, std::shared_ptr<Camera>
         return;
     }
 
-    mat4 projection = camera->GetProjectionMatrix();
-    mat4 view = camera->GetViewMatrix();
     mat4 model = mat4(1.0f);
-    mat4 mv = view * model;
-    mat3 normalMatrix = mat3(vec3(mv[0]), vec3(mv[1]), vec3(mv[2]));
 
     {
-        // update uniforms for debug shader
+        // update uniforms for debug shader, view and projection are in the frame uniform block already
         scene->debug_shader_ptr_->Use();
         scene->debug_shader_ptr_->SetUniform("u_Model", model);
-        scene->debug_shader_ptr_->SetUniform("u_View", view);
-        scene->debug_shader_ptr_->SetUniform("u_Proj", projection);
     }
 
-    std::unordered_map<std::string, GameObject*>& goMap = scene->m_GameObjectMap;
-    std::unordered_map<std::string, Shader*>& shaderMap = scene->m_ShaderMap;
-
-#pragma omp parallel for
-    for (std::unordered_map<std::string, GameObject*>::iterator it = goMap.begin(); it != goMap.end(); it++) {
-        GameObject* go = it->second;
-        if (go != nullptr && go->visible) {
-            Model* model = go->model;
-            if (model != nullptr) {
-                // find shader
-                std::unordered_map<std::string, Shader*>::const_iterator shaderIt = shaderMap.find(model->shaderName);
-                if (shaderIt == shaderMap.end()) {
-                    LOG_ERROR("Cannot find shader: " + model->shaderName);
-                    continue;
-                }
-
-                glm::mat4 worldMat = go->transform->WorldMatrix();
-
-                Shader* shader = shaderIt->second;
-                shader->Use();
-                shader->SetUniform("u_Model", worldMat);
-                shader->SetUniform("u_SetLit", go->setLit);
-                shader->SetUniform("u_UseLights", true);
+    // the bounds of what was drawn, placed where the render list saw it. the transforms themselves are being written
+    // by the next frame's simulation meanwhile.
+    for (const RenderItem& item : renderList.items) {
+        GameObject* go = item.gameObject;
+        Model* model = go->model;
 
-                model->DrawDebug(shader);
-            }
+        Shader* shader = scene->GetShader(model->shaderHandle);
+        if (shader == nullptr) {
+            LOG_ERROR("Cannot find shader: " + model->shaderName);
+            continue;
         }
+
+        shader->Use();
+        shader->SetUniform("u_Model", item.worldMatrix);
+        shader->SetUniform("u_SetLit", go->setLit);
+        shader->SetUniform("u_UseLights", true);
+
+        model->DrawDebug(shader);
     }
 }
 
 void Renderer::SetupInstancedRendering(glm::mat4& projMatrix, glm::mat4& viewMatrix,
-                                       std::unordered_map<std::string, GameObject*>& gameObjects) {
+                                       const std::vector<GameObject*>& gameObjects) {
     this->projectionMatrix = projMatrix;
     this->viewMatrix = viewMatrix;
 
     instancesMap.clear();
-    dynamicGoMap.clear();
+    dynamicObjects.clear();
 
-#pragma omp parallel for
-    for (std::unordered_map<std::string, GameObject*>::iterator it = gameObjects.begin(); it != gameObjects.end();
-         it++) {
-        GameObject* go = it->second;
+    for (GameObject* go : gameObjects) {
         Model* model = go->model;
 
         if (model && go->isStatic && go->visible) {
             // Check if the model is already in instancesMap, and if not, add it
-            // #pragma omp critical
             if (instancesMap.find(model) == instancesMap.end()) {
                 instancesMap[model] = std::vector<glm::mat4>();
             }
@@ -193,18 +344,20 @@ void Renderer::SetupInstancedRendering(glm::mat4& projMatrix, glm::mat4& viewMat
         }
 
         if (!go->isStatic) {
-            // #pragma omp critical
-            dynamicGoMap[go->name] = go;
+            dynamicObjects.push_back(go);
         }
     }
 
-#pragma omp parallel for
+    instancesDirty = true;
+}
+
+void Renderer::UploadInstances() {
     for (std::unordered_map<Model*, std::vector<glm::mat4>>::iterator it = instancesMap.begin();
          it != instancesMap.end(); it++) {
         it->first->SetupInstancing(it->second, true);
     }
 
-    return;
+    instancesDirty = false;
 }
 
 void Renderer::SetInstanced(bool setInstanced) {
@@ -212,85 +365,115 @@ void Renderer::SetInstanced(bool setInstanced) {
     this->updateViewFrustum = true;
 }
 
-void Renderer::SetupShaders(std::shared_ptr<Scene> scene, glm::mat4 projection, glm::mat4 view, glm::mat4 model,
-                            glm::mat3 normalMatrix) {
-    // get the directional light
-    DirectionalLight* dirLight = scene->FindDirectionalLightByName("Sun");
+void Renderer::UploadFrameUniforms(std::shared_ptr<Scene> scene, const glm::mat4& projection, const glm::mat4& view,
+                                   const glm::mat3& normalMatrix) {
+    // get the directional light, by name only the first time
+    DirectionalLight* dirLight = scene->GetDirectionalLight(sunLight);
+    if (dirLight == nullptr) {
+        sunLight = scene->FindDirectionalLightHandle("Sun");
+        dirLight = scene->GetDirectionalLight(sunLight);
+    }
 
-    // update uniforms for default shader
-    scene->lit_shader_ptr_->Use();
-    scene->lit_shader_ptr_->SetUniform("u_Model", model);
-    scene->lit_shader_ptr_->SetUniform("u_View", view);
-    scene->lit_shader_ptr_->SetUniform("u_Proj", projection);
-    scene->lit_shader_ptr_->SetUniform("u_NormalMat", normalMatrix);
+    // both blocks in one region, the frame block is 256 bytes so the light block starts on any offset alignment
+    const GLsizeiptr lightOffset = sizeof(FrameUniforms);
+    if (!uniformBuffer->IsCreated()) {
+        uniformBuffer->Create(GL_UNIFORM_BUFFER, sizeof(FrameUniforms) + sizeof(LightUniforms));
+    } else {
+        // fenced here rather than at the end of Submit, everything drawn since the last upload read this region
+        uniformBuffer->EndRegion();
+    }
 
-    vec3 lightDirViewSpace = normalMatrix * dirLight->direction;
+    char* region = (char*)uniformBuffer->BeginRegion();
 
-    // directional light
-    scene->lit_shader_ptr_->SetUniform("u_DirLight.dir", lightDirViewSpace);
-    scene->lit_shader_ptr_->SetUniform("u_NumPointLights", (int)scene->m_PointLightMap.size());
-    scene->lit_shader_ptr_->SetUniform("u_UseLights", true);
+    FrameUniforms* frame = (FrameUniforms*)region;
+    frame->view = view;
+    frame->projection = projection;
+    frame->viewProjection = projection * view;
+    for (int i = 0; i < 3; i++) {
+        frame->normalMatrix[i] = vec4(normalMatrix[i], 0.0f);
+    }
+    frame->cameraPosition = glm::inverse(view)[3];
+
+    // without a sun the camera still has to reach the shaders, the sun then adds no light. the direction stays a
+    // unit vector, the shaders normalize it.
+    LightUniforms* lights = (LightUniforms*)(region + lightOffset);
+    lights->dirLight = DirectionalLightUniforms();
+    lights->dirLight.direction = vec3(0.0f, 0.0f, -1.0f);
+    if (dirLight) {
+        lights->dirLight.direction = normalMatrix * dirLight->direction;
+        lights->dirLight.color = dirLight->color;
+        lights->dirLight.intensity = dirLight->intensity;
+    }
 
-    int lightIndex = 0;
+    lights->numPointLights = UploadPointLights(scene, projection, view);
+
+    // the shader finds its cluster from gl_FragCoord and the view space depth
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    lights->clusterGrid = glm::ivec4(LightClusterer::TILES_X, LightClusterer::TILES_Y, LightClusterer::SLICES_Z, 0);
+    lights->clusterScale = vec4((float)viewport[2], (float)viewport[3], lightClusterer->GetSliceScale(),
+                                lightClusterer->GetSliceBias());
+
+    uniformBuffer->BindRange(FRAME_UNIFORM_BINDING, 0, sizeof(FrameUniforms));
+    uniformBuffer->BindRange(LIGHT_UNIFORM_BINDING, lightOffset, sizeof(LightUniforms));
+
+    isShadersInitialized = true;
+}
+
+int Renderer::UploadPointLights(std::shared_ptr<Scene> scene, const glm::mat4& projection, const glm::mat4& view) {
+    // lights that never fade out reach as far as the camera sees
+    float farPlane = projection[3][2] / (projection[2][2] + 1.0f);
+
+    lightSpheres.clear();
     for (std::unordered_map<std::string, PointLight*>::iterator it = scene->m_PointLightMap.begin();
-         it != scene->m_PointLightMap.end(); it++, lightIndex++) {
+         it != scene->m_PointLightMap.end(); it++) {
         PointLight* pointLight = it->second;
-        vec4 lightPosInViewSpace = glm::vec4(view * glm::vec4(pointLight->position, 1.0f));
-        scene->lit_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].color",
-                                           pointLight->color);
-        scene->lit_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].intensity",
-                                           pointLight->intensity);
-        scene->lit_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].c", pointLight->constant);
-        scene->lit_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].l", pointLight->linear);
-        scene->lit_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].q",
-                                           pointLight->quadratic);
-        scene->lit_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].pos",
-                                           glm::vec3(lightPosInViewSpace));
+        float radius = LightClusterer::GetLightRadius(*pointLight, lightClusterer->attenuationCutoff);
+        lightSpheres.push_back(vec4(vec3(view * vec4(pointLight->position, 1.0f)), std::min(radius, farPlane)));
     }
 
-    // update uniforms for instance shader same as default
-    scene->inst_shader_ptr_->Use();
-    scene->inst_shader_ptr_->SetUniform("u_View", view);
-    scene->inst_shader_ptr_->SetUniform("u_Proj", projection);
-    scene->inst_shader_ptr_->SetUniform("u_NormalMat", normalMatrix);
+    lightClusterer->Build(projection, lightSpheres);
+
+    // the lights, the clusters and the index lists back to back in one region, 256 is the largest offset alignment
+    // GL allows for storage buffers
+    const std::vector<LightClusterer::Cluster>& clusters = lightClusterer->GetClusters();
+    const std::vector<uint32_t>& indices = lightClusterer->GetLightIndices();
+    GLsizeiptr lightsSize = (GLsizeiptr)(std::max(lightSpheres.size(), (size_t)1) * sizeof(PointLightUniforms));
+    GLsizeiptr clustersSize = (GLsizeiptr)(clusters.size() * sizeof(LightClusterer::Cluster));
+    GLsizeiptr indicesSize = (GLsizeiptr)(std::max(indices.size(), (size_t)1) * sizeof(uint32_t));
+    GLsizeiptr clustersOffset = (lightsSize + 255) / 256 * 256;
+    GLsizeiptr indicesOffset = clustersOffset + (clustersSize + 255) / 256 * 256;
+    GLsizeiptr size = indicesOffset + indicesSize;
+
+    // fenced at the next upload like the uniform blocks, grown with headroom so flashes of lights do not reallocate
+    if (lightBuffer->IsCreated()) lightBuffer->EndRegion();
+    if (!lightBuffer->IsCreated() || lightBuffer->GetRegionSize() < size) {
+        lightBuffer->Create(GL_SHADER_STORAGE_BUFFER, size * 2);
+    }
 
-    scene->inst_shader_ptr_->SetUniform("u_DirLight.dir", lightDirViewSpace);
-    scene->inst_shader_ptr_->SetUniform("u_NumPointLights", (int)scene->m_PointLightMap.size());
-    scene->inst_shader_ptr_->SetUniform("u_UseLights", true);
+    char* region = (char*)lightBuffer->BeginRegion();
 
-    lightIndex = 0;
+    PointLightUniforms* lights = (PointLightUniforms*)region;
+    int lightIndex = 0;
     for (std::unordered_map<std::string, PointLight*>::iterator it = scene->m_PointLightMap.begin();
          it != scene->m_PointLightMap.end(); it++, lightIndex++) {
         PointLight* pointLight = it->second;
-        vec4 lightPosInViewSpace = glm::vec4(view * glm::vec4(pointLight->position, 1.0f));
-        scene->inst_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].color",
-                                            pointLight->color);
-        scene->inst_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].intensity",
-                                            pointLight->intensity);
-        scene->inst_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].c",
-                                            pointLight->constant);
-        scene->inst_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].l", pointLight->linear);
-        scene->inst_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].q",
-                                            pointLight->quadratic);
-        scene->inst_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].pos",
-                                            glm::vec3(lightPosInViewSpace));
+        PointLightUniforms& light = lights[lightIndex];
+        light.position = vec3(lightSpheres[lightIndex]);
+        light.color = pointLight->color;
+        light.intensity = pointLight->intensity;
+        light.constant = pointLight->constant;
+        light.linear = pointLight->linear;
+        light.quadratic = pointLight->quadratic;
     }
+    std::copy(clusters.begin(), clusters.end(), (LightClusterer::Cluster*)(region + clustersOffset));
+    std::copy(indices.begin(), indices.end(), (uint32_t*)(region + indicesOffset));
 
-    // update uniforms for untextured shader
-    scene->untextured_shader_ptr_->Use();
-    scene->untextured_shader_ptr_->SetUniform("u_Model", model);
-    scene->untextured_shader_ptr_->SetUniform("u_View", view);
-    scene->untextured_shader_ptr_->SetUniform("u_Proj", projection);
-    scene->untextured_shader_ptr_->SetUniform("u_NormalMat", normalMatrix);
-    scene->untextured_shader_ptr_->SetUniform("u_DirLight.dir", lightDirViewSpace);
-
-    // update uniforms for unlit shader
-    scene->unlit_shader_ptr_->Use();
-    scene->unlit_shader_ptr_->SetUniform("u_Model", model);
-    scene->unlit_shader_ptr_->SetUniform("u_View", view);
-    scene->unlit_shader_ptr_->SetUniform("u_Proj", projection);
+    lightBuffer->BindRange(POINT_LIGHT_STORAGE_BINDING, 0, lightsSize);
+    lightBuffer->BindRange(LIGHT_CLUSTER_STORAGE_BINDING, clustersOffset, clustersSize);
+    lightBuffer->BindRange(LIGHT_INDEX_STORAGE_BINDING, indicesOffset, indicesSize);
 
-    isShadersInitialized = true;
+    return lightIndex;
 }
 
 void Renderer::ResetFrameBuffers() {
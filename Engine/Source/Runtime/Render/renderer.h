@@ -2,6 +2,8 @@
 
 #include <common.h>
 
+#include "light.h"
+
 namespace gdp1 {
 
 // Forward declarations
@@ -12,20 +14,63 @@ class Model;
 class GameObject;
 class Frustum;
 class LODSystem;
+class PoseSystem;
+class RingBuffer;
+class OcclusionCuller;
+class LightClusterer;
+class RenderQueue;
+class RenderBackend;
+struct RenderStats;
+
+struct RenderItem {
+    GameObject* gameObject;
+    glm::mat4 worldMatrix;        // snapshot taken when the list was built
+    unsigned int boneOffset = 0;  // first matrix in RenderList::bonePalette
+    unsigned int boneCount = 0;   // 0 if the item is not skinned
+    unsigned int lodLevel = 0;    // into Model::lodLevels, picked by the LOD system
+};
+
+// Everything the submit step needs, captured at the end of the simulation so the main thread can draw it while the
+// next frame is being simulated.
+struct RenderList {
+    glm::mat4 projection = glm::mat4(1.0f);
+    glm::mat4 view = glm::mat4(1.0f);
+    std::vector<RenderItem> items;
+    std::vector<glm::mat4> bonePalette;  // skinning matrices of all animated items, back to back
+    std::vector<GameObject*> hiddenAnimated;  // animated objects that were culled, their animators only advance time
+    bool valid = false;
+};
 
 class Renderer {
 public:
     Renderer();
+    // builds the render list and submits it right away
     void Render(std::shared_ptr<Scene> scene, std::shared_ptr<Camera> camera, Timestep ts);
+    // CPU side: culling, LOD selection and render list generation. Safe to run on a worker thread.
+    void BuildRenderList(std::shared_ptr<Scene> scene, std::shared_ptr<Camera> camera);
+    // CPU side: advances the animators of the animated items in the render list and evaluates their poses into the
+    // bone palette in parallel. Runs after BuildRenderList.
+    void UpdateAnimations(float deltaTime);
+    // GL side: draws the last built render list. Must run on the main thread.
+    void Submit(std::shared_ptr<Scene> scene, std::shared_ptr<Camera> camera, Timestep ts);
     void RenderDebug(std::shared_ptr<Scene> scene, std::shared_ptr<Camera> camera, Timestep ts);
     void SetupInstancedRendering(glm::mat4& projMatrix, glm::mat4& viewMatrix,
-                                 std::unordered_map<std::string, GameObject*>& gameObjects);
+                                 const std::vector<GameObject*>& gameObjects);
     void SetInstanced(bool setInstanced);
 
+    LODSystem* GetLODSystem() { return lodSystem; }
+    PoseSystem* GetPoseSystem() { return poseSystem; }
+    OcclusionCuller* GetOcclusionCuller() { return occlusionCuller; }
+    LightClusterer* GetLightClusterer() { return lightClusterer; }
+    RenderQueue* GetRenderQueue() { return renderQueue; }
+    // GL state changes of the last submitted frame
+    const RenderStats& GetRenderStats() const;
+
     bool updateViewFrustum = true;
     bool setInstanced = false;
     bool renderSkybox = true;
     bool drawDebug = false;
+    bool occlusionCulling = true;
 
     bool isInstanced = true;
 
@@ -37,17 +82,40 @@ private:
     glm::mat4 viewMatrix;
 
     std::unordered_map<Model*, std::vector<glm::mat4>> instancesMap;
-    std::unordered_map<std::string, GameObject*> dynamicGoMap;
+    std::vector<GameObject*> dynamicObjects;
     std::vector<GameObject*> fcGoMap;
 
     Frustum* viewFrustum;
     LODSystem* lodSystem;
+    PoseSystem* poseSystem;
+    OcclusionCuller* occlusionCuller;
+    LightClusterer* lightClusterer;
+    RenderQueue* renderQueue;
+    RenderBackend* renderBackend;
+    RingBuffer* boneBuffer;      // bone palettes, one region per frame in flight
+    RingBuffer* instanceBuffer;  // model matrices of the render queue's merged draws, same
+    RingBuffer* uniformBuffer;   // the frame and light uniform blocks, same
+    RingBuffer* lightBuffer;     // the point lights and their clusters, same
+
+    std::vector<uint32_t> visibleIndices;  // into the scene BVH, reused every frame
+    std::vector<GameObject*> culledObjects;
+    std::vector<unsigned char> entityInView;  // per entity, whether it is in culledObjects
+    std::vector<glm::vec4> lightSpheres;  // view space point lights and their reach, reused every frame
+
+    DirectionalLightHandle sunLight;
 
-    std::unordered_map<std::string, GameObject*> culledObjects;
+    RenderList renderList;
+    bool instancesDirty = false;
 
 private:
-    void SetupShaders(std::shared_ptr<Scene> scene, glm::mat4 projection, glm::mat4 view, glm::mat4 model,
-                      glm::mat3 normalMat);
+    void UploadInstances();
+    void UploadBonePalette();
+    void UploadInstanceMatrices();
+    // writes the camera and light uniform blocks shared by all programs
+    void UploadFrameUniforms(std::shared_ptr<Scene> scene, const glm::mat4& projection, const glm::mat4& view,
+                             const glm::mat3& normalMatrix);
+    // bins the point lights into the light clusters and uploads both, returns the number of lights
+    int UploadPointLights(std::shared_ptr<Scene> scene, const glm::mat4& projection, const glm::mat4& view);
     void ResetFrameBuffers();
     bool IsObjectVisible(glm::mat4& projMatrix, glm::mat4& viewMatrix, GameObject* object);
     std::vector<GameObject*> PerformFrustumCulling(glm::mat4& projMatrix, glm::mat4& viewMatrix,
@@ -6,7 +6,11 @@
 #include "skybox.h"
 #include "Core/game_object.h"
 #include "Core/application.h"
+#include "Core/transform_hierarchy.h"
+#include "scene_bvh.h"
+#include "Core/components.h"
 #include "Animation/animation_system.h"
+#include "Animation/blend_tree.h"
 #include "Utils/timer.h"
 
 #include <GLFW/glfw3.h>
@@ -58,6 +62,32 @@ void Scene::CreateRootGameObject() {
     m_RootTransform->UpdateLocalMatrix();
 
     m_RootGameObject->transform = m_RootTransform;
+
+    m_TransformHierarchy = std::make_unique<TransformHierarchy>();
+    m_BVH = std::make_unique<SceneBVH>();
+
+    // create the pools up front, systems on worker threads only ever read them
+    m_Registry.GetPool<BehaviourComponent>();
+    m_Registry.GetPool<RenderableComponent>();
+    m_Registry.GetPool<AnimatorComponent>();
+}
+
+void Scene::RegisterGameObject(GameObject* go) {
+    go->entity = m_Registry.Create();
+    go->handle = m_GameObjectHandles.Add(go, StringTable::Intern(go->name));
+
+    BehaviourComponent behaviour = {go};
+    m_Registry.Add<BehaviourComponent>(go->entity, behaviour);
+
+    if (go->model != nullptr) {
+        RenderableComponent renderable = {go, go->model, go->transform};
+        m_Registry.Add<RenderableComponent>(go->entity, renderable);
+    }
+
+    if (go->animator != nullptr) {
+        AnimatorComponent animator = {go, go->animator};
+        m_Registry.Add<AnimatorComponent>(go->entity, animator);
+    }
 }
 
 Scene::~Scene() {
@@ -119,9 +149,8 @@ int Scene::DrawDebug(Shader* shader) {
 void Scene::Update(float deltaTime) {
     UpdateAnimation(deltaTime);
 
-    for (Transform* xform : m_RootTransform->children) {
-        UpdateHierarchy(xform);
-    }
+    m_TransformHierarchy->Update(m_RootTransform);
+    m_BVH->Update(m_Registry);
 }
 
 void Scene::SetAnimationSpeed(float speed) { m_AnimationSystemPtr->SetPlaySpeed(speed); }
@@ -132,25 +161,6 @@ void Scene::PlayNextAnimationClip() { m_AnimationSystemPtr->PlayNextClip(); }
 
 void Scene::PlayPreviousAnimationClip() { m_AnimationSystemPtr->PlayPreviousClip(); }
 
-void Scene::UpdateHierarchy(Transform* xform) {
-    if (xform->hasChanged) {
-        xform->UpdateLocalMatrix();
-    }
-
-    for (Transform* child : xform->children) {
-        child->hasChanged = true;
-        UpdateHierarchy(child);
-    }
-
-    if (xform->parent == m_RootTransform) {
-        xform->SetWorldMatrix(xform->LocalMatrix());
-    } else {
-        xform->SetWorldMatrix(xform->parent->WorldMatrix() * xform->LocalMatrix());
-    }
-
-    xform->hasChanged = false;
-}
-
 void Scene::UpdateAnimation(float deltaTime) { m_AnimationSystemPtr->Update(deltaTime); }
 
 void Scene::ProcessDesc(const LevelDesc& desc) {
@@ -162,8 +172,26 @@ void Scene::ProcessDesc(const LevelDesc& desc) {
     CreateLights(desc.directionalLights, desc.pointLights, desc.spotLights);
     CreateSkybox(desc.skyboxDesc);
     LoadShaders(desc);
+    RegisterResources();
     CreateAnimations(desc.animationRefDesc);
     CreateCharacterAnimations(desc.characterAnimationRefDescs);
+    CreateBlendTrees(desc.blendTreeDescs);
+}
+
+void Scene::RegisterResources() {
+    for (std::unordered_map<std::string, Shader*>::iterator it = m_ShaderMap.begin(); it != m_ShaderMap.end(); it++) {
+        if (!m_ShaderHandles.Find(it->first).IsValid()) {
+            m_ShaderHandles.Add(it->second, StringTable::Intern(it->first));
+        }
+    }
+
+    for (std::unordered_map<std::string, Model*>::iterator it = m_ModelMap.begin(); it != m_ModelMap.end(); it++) {
+        Model* model = it->second;
+        if (!m_ModelHandles.Find(it->first).IsValid()) m_ModelHandles.Add(model, StringTable::Intern(it->first));
+
+        model->shaderHandle = m_ShaderHandles.Find(model->shaderName);
+        if (!model->shaderHandle.IsValid()) LOG_ERROR("Cannot find shader: " + model->shaderName);
+    }
 }
 
 void Scene::LoadModel(std::unordered_map<std::string, Model*>* m_ModelMap, ModelDesc& modelDesc) {
@@ -292,33 +320,12 @@ bool Scene::LoadShaders(const LevelDesc& desc) {
         lit_shader_ptr_->Link();
         lit_shader_ptr_->Use();
 
-        DirectionalLight* dirLight = FindDirectionalLightByName("Sun");
-        if (dirLight == nullptr) {
-            LOG_ERROR("Cannot find directional light: Sun");
-            return false;
-        }
-
-        // directional light
-        lit_shader_ptr_->SetUniform("u_DirLight.color", dirLight->color);
-        lit_shader_ptr_->SetUniform("u_DirLight.intensity", dirLight->intensity);
+        // the lights are in the light uniform block, the renderer writes it every frame
         lit_shader_ptr_->SetUniform("u_Material.s", vec3(0.2f, 0.2f, 0.2f));
         lit_shader_ptr_->SetUniform("u_Material.shininess", 32.0f);
         lit_shader_ptr_->SetUniform("u_UseProjTex", false);
         lit_shader_ptr_->SetUniform("u_UsePointLights", true);
 
-        int lightIndex = 0;
-        for (std::unordered_map<std::string, PointLight*>::iterator it = m_PointLightMap.begin();
-             it != m_PointLightMap.end(); it++, lightIndex++) {
-            PointLight* pointLight = it->second;
-            lit_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].color", pointLight->color);
-            lit_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].intensity",
-                                        pointLight->intensity);
-            lit_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].pos", pointLight->position);
-            lit_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].c", pointLight->constant);
-            lit_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].l", pointLight->linear);
-            lit_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].q", pointLight->quadratic);
-        }
-
         m_ShaderMap.insert(std::make_pair("lit", lit_shader_ptr_));
     } catch (GLSLProgramException& e) {
         LOG_ERROR("GLSLProgramException: {}", e.what());
@@ -333,33 +340,12 @@ bool Scene::LoadShaders(const LevelDesc& desc) {
         inst_shader_ptr_->Link();
         inst_shader_ptr_->Use();
 
-        DirectionalLight* dirLight = FindDirectionalLightByName("Sun");
-        if (dirLight == nullptr) {
-            LOG_ERROR("Cannot find directional light: Sun");
-            return false;
-        }
-
-        // directional light
-        inst_shader_ptr_->SetUniform("u_DirLight.color", dirLight->color);
-        inst_shader_ptr_->SetUniform("u_DirLight.intensity", dirLight->intensity);
+        // the lights are in the light uniform block, the renderer writes it every frame
         inst_shader_ptr_->SetUniform("u_Material.s", vec3(0.2f, 0.2f, 0.2f));
         inst_shader_ptr_->SetUniform("u_Material.shininess", 32.0f);
         inst_shader_ptr_->SetUniform("u_UseProjTex", false);
         inst_shader_ptr_->SetUniform("u_UsePointLights", true);
 
-        int lightIndex = 0;
-        for (std::unordered_map<std::string, PointLight*>::iterator it = m_PointLightMap.begin();
-             it != m_PointLightMap.end(); it++, lightIndex++) {
-            PointLight* pointLight = it->second;
-            inst_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].color", pointLight->color);
-            inst_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].intensity",
-                                         pointLight->intensity);
-            inst_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].pos", pointLight->position);
-            inst_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].c", pointLight->constant);
-            inst_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].l", pointLight->linear);
-            inst_shader_ptr_->SetUniform("u_PointLights[" + std::to_string(lightIndex) + "].q", pointLight->quadratic);
-        }
-
         m_ShaderMap.insert(std::make_pair("inst", inst_shader_ptr_));
     } catch (GLSLProgramException& e) {
         LOG_ERROR("GLSLProgramException: {}", e.what());
@@ -390,10 +376,10 @@ bool Scene::LoadShaders(const LevelDesc& desc) {
         untextured_shader_ptr_->Link();
         untextured_shader_ptr_->Use();
 
-        // directional light
-        untextured_shader_ptr_->SetUniform("u_DirLight.a", vec3(0.05f, 0.05f, 0.05f));
-        untextured_shader_ptr_->SetUniform("u_DirLight.d", vec3(0.6f, 0.6f, 0.6f));
-        untextured_shader_ptr_->SetUniform("u_DirLight.s", vec3(0.5f, 0.5f, 0.5f));
+        // directional light colors, its direction is in the light uniform block
+        untextured_shader_ptr_->SetUniform("u_LightColors.a", vec3(0.05f, 0.05f, 0.05f));
+        untextured_shader_ptr_->SetUniform("u_LightColors.d", vec3(0.6f, 0.6f, 0.6f));
+        untextured_shader_ptr_->SetUniform("u_LightColors.s", vec3(0.5f, 0.5f, 0.5f));
 
         untextured_shader_ptr_->SetUniform("u_Material.a", vec3(0.2f, 0.2f, 0.2f));
         untextured_shader_ptr_->SetUniform("u_Material.d", vec3(0.8f, 0.8f, 0.8f));
@@ -450,6 +436,7 @@ void Scene::CreateGameObjects(const std::vector<GameObjectDesc>& gameObjectDescs
         }
         go->scene = this;
         m_GameObjectMap.insert(std::make_pair(go->name, go));
+        RegisterGameObject(go);
 
         go->childrenNames = goDesc.children;
         go->parentName = goDesc.parentName;
@@ -493,17 +480,21 @@ void Scene::CreateLights(const std::vector<DirectionalLight>& directionalLights,
     GTimer timer("CreateLights");
     // create directional lights
     for (const DirectionalLight& lightDesc : directionalLights) {
-        m_DirectionalLightMap.emplace(lightDesc.name, new DirectionalLight(lightDesc));
+        DirectionalLight* light = new DirectionalLight(lightDesc);
+        m_DirectionalLightMap.emplace(lightDesc.name, light);
+        m_DirectionalLightHandles.Add(light, StringTable::Intern(lightDesc.name));
     }
 
     // create point lights
     for (const PointLight& lightDesc : pointLights) {
-        m_PointLightMap.emplace(lightDesc.name, new PointLight(lightDesc));
+        AddPointLight(lightDesc);
     }
 
     // create spot lights
     for (const SpotLight& lightDesc : spotLights) {
-        m_SpotLightMap.emplace(lightDesc.name, new SpotLight(lightDesc));
+        SpotLight* light = new SpotLight(lightDesc);
+        m_SpotLightMap.emplace(lightDesc.name, light);
+        m_SpotLightHandles.Add(light, StringTable::Intern(lightDesc.name));
     }
 }
 
@@ -553,13 +544,63 @@ void Scene::CreateCharacterAnimations(const std::vector<CharacterAnimationRefDes
     for (const CharacterAnimationRefDesc& anim : desc) {
         std::unordered_map<std::string, Model*>::iterator modelIt = m_ModelMap.find(anim.model);
         if (modelIt != m_ModelMap.end()) {
-            CharacterAnimation* animation = new CharacterAnimation(anim.path, anim.name, modelIt->second);
             modelIt->second->AddCharacterAnimation(anim.name, anim.path);
-            modelIt->second->SetCurrentAnimation(anim.name);
         }
     }
 }
 
+void Scene::CreateBlendTrees(const std::vector<BlendTreeDesc>& desc) {
+    for (const BlendTreeDesc& treeDesc : desc) {
+        std::unordered_map<std::string, Model*>::iterator modelIt = m_ModelMap.find(treeDesc.model);
+        if (modelIt == m_ModelMap.end()) {
+            LOG_WARN("Blend tree {0} refers to unknown model {1}", treeDesc.name, treeDesc.model);
+            continue;
+        }
+
+        Model* model = modelIt->second;
+        BlendTree* tree = new BlendTree(model);
+
+        // node indices of the description are kept, so children can refer to nodes further down the list
+        for (const BlendNodeDesc& nodeDesc : treeDesc.nodes) {
+            BlendNode node;
+            node.children = nodeDesc.children;
+            node.thresholds = nodeDesc.thresholds;
+
+            if (nodeDesc.type == "blend1d") {
+                node.type = BlendNodeType::Blend1D;
+            } else if (nodeDesc.type == "additive") {
+                node.type = BlendNodeType::Additive;
+            } else if (nodeDesc.type == "layer") {
+                node.type = BlendNodeType::Layer;
+            } else {
+                node.type = BlendNodeType::Clip;
+            }
+
+            if (node.type == BlendNodeType::Clip) {
+                node.clip = model->FindAnimation(nodeDesc.clip);
+                if (node.clip < 0) LOG_WARN("Blend tree {0} uses unknown clip {1}", treeDesc.name, nodeDesc.clip);
+            }
+
+            if (!nodeDesc.parameter.empty()) node.parameter = tree->AddParameter(nodeDesc.parameter);
+            if (!nodeDesc.mask.empty()) node.mask = tree->AddMask(nodeDesc.mask);
+
+            tree->AddNode(node);
+        }
+
+        tree->SetRoot(treeDesc.root);
+
+        // a broken tree would make every animator using it sample garbage, leave it out altogether
+        std::string error;
+        if (!tree->Validate(error)) {
+            LOG_ERROR("Blend tree {0} is invalid: {1}", treeDesc.name, error);
+            delete tree;
+            continue;
+        }
+
+        model->blendTrees[treeDesc.name] = tree;
+    }
+}
+
 Model* Scene::FindModelByName(const std::string& name) {
     std::unordered_map<std::string, Model*>::iterator it = m_ModelMap.find(name);
     if (it != m_ModelMap.end()) {
@@ -585,6 +626,7 @@ void Scene::AddGameObject(GameObject* go) {
     go->scene = this;
 
     m_GameObjectMap.insert(std::make_pair(go->name, go));
+    RegisterGameObject(go);
 
     // top level game object is a child of the root game object
     if (go->parentName.empty()) {
@@ -593,35 +635,29 @@ void Scene::AddGameObject(GameObject* go) {
         m_RootTransform->children.push_back(xform);
     }
 
-    UpdateHierarchy(xform);
+    m_TransformHierarchy->Invalidate();
+    if (go->model != nullptr) m_BVH->Invalidate();
 }
 
-void Scene::AddPointLight(PointLight& pointLight) {
-    m_PointLightMap.emplace(pointLight.name, new PointLight(pointLight));
+void Scene::AddPointLight(const PointLight& pointLight) {
+    PointLight* light = new PointLight(pointLight);
+    if (m_PointLightMap.emplace(pointLight.name, light).second) {
+        m_PointLightHandles.Add(light, StringTable::Intern(pointLight.name));
+    } else {
+        delete light;
+    }
 }
 
 DirectionalLight* Scene::FindDirectionalLightByName(const std::string& name) {
-    DirectionalLightMap::iterator it = m_DirectionalLightMap.find(name);
-    if (it != m_DirectionalLightMap.end()) {
-        return it->second;
-    }
-    return nullptr;
+    return m_DirectionalLightHandles.Get(m_DirectionalLightHandles.Find(name));
 }
 
 PointLight* Scene::FindPointLightByName(const std::string& name) {
-    PointLightMap::iterator it = m_PointLightMap.find(name);
-    if (it != m_PointLightMap.end()) {
-        return it->second;
-    }
-    return nullptr;
+    return m_PointLightHandles.Get(m_PointLightHandles.Find(name));
 }
 
 SpotLight* Scene::FindSpotLightByName(const std::string& name) {
-    SpotLightMap::iterator it = m_SpotLightMap.find(name);
-    if (it != m_SpotLightMap.end()) {
-        return it->second;
-    }
-    return nullptr;
+    return m_SpotLightHandles.Get(m_SpotLightHandles.Find(name));
 }
 
 size_t Scene::GetAnimationCurClipIndex() const { return m_AnimationSystemPtr->GetCurrentClipIndex(); }
@@ -5,6 +5,9 @@
 #include "light.h"
 #include "fbo.h"
 #include "Resource/level_loader.h"
+#include "Core/entity_registry.h"
+#include "Core/handle.h"
+#include "Core/string_table.h"
 
 #include <Core/cs_runner.h>
 #include <future>
@@ -22,6 +25,8 @@ class Animation;
 class AnimationSystem;
 class Renderer;
 class ParticleSystem;
+class TransformHierarchy;
+class SceneBVH;
 
 struct LoadModelThreadParams {
     ModelDesc modelDesc;
@@ -48,17 +53,37 @@ public:
     void PlayNextAnimationClip();
     void PlayPreviousAnimationClip();
 
-    // helpers
+    // helpers, by name for tooling and load time
     Model* FindModelByName(const std::string& name);
     GameObject* FindObjectByName(const std::string& name);
 
     void AddGameObject(GameObject* gameObject);
-    void AddPointLight(PointLight& pointLight);
+    void AddPointLight(const PointLight& pointLight);
 
     DirectionalLight* FindDirectionalLightByName(const std::string& name);
     PointLight* FindPointLightByName(const std::string& name);
     SpotLight* FindSpotLightByName(const std::string& name);
 
+    // Handles resolve a name once, code that looks an object up every frame should keep the handle.
+    // The Get functions return nullptr for invalid or stale handles.
+    Handle<GameObject> FindObjectHandle(const std::string& name) const { return m_GameObjectHandles.Find(name); }
+    Handle<Model> FindModelHandle(const std::string& name) const { return m_ModelHandles.Find(name); }
+    ShaderHandle FindShaderHandle(const std::string& name) const { return m_ShaderHandles.Find(name); }
+    DirectionalLightHandle FindDirectionalLightHandle(const std::string& name) const {
+        return m_DirectionalLightHandles.Find(name);
+    }
+    PointLightHandle FindPointLightHandle(const std::string& name) const { return m_PointLightHandles.Find(name); }
+    SpotLightHandle FindSpotLightHandle(const std::string& name) const { return m_SpotLightHandles.Find(name); }
+
+    GameObject* GetGameObject(Handle<GameObject> handle) const { return m_GameObjectHandles.Get(handle); }
+    Model* GetModel(Handle<Model> handle) const { return m_ModelHandles.Get(handle); }
+    Shader* GetShader(ShaderHandle handle) const { return m_ShaderHandles.Get(handle); }
+    DirectionalLight* GetDirectionalLight(DirectionalLightHandle handle) const {
+        return m_DirectionalLightHandles.Get(handle);
+    }
+    PointLight* GetPointLight(PointLightHandle handle) const { return m_PointLightHandles.Get(handle); }
+    SpotLight* GetSpotLight(SpotLightHandle handle) const { return m_SpotLightHandles.Get(handle); }
+
     unsigned int GetVertexCount() const { return m_VertexCount; }
     unsigned int GetTriangleCount() const { return m_TriangleCount; }
 
@@ -70,6 +95,12 @@ public:
 
     std::unordered_map<std::string, GameObject*> GetGameObjectMap() { return m_GameObjectMap; };
 
+    // components of the game objects, see Core/components.h
+    EntityRegistry& GetRegistry() { return m_Registry; }
+
+    // the renderables' world bounds, refitted by Update
+    SceneBVH& GetBVH() { return *m_BVH; }
+
     void CreateFBO();
     void UseFBO();
     bool HasFBO();
@@ -77,7 +108,6 @@ public:
 
 private:
     void UpdateAnimation(float deltaTime);
-    void UpdateHierarchy(Transform* xform);
 
     void LoadModel(std::unordered_map<std::string, Model*>* m_ModelMap, ModelDesc& modelDesc);
 
@@ -90,9 +120,15 @@ private:
     void CreateSkybox(const SkyboxDesc& skyboxDesc);
     void CreateAnimations(const AnimationRefDesc& animationRefDesc);
     void CreateCharacterAnimations(const std::vector<CharacterAnimationRefDesc>& desc);
+    void CreateBlendTrees(const std::vector<BlendTreeDesc>& desc);
 
     void CreateHierarchy(Transform* xform);
 
+    // creates the game object's entity and handle and the components for what it has
+    void RegisterGameObject(GameObject* go);
+    // gives the loaded models and shaders their handles and resolves the models' shader names
+    void RegisterResources();
+
 private:
     std::vector<HANDLE> modelThreadHandles;
 
@@ -122,6 +158,18 @@ private:
     Transform* m_RootTransform;
     GameObject* m_RootGameObject;  // root transform must belong to a game object
 
+    std::unique_ptr<TransformHierarchy> m_TransformHierarchy;
+    std::unique_ptr<SceneBVH> m_BVH;
+
+    EntityRegistry m_Registry;
+
+    HandleTable<GameObject> m_GameObjectHandles;
+    HandleTable<Model> m_ModelHandles;
+    HandleTable<Shader> m_ShaderHandles;
+    HandleTable<DirectionalLight> m_DirectionalLightHandles;
+    HandleTable<PointLight> m_PointLightHandles;
+    HandleTable<SpotLight> m_SpotLightHandles;
+
     std::unique_ptr<AnimationSystem> m_AnimationSystemPtr;
 
     std::vector<std::future<void>> m_Futures;
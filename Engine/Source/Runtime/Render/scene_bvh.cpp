@@ -0,0 +1,236 @@
+#include "scene_bvh.h"
+
+#include <algorithm>
+#include <cfloat>
+
+#include "frustum.h"
+#include "model.h"
+#include "Core/game_object.h"
+#include "Core/components.h"
+#include "Core/entity_registry.h"
+
+namespace gdp1 {
+
+const float SceneBVH::REBUILD_GROWTH = 2.0f;
+
+struct SceneBVH::BuildItem {
+    GameObject* object;
+    glm::vec3 min;
+    glm::vec3 max;
+    glm::vec3 centroid;
+};
+
+namespace {
+
+void GetWorldBounds(GameObject* go, glm::vec3& min, glm::vec3& max) {
+    Bounds bounds = go->model->bounds;
+    bounds.TransformBounds(go->transform->WorldMatrix());
+
+    min = bounds.GetMin();
+    max = bounds.GetMax();
+}
+
+}  // namespace
+
+float SceneBVH::HalfArea(const glm::vec3& min, const glm::vec3& max) {
+    glm::vec3 size = max - min;
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+void SceneBVH::Build(EntityRegistry& registry) {
+    std::vector<BuildItem> items;
+    items.reserve(registry.GetPool<RenderableComponent>().Size());
+
+    registry.Each<RenderableComponent>([&items](Entity entity, RenderableComponent& renderable) {
+        BuildItem item;
+        item.object = renderable.object;
+        GetWorldBounds(item.object, item.min, item.max);
+        item.centroid = (item.min + item.max) * 0.5f;
+        items.push_back(item);
+    });
+
+    m_Nodes.clear();
+    if (!items.empty()) {
+        m_Nodes.push_back(Node());
+        BuildNode(0, items, 0, static_cast<uint32_t>(items.size()));
+    }
+
+    // the build reordered the items, every subtree is a contiguous range now
+    size_t count = items.size();
+    m_Objects.resize(count);
+    m_CenterX.resize(count);
+    m_CenterY.resize(count);
+    m_CenterZ.resize(count);
+    m_ExtentX.resize(count);
+    m_ExtentY.resize(count);
+    m_ExtentZ.resize(count);
+    m_DynamicObjects.clear();
+    for (size_t i = 0; i < count; i++) {
+        m_Objects[i] = items[i].object;
+        SetObjectBounds(static_cast<uint32_t>(i), items[i].min, items[i].max);
+        if (!items[i].object->isStatic) m_DynamicObjects.push_back(static_cast<uint32_t>(i));
+    }
+
+    m_LastRejectPlane.assign(m_Nodes.size(), 0);
+
+    m_BuiltArea = 0.0f;
+    for (const Node& node : m_Nodes) {
+        m_BuiltArea += HalfArea(node.min, node.max);
+    }
+
+    m_NeedsRebuild = false;
+}
+
+void SceneBVH::BuildNode(uint32_t index, std::vector<BuildItem>& items, uint32_t first, uint32_t count) {
+    glm::vec3 min = items[first].min;
+    glm::vec3 max = items[first].max;
+    glm::vec3 centroidMin = items[first].centroid;
+    glm::vec3 centroidMax = items[first].centroid;
+    for (uint32_t i = first + 1; i < first + count; i++) {
+        min = glm::min(min, items[i].min);
+        max = glm::max(max, items[i].max);
+        centroidMin = glm::min(centroidMin, items[i].centroid);
+        centroidMax = glm::max(centroidMax, items[i].centroid);
+    }
+
+    m_Nodes[index].min = min;
+    m_Nodes[index].max = max;
+    m_Nodes[index].first = first;
+    m_Nodes[index].count = count;
+    m_Nodes[index].left = 0;
+
+    if (count <= MAX_LEAF_SIZE) return;
+
+    // median split along the longest axis of the centroids, gives a balanced tree at O(n log n)
+    glm::vec3 extent = centroidMax - centroidMin;
+    int axis = 0;
+    if (extent.y > extent.x) axis = 1;
+    if (extent.z > extent[axis]) axis = 2;
+
+    uint32_t half = count / 2;
+    std::nth_element(items.begin() + first, items.begin() + first + half, items.begin() + first + count,
+                     [axis](const BuildItem& a, const BuildItem& b) { return a.centroid[axis] < b.centroid[axis]; });
+
+    uint32_t left = static_cast<uint32_t>(m_Nodes.size());
+    m_Nodes.push_back(Node());
+    m_Nodes.push_back(Node());
+    m_Nodes[index].left = left;
+
+    BuildNode(left, items, first, half);
+    BuildNode(left + 1, items, first + half, count - half);
+}
+
+void SceneBVH::SetObjectBounds(uint32_t object, const glm::vec3& min, const glm::vec3& max) {
+    glm::vec3 center = (min + max) * 0.5f;
+    glm::vec3 extents = (max - min) * 0.5f;
+
+    m_CenterX[object] = center.x;
+    m_CenterY[object] = center.y;
+    m_CenterZ[object] = center.z;
+    m_ExtentX[object] = extents.x;
+    m_ExtentY[object] = extents.y;
+    m_ExtentZ[object] = extents.z;
+}
+
+float SceneBVH::Refit() {
+    float area = 0.0f;
+
+    // children come after their parents, so walking backwards finishes them first
+    for (size_t i = m_Nodes.size(); i-- > 0;) {
+        Node& node = m_Nodes[i];
+
+        if (node.left == 0) {
+            node.min = glm::vec3(FLT_MAX);
+            node.max = glm::vec3(-FLT_MAX);
+            for (uint32_t object = node.first; object < node.first + node.count; object++) {
+                glm::vec3 center(m_CenterX[object], m_CenterY[object], m_CenterZ[object]);
+                glm::vec3 extents(m_ExtentX[object], m_ExtentY[object], m_ExtentZ[object]);
+                node.min = glm::min(node.min, center - extents);
+                node.max = glm::max(node.max, center + extents);
+            }
+        } else {
+            const Node& left = m_Nodes[node.left];
+            const Node& right = m_Nodes[node.left + 1];
+            node.min = glm::min(left.min, right.min);
+            node.max = glm::max(left.max, right.max);
+        }
+
+        area += HalfArea(node.min, node.max);
+    }
+
+    return area;
+}
+
+void SceneBVH::Update(EntityRegistry& registry) {
+    if (m_NeedsRebuild) {
+        Build(registry);
+        return;
+    }
+
+    if (m_DynamicObjects.empty()) return;
+
+    for (uint32_t object : m_DynamicObjects) {
+        glm::vec3 min, max;
+        GetWorldBounds(m_Objects[object], min, max);
+        SetObjectBounds(object, min, max);
+    }
+
+    // objects that moved apart leave large overlapping nodes behind, start over once the tree is too loose
+    if (Refit() > m_BuiltArea * REBUILD_GROWTH) Build(registry);
+}
+
+void SceneBVH::AcceptSubtree(const Node& node, std::vector<uint32_t>& visible) const {
+    for (uint32_t object = node.first; object < node.first + node.count; object++) {
+        if (m_Objects[object]->visible) visible.push_back(object);
+    }
+}
+
+void SceneBVH::Cull(const Frustum& frustum, std::vector<uint32_t>& visible) {
+    visible.clear();
+    m_NumVisited = 0;
+
+    if (m_Nodes.empty()) return;
+
+    // a stack entry is the node index and the mask of planes it still straddles
+    m_Stack.clear();
+    m_Stack.push_back(Frustum::ALL_PLANES);
+
+    while (!m_Stack.empty()) {
+        uint32_t entry = m_Stack.back();
+        m_Stack.pop_back();
+
+        uint32_t index = entry >> 6;
+        unsigned int mask = entry & Frustum::ALL_PLANES;
+        const Node& node = m_Nodes[index];
+        m_NumVisited++;
+
+        int lastPlane = m_LastRejectPlane[index];
+        int result = frustum.ClassifyBox(node.min, node.max, mask, lastPlane);
+        if (result < 0) {
+            m_LastRejectPlane[index] = static_cast<unsigned char>(lastPlane);
+            continue;
+        }
+
+        if (mask == 0) {
+            AcceptSubtree(node, visible);
+            continue;
+        }
+
+        if (node.left == 0) {
+            // the leaf box straddles a plane, its objects are tested on their own against the planes left
+            uint32_t first = node.first;
+            frustum.CullBoxes(&m_CenterX[first], &m_CenterY[first], &m_CenterZ[first], &m_ExtentX[first],
+                              &m_ExtentY[first], &m_ExtentZ[first], node.count, m_LeafVisible, mask);
+
+            for (uint32_t i = 0; i < node.count; i++) {
+                if (m_LeafVisible[i] && m_Objects[first + i]->visible) visible.push_back(first + i);
+            }
+            continue;
+        }
+
+        m_Stack.push_back(((node.left + 1) << 6) | mask);
+        m_Stack.push_back((node.left << 6) | mask);
+    }
+}
+
+}  // namespace gdp1
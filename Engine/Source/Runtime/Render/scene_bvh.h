@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace gdp1 {
+
+class GameObject;
+class Frustum;
+class EntityRegistry;
+
+// A bounding volume hierarchy over the world bounds of the scene's renderable objects, for frustum culling.
+// Nodes are tested against the frustum planes their parent straddles only: a node inside a plane passes that plane
+// on to its children as accepted, and a node inside all of them accepts its whole subtree without further tests.
+// Each node also remembers the plane that rejected it last, which usually rejects it again the next frame.
+// Leaves on the frustum's border test their objects with the batched SSE kernel, the object bounds are kept as
+// center and extents arrays for it.
+// Moving objects are refitted every frame, the tree is rebuilt when objects are added or refitting has let it grow
+// too loose.
+class SceneBVH {
+public:
+    // The set of renderables changed, the tree is rebuilt on the next Update.
+    void Invalidate() { m_NeedsRebuild = true; }
+
+    // Refits the bounds of the objects that are not static, call after the world matrices are updated.
+    void Update(EntityRegistry& registry);
+
+    // Writes the indices of the visible objects to visible, see GetGameObject. The vector is cleared but keeps its
+    // capacity, so it does not allocate once it has grown to the scene size.
+    void Cull(const Frustum& frustum, std::vector<uint32_t>& visible);
+
+    GameObject* GetGameObject(uint32_t index) const { return m_Objects[index]; }
+    unsigned int GetObjectCount() const { return static_cast<unsigned int>(m_Objects.size()); }
+    unsigned int GetNodeCount() const { return static_cast<unsigned int>(m_Nodes.size()); }
+    // nodes tested by the last Cull
+    unsigned int GetVisitedCount() const { return m_NumVisited; }
+
+private:
+    struct Node {
+        glm::vec3 min;
+        uint32_t first;  // first object of the subtree
+        glm::vec3 max;
+        uint32_t count;  // objects in the subtree
+        uint32_t left;   // first of the two children, which are adjacent, 0 for leaves
+    };
+
+    struct BuildItem;
+
+    void Build(EntityRegistry& registry);
+    void BuildNode(uint32_t index, std::vector<BuildItem>& items, uint32_t first, uint32_t count);
+
+    void SetObjectBounds(uint32_t object, const glm::vec3& min, const glm::vec3& max);
+    // recomputes the node bounds bottom up and returns the summed area of all nodes
+    float Refit();
+
+    void AcceptSubtree(const Node& node, std::vector<uint32_t>& visible) const;
+
+    static float HalfArea(const glm::vec3& min, const glm::vec3& max);
+
+private:
+    // leaves hold at most this many objects, one iteration of Frustum::CullBoxes
+    static const uint32_t MAX_LEAF_SIZE = 8;
+    // the tree is rebuilt once its summed node area has grown this much since the last build
+    static const float REBUILD_GROWTH;
+
+    bool m_NeedsRebuild = true;
+    float m_BuiltArea = 0.0f;  // summed node area right after the last build
+
+    // per object, sorted so every subtree covers a contiguous range
+    std::vector<GameObject*> m_Objects;
+    std::vector<float> m_CenterX, m_CenterY, m_CenterZ;
+    std::vector<float> m_ExtentX, m_ExtentY, m_ExtentZ;
+    std::vector<uint32_t> m_DynamicObjects;
+
+    // children come after their parent
+    std::vector<Node> m_Nodes;
+    std::vector<unsigned char> m_LastRejectPlane;
+
+    // traversal stack of node index and the planes still to test
+    std::vector<uint32_t> m_Stack;
+    unsigned char m_LeafVisible[MAX_LEAF_SIZE];
+
+    unsigned int m_NumVisited = 0;
+};
+
+}  // namespace gdp1
@@ -2,6 +2,7 @@
 #include "shader.h"
 
 #include "Utils/glutils.h"
+#include "Core/application.h"
 
 #include <fstream>
 
@@ -437,7 +438,12 @@ bool Shader::FileExists(const string& fileName) {
     return 0 == ret;
 }
 
+bool Shader::HasUniform(const std::string& name) { return GetUniformLocation(name) >= 0; }
+
 int Shader::GetUniformLocation(const std::string& name) {
+    // every SetUniform goes through here exactly once
+    Application::uniformCalls++;
+
     auto pos = m_UniformLocations.find(name);
 
     if (pos == m_UniformLocations.end()) {
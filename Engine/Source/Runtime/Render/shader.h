@@ -6,6 +6,7 @@
 #endif
 
 #include "common.h"
+#include "Core/handle.h"
 #include <stdexcept>
 #include <glad/glad.h>
 
@@ -55,6 +56,8 @@ public:
 
     int GetHandle();
     bool IsLinked();
+    // whether the linked program has an active uniform of that name
+    bool HasUniform(const std::string& name);
 
     void BindAttribLocation(GLuint location, const char* name);
     void BindFragDataLocation(GLuint location, const char* name);
@@ -90,4 +93,6 @@ public:
     const char* GetTypeString(GLenum type);
 };
 
+typedef Handle<Shader> ShaderHandle;
+
 }  // namespace gdp1
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace gdp1 {
+
+// Binding points of the uniform blocks all programs share, the FrameData and LightData blocks in the shaders.
+const unsigned int FRAME_UNIFORM_BINDING = 0;
+const unsigned int LIGHT_UNIFORM_BINDING = 1;
+
+// Binding points of the storage buffers of the clustered lights, the PointLights, LightClusters and LightIndices
+// blocks in lit.frag.glsl. 0 and 1 are the bone palette and the instance matrices.
+const unsigned int POINT_LIGHT_STORAGE_BINDING = 2;
+const unsigned int LIGHT_CLUSTER_STORAGE_BINDING = 3;
+const unsigned int LIGHT_INDEX_STORAGE_BINDING = 4;
+
+// The structs below mirror the std140 layout of the blocks, members are padded by hand to their GLSL offsets.
+
+// FrameData, camera matrices of the frame
+struct FrameUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::vec4 normalMatrix[3];  // a mat3 takes three vec4 columns
+    glm::vec4 cameraPosition;   // world space, w unused
+};
+
+// DirectionalLight in LightData, in view space
+struct DirectionalLightUniforms {
+    glm::vec3 direction;
+    float pad0;
+    glm::vec4 color;
+    float intensity;
+    float pad1[3];
+};
+
+// an element of PointLights, in view space. std430 lays it out the same as std140.
+struct PointLightUniforms {
+    glm::vec3 position;
+    float pad0;
+    glm::vec4 color;
+    float intensity;
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+// LightData, the sun and how to find the point lights of a fragment's cluster
+struct LightUniforms {
+    DirectionalLightUniforms dirLight;
+    int numPointLights;
+    int pad[3];
+    glm::ivec4 clusterGrid;  // tiles x, tiles y, depth slices, w unused
+    glm::vec4 clusterScale;  // viewport width, height, slice scale, slice bias
+};
+
+static_assert(sizeof(FrameUniforms) == 256, "FrameUniforms does not match the std140 layout of FrameData");
+static_assert(sizeof(DirectionalLightUniforms) == 48, "DirectionalLightUniforms does not match std140");
+static_assert(sizeof(PointLightUniforms) == 48, "PointLightUniforms does not match std140");
+static_assert(sizeof(LightUniforms) == 96, "LightUniforms does not match std140");
+
+}  // namespace gdp1
@@ -109,10 +109,13 @@ void from_json(const json& j, ModelDesc& modelDesc) {
     j.at("filepath").get_to(modelDesc.filepath);
     j.at("shader").get_to(modelDesc.shader);
     j.at("textures").get_to(modelDesc.textures);
+    modelDesc.lodLevels = j.value("lodLevels", 1u);
+    modelDesc.lodReduction = j.value("lodReduction", 0.5f);
 }
 
 void to_json(json& j, const ModelDesc& modelDesc) {
-    j = {{"name", modelDesc.name}, {"filepath", modelDesc.filepath}, {"shader", modelDesc.shader}, {"textures", modelDesc.textures}};
+    j = {{"name", modelDesc.name}, {"filepath", modelDesc.filepath}, {"shader", modelDesc.shader}, {"textures", modelDesc.textures},
+         {"lodLevels", modelDesc.lodLevels}, {"lodReduction", modelDesc.lodReduction}};
 }
 
 // for AnimationDesc
@@ -246,6 +249,7 @@ void from_json(const json& j, GameObjectDesc& goDesc) {
     goDesc.hasFBO = j.value("hasFBO", false);
     goDesc.setLit = j.value("setLit", false);
     goDesc.isStatic = j.value("isStatic", true);
+    goDesc.isOccluder = j.value("isOccluder", false);
 }
 
 void to_json(json& j, const GameObjectDesc& goDesc) {
@@ -257,6 +261,7 @@ void to_json(json& j, const GameObjectDesc& goDesc) {
          {"parent", goDesc.parentName},
          {"setLit", goDesc.setLit},       
          {"isStatic", goDesc.isStatic},
+         {"isOccluder", goDesc.isOccluder},
          {"hasFBO", goDesc.hasFBO}};
 }
 
@@ -271,6 +276,33 @@ void to_json(json& j, const CharacterAnimationRefDesc& animDesc) {
     j = {{"name", animDesc.name}, {"path", animDesc.path}, {"model", animDesc.model}};
 }
 
+// for BlendTree Desc
+void from_json(const json& j, BlendNodeDesc& nodeDesc) {
+    nodeDesc.type = j.value("type", "clip");
+    nodeDesc.clip = j.value("clip", "");
+    nodeDesc.parameter = j.value("parameter", "");
+    nodeDesc.children = j.value("children", std::vector<int>());
+    nodeDesc.thresholds = j.value("thresholds", std::vector<float>());
+    nodeDesc.mask = j.value("mask", "");
+}
+
+void to_json(json& j, const BlendNodeDesc& nodeDesc) {
+    j = {{"type", nodeDesc.type},         {"clip", nodeDesc.clip},
+         {"parameter", nodeDesc.parameter}, {"children", nodeDesc.children},
+         {"thresholds", nodeDesc.thresholds}, {"mask", nodeDesc.mask}};
+}
+
+void from_json(const json& j, BlendTreeDesc& treeDesc) {
+    j.at("name").get_to(treeDesc.name);
+    j.at("model").get_to(treeDesc.model);
+    treeDesc.root = j.value("root", 0);
+    j.at("nodes").get_to(treeDesc.nodes);
+}
+
+void to_json(json& j, const BlendTreeDesc& treeDesc) {
+    j = {{"name", treeDesc.name}, {"model", treeDesc.model}, {"root", treeDesc.root}, {"nodes", treeDesc.nodes}};
+}
+
 // for LevelDesc
 void from_json(const json& j, LevelDesc& lvlDesc) {
     j.at("name").get_to(lvlDesc.name);
@@ -286,6 +318,7 @@ void from_json(const json& j, LevelDesc& lvlDesc) {
     j.at("softbodies").get_to(lvlDesc.softbodyDescs);
     j.at("animation").get_to(lvlDesc.animationRefDesc);
     j.at("character_animations").get_to(lvlDesc.characterAnimationRefDescs);
+    lvlDesc.blendTreeDescs = j.value("blend_trees", std::vector<BlendTreeDesc>());
     j.at("audioSources").get_to(lvlDesc.audioSourceDescs);
     j.at("skybox").get_to(lvlDesc.skyboxDesc);
 }
@@ -303,6 +336,7 @@ void to_json(json& j, const LevelDesc& lvlDesc) {
          {"rigidbodies", lvlDesc.rigidbodyDescs},
          {"animation", lvlDesc.animationRefDesc},
          {"character_animations", lvlDesc.characterAnimationRefDescs},
+         {"blend_trees", lvlDesc.blendTreeDescs},
          {"audioSources", lvlDesc.audioSourceDescs},
          {"skybox", lvlDesc.skyboxDesc}};
 }
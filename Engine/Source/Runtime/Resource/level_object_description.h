@@ -56,6 +56,7 @@ struct GameObjectDesc {
     bool hasFBO = false;
     bool setLit = false;
     bool isStatic = true;
+    bool isOccluder = false;
 };
 
 // Textures description
@@ -71,6 +72,8 @@ struct ModelDesc {
     std::string filepath;
     std::string shader;
     std::vector<TexturesDesc> textures;
+    unsigned int lodLevels = 1;  // including the loaded one, the others are generated when the model loads
+    float lodReduction = 0.5f;   // triangles of a level relative to the one before
 };
 
 // AnimationReference description
@@ -85,6 +88,24 @@ struct CharacterAnimationRefDesc {
     std::string model;
 };
 
+// BlendTree node description, see BlendNode
+struct BlendNodeDesc {
+    std::string type;  // "clip", "blend1d", "additive" or "layer"
+    std::string clip;
+    std::string parameter;
+    std::vector<int> children;  // indices into BlendTreeDesc::nodes
+    std::vector<float> thresholds;
+    std::string mask;  // layer: root node of the masked part of the skeleton
+};
+
+// BlendTree description
+struct BlendTreeDesc {
+    std::string name;
+    std::string model;
+    int root;
+    std::vector<BlendNodeDesc> nodes;
+};
+
 // AudioSource description
 struct AudioSourceDesc {
     std::string name;
@@ -123,6 +144,7 @@ struct LevelDesc {
     std::vector<SoftbodyDesc> softbodyDescs;
     std::vector<AudioSourceDesc> audioSourceDescs;
     std::vector<CharacterAnimationRefDesc> characterAnimationRefDescs;
+    std::vector<BlendTreeDesc> blendTreeDescs;
     AnimationRefDesc animationRefDesc;
     SkyboxDesc skyboxDesc;
 };
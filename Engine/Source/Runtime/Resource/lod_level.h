@@ -6,14 +6,17 @@
 
 namespace gdp1 {
 
+// One level of detail of a model, every submesh of the model at that detail.
 class LODLevel {
 public:
-    LODLevel(int lod_index, Mesh* mesh)
+    LODLevel(int lod_index, const std::vector<Mesh*>& meshes, float error)
         : lod_index(lod_index)
-        , mesh(mesh) {}
+        , meshes(meshes)
+        , error(error) {}
 
     int lod_index;
-    Mesh* mesh;
+    std::vector<Mesh*> meshes;  // in the order of Model::meshes
+    float error;                // how far the surface moved from the full detail one, in model space
 };
 
-}  // namespace gdp1
\ No newline at end of file
+}  // namespace gdp1
@@ -1,29 +1,55 @@
 #include "lod_system.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include <Core/game_object.h>
+#include <Core/job_system.h>
 #include <Render/model.h>
-#include <Utils/camera.h>
 
 using namespace std;
 
 namespace gdp1 {
 
-void LODSystem::Update(shared_ptr<Camera> camera, unordered_map<string, GameObject*>& gameObjects) {
-#pragma omp parallel for
-    for (unordered_map<string, GameObject*>::iterator it = gameObjects.begin(); it != gameObjects.end(); it++) {
-        Model* model = it->second->model;
-        if (model->lodLevels.size() <= 1) {
-            model->currentLODLevel = 0;
-            continue;
-        }
+void LODSystem::Update(const glm::vec3& eye, const glm::mat4& projection, float viewportHeight,
+                       const vector<GameObject*>& gameObjects) {
+    // a unit long object one unit in front of the camera covers this many pixels
+    float pixelsPerUnit = fabsf(projection[1][1]) * viewportHeight * 0.5f;
+
+    // every object only writes its own level
+    JobSystem::ParallelFor((unsigned int)gameObjects.size(), 64, [&](unsigned int begin, unsigned int end) {
+        for (unsigned int i = begin; i < end; i++) {
+            GameObject* go = gameObjects[i];
+            const vector<LODLevel>& levels = go->model->lodLevels;
+            if (levels.size() <= 1) {
+                go->lodLevel = 0;
+                continue;
+            }
+
+            // the distance to the closest point of the world space bounding sphere
+            const glm::mat4& world = go->transform->WorldMatrix();
+            const Bounds& bounds = go->model->bounds;
+            float scale = max(glm::length(glm::vec3(world[0])),
+                              max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+            glm::vec3 center = glm::vec3(world * glm::vec4(bounds.GetCenter(), 1.0f));
+            float radius = glm::length(bounds.GetExtents()) * scale;
+            float distance = max(glm::length(center - eye) - radius, 1e-3f);
 
-        float distance = glm::length(camera->GetEye() - it->second->transform->localPosition);
-        if (distance >= 0.f && distance <= 20.0f) {
-            model->currentLODLevel = 0;
-        } else {
-            model->currentLODLevel = 1;
+            // pixels per unit of model space error at that distance
+            go->lodLevel = SelectLevel(levels, go->lodLevel, pixelsPerUnit * scale / distance);
         }
-    }
-};
+    });
+}
+
+unsigned int LODSystem::SelectLevel(const vector<LODLevel>& levels, unsigned int current, float errorScale) const {
+    if (levels.empty()) return 0;
+
+    float coarserError = maxScreenError * (1.0f - hysteresis);
+
+    unsigned int level = min(current, (unsigned int)levels.size() - 1);
+    while (level > 0 && levels[level].error * errorScale > maxScreenError) level--;
+    while (level + 1 < levels.size() && levels[level + 1].error * errorScale < coarserError) level++;
+    return level;
+}
 
-}  // namespace gdp1
\ No newline at end of file
+}  // namespace gdp1
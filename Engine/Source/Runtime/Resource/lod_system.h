@@ -1,20 +1,31 @@
 #pragma once
 
-#include <string>
 #include <vector>
-#include <unordered_map>
-#include <memory>
+
+#include <glm/glm.hpp>
+
+#include "lod_level.h"
 
 namespace gdp1 {
 
 class GameObject;
-class Camera;
 
+// Picks the level of detail of every visible game object from the error it would show on screen.
+// A level is good enough while its model space error, scaled to the object and projected at its distance, stays under
+// maxScreenError pixels. Each object keeps its own level, so instances of one model can differ. A coarser level is
+// only taken once its error is well under the limit, so objects near the threshold do not switch every frame.
 class LODSystem {
 public:
     LODSystem() = default;
 
-    void Update(std::shared_ptr<Camera> camera, std::unordered_map<std::string, GameObject*>& gameObjects);
+    void Update(const glm::vec3& eye, const glm::mat4& projection, float viewportHeight,
+                const std::vector<GameObject*>& gameObjects);
+
+    // The level to draw next, starting from current, when a unit of model space error covers errorScale pixels.
+    unsigned int SelectLevel(const std::vector<LODLevel>& levels, unsigned int current, float errorScale) const;
+
+    float maxScreenError = 1.0f;  // pixels
+    float hysteresis = 0.25f;     // fraction of maxScreenError a coarser level must stay under to be taken
 };
 
-}  // namespace gdp1
\ No newline at end of file
+}  // namespace gdp1
@@ -0,0 +1,431 @@
+#include "mesh_simplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+
+namespace gdp1 {
+
+namespace {
+
+// borders weigh this much more than the surface around them, so they are the last thing to move
+const double BORDER_WEIGHT = 10.0;
+// a collapse may not turn a remaining triangle further than this, cosine of the angle between the old and new normal
+const double MIN_NORMAL_DOT = 0.2;
+
+// Sum of squared distances to a set of weighted planes, the upper triangle of a symmetric 4x4 matrix.
+struct Quadric {
+    double a2, ab, ac, ad;
+    double b2, bc, bd;
+    double c2, cd;
+    double d2;
+    double weight;
+};
+
+Quadric MakeQuadric(const glm::dvec3& n, double d, double weight) {
+    Quadric q;
+    q.a2 = n.x * n.x * weight;
+    q.ab = n.x * n.y * weight;
+    q.ac = n.x * n.z * weight;
+    q.ad = n.x * d * weight;
+    q.b2 = n.y * n.y * weight;
+    q.bc = n.y * n.z * weight;
+    q.bd = n.y * d * weight;
+    q.c2 = n.z * n.z * weight;
+    q.cd = n.z * d * weight;
+    q.d2 = d * d * weight;
+    q.weight = weight;
+    return q;
+}
+
+void AddQuadric(Quadric& q, const Quadric& other) {
+    q.a2 += other.a2;
+    q.ab += other.ab;
+    q.ac += other.ac;
+    q.ad += other.ad;
+    q.b2 += other.b2;
+    q.bc += other.bc;
+    q.bd += other.bd;
+    q.c2 += other.c2;
+    q.cd += other.cd;
+    q.d2 += other.d2;
+    q.weight += other.weight;
+}
+
+double EvaluateQuadric(const Quadric& q, const glm::dvec3& p) {
+    double rx = q.a2 * p.x + q.ab * p.y + q.ac * p.z + q.ad;
+    double ry = q.ab * p.x + q.b2 * p.y + q.bc * p.z + q.bd;
+    double rz = q.ac * p.x + q.bc * p.y + q.c2 * p.z + q.cd;
+    double rw = q.ad * p.x + q.bd * p.y + q.cd * p.z + q.d2;
+    return std::max(0.0, rx * p.x + ry * p.y + rz * p.z + rw);
+}
+
+// the plane of an input triangle, or one standing on a border edge, n.p + d = 0
+struct Plane {
+    glm::dvec3 normal;
+    double d;
+};
+
+// hashes the bits of the position, so -0 and 0, which compare equal, are made the same bits first
+struct PositionHash {
+    size_t operator()(const glm::vec3& p) const {
+        glm::vec3 canonical = p + glm::vec3(0.0f);
+        unsigned int bits[3];
+        memcpy(bits, &canonical, sizeof(bits));
+        return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+    }
+};
+
+// moving the position from onto the position to
+struct Collapse {
+    unsigned int from;
+    unsigned int to;
+    double cost;  // mean squared distance to the planes of both, orders the collapses
+};
+
+// The state of one Simplify call. Collapses work on positions, the vertices at a position (its wedges) follow the
+// collapse onto the vertices they share a triangle with at the target. Besides its quadric every position keeps the
+// planes summed into it, the quadric only gives the mean distance to them and the error bound is on the largest.
+class Simplifier {
+public:
+    Simplifier(const glm::vec3* positions, size_t stride, unsigned int numVertices,
+               const std::vector<unsigned int>& indices)
+        : m_Indices(indices)
+        , m_VertexPosition(numVertices)
+        , m_Remap(numVertices) {
+        // weld the vertices by position
+        std::unordered_map<glm::vec3, unsigned int, PositionHash> welded;
+        const char* position = reinterpret_cast<const char*>(positions);
+        for (unsigned int v = 0; v < numVertices; v++) {
+            const glm::vec3& p = *reinterpret_cast<const glm::vec3*>(position + v * stride);
+            std::pair<std::unordered_map<glm::vec3, unsigned int, PositionHash>::iterator, bool> inserted =
+                welded.insert(std::make_pair(p, (unsigned int)m_Positions.size()));
+            if (inserted.second) m_Positions.push_back(glm::dvec3(p));
+            m_VertexPosition[v] = inserted.first->second;
+            m_Remap[v] = v;
+        }
+
+        RemoveDegenerates();
+        ComputeQuadrics();
+    }
+
+    std::vector<unsigned int> Run(unsigned int targetIndexCount, float maxError, float* error) {
+        double maxCost = (double)maxError * maxError;
+        double largestDistance = 0.0;
+
+        while (m_Indices.size() > targetIndexCount) {
+            BuildAdjacency();
+            CollectCollapses();
+            if (m_Collapses.empty()) break;
+
+            // cheapest first, and only the cheaper part each pass, the rest is reconsidered once the mesh changed
+            std::sort(m_Collapses.begin(), m_Collapses.end(),
+                      [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+            size_t considered = std::max((size_t)1, m_Collapses.size() / 3);
+
+            std::fill(m_Locked.begin(), m_Locked.end(), 0);
+            size_t numTriangles = m_Indices.size() / 3;
+            size_t targetTriangles = targetIndexCount / 3;
+            unsigned int collapsed = 0;
+            for (size_t i = 0; i < considered && numTriangles > targetTriangles; i++) {
+                const Collapse& collapse = m_Collapses[i];
+                // the mean is never above the largest distance, past this every collapse is too far off
+                if (collapse.cost > maxCost) break;
+                if (m_Locked[collapse.from] || m_Locked[collapse.to]) continue;
+
+                double distance = GetMaxDistance(collapse.from, collapse.to);
+                if (distance > maxError) continue;
+
+                numTriangles -= ApplyCollapse(collapse.from, collapse.to);
+                largestDistance = std::max(largestDistance, distance);
+                collapsed++;
+            }
+            if (collapsed == 0) break;
+
+            for (unsigned int& index : m_Indices) {
+                index = m_Remap[index];
+            }
+            RemoveDegenerates();
+        }
+
+        if (error != nullptr) *error = (float)largestDistance;
+        return m_Indices;
+    }
+
+private:
+    unsigned int PositionOf(unsigned int vertex) const { return m_VertexPosition[vertex]; }
+
+    void RemoveDegenerates() {
+        size_t kept = 0;
+        for (size_t i = 0; i + 2 < m_Indices.size(); i += 3) {
+            unsigned int p0 = PositionOf(m_Indices[i]);
+            unsigned int p1 = PositionOf(m_Indices[i + 1]);
+            unsigned int p2 = PositionOf(m_Indices[i + 2]);
+            if (p0 == p1 || p1 == p2 || p0 == p2) continue;
+
+            m_Indices[kept++] = m_Indices[i];
+            m_Indices[kept++] = m_Indices[i + 1];
+            m_Indices[kept++] = m_Indices[i + 2];
+        }
+        m_Indices.resize(kept);
+    }
+
+    void ComputeQuadrics() {
+        m_Quadrics.assign(m_Positions.size(), MakeQuadric(glm::dvec3(0.0), 0.0, 0.0));
+        m_PositionPlanes.assign(m_Positions.size(), std::vector<unsigned int>());
+
+        // the planes of the triangles, weighted by area
+        std::unordered_map<unsigned long long, unsigned int> directedEdges;
+        for (size_t i = 0; i < m_Indices.size(); i += 3) {
+            unsigned int p[3] = {PositionOf(m_Indices[i]), PositionOf(m_Indices[i + 1]), PositionOf(m_Indices[i + 2])};
+            glm::dvec3 normal = glm::cross(m_Positions[p[1]] - m_Positions[p[0]], m_Positions[p[2]] - m_Positions[p[0]]);
+            double length = glm::length(normal);
+            if (length > 0.0) {
+                normal /= length;
+                double d = -glm::dot(normal, m_Positions[p[0]]);
+                Quadric plane = MakeQuadric(normal, d, length * 0.5);
+                for (int k = 0; k < 3; k++) AddQuadric(m_Quadrics[p[k]], plane);
+                AddPlane(normal, d, p, 3);
+            }
+
+            for (int k = 0; k < 3; k++) {
+                directedEdges[EdgeKey(p[k], p[(k + 1) % 3])] = (unsigned int)i;
+            }
+        }
+
+        // an edge only one triangle runs along is on a border, a plane standing on it keeps the border in place
+        for (std::unordered_map<unsigned long long, unsigned int>::const_iterator it = directedEdges.begin();
+             it != directedEdges.end(); it++) {
+            unsigned int from = (unsigned int)(it->first >> 32);
+            unsigned int to = (unsigned int)(it->first & 0xffffffffu);
+            if (directedEdges.find(EdgeKey(to, from)) != directedEdges.end()) continue;
+
+            size_t i = it->second;
+            glm::dvec3 p0 = m_Positions[PositionOf(m_Indices[i])];
+            glm::dvec3 normal = glm::cross(m_Positions[PositionOf(m_Indices[i + 1])] - p0,
+                                           m_Positions[PositionOf(m_Indices[i + 2])] - p0);
+            glm::dvec3 edge = m_Positions[to] - m_Positions[from];
+            glm::dvec3 side = glm::cross(edge, normal);
+            double length = glm::length(side);
+            if (length <= 0.0) continue;
+
+            side /= length;
+            double d = -glm::dot(side, m_Positions[from]);
+            Quadric plane = MakeQuadric(side, d, glm::dot(edge, edge) * BORDER_WEIGHT);
+            AddQuadric(m_Quadrics[from], plane);
+            AddQuadric(m_Quadrics[to], plane);
+            unsigned int ends[2] = {from, to};
+            AddPlane(side, d, ends, 2);
+        }
+
+        m_Locked.assign(m_Positions.size(), 0);
+    }
+
+    void AddPlane(const glm::dvec3& normal, double d, const unsigned int* positions, int count) {
+        Plane plane;
+        plane.normal = normal;
+        plane.d = d;
+        for (int k = 0; k < count; k++) m_PositionPlanes[positions[k]].push_back((unsigned int)m_Planes.size());
+        m_Planes.push_back(plane);
+    }
+
+    // how far the position of to is off the planes of from and to, the worst of them
+    double GetMaxDistance(unsigned int from, unsigned int to) const {
+        const glm::dvec3& p = m_Positions[to];
+        const unsigned int positions[2] = {from, to};
+        double distance = 0.0;
+        for (unsigned int position : positions) {
+            for (unsigned int plane : m_PositionPlanes[position]) {
+                distance = std::max(distance, fabs(glm::dot(m_Planes[plane].normal, p) + m_Planes[plane].d));
+            }
+        }
+        return distance;
+    }
+
+    static unsigned long long EdgeKey(unsigned int from, unsigned int to) {
+        return ((unsigned long long)from << 32) | to;
+    }
+
+    // the triangles around each position, m_TriangleLists[m_TriangleOffsets[p], m_TriangleOffsets[p + 1])
+    void BuildAdjacency() {
+        m_TriangleOffsets.assign(m_Positions.size() + 1, 0);
+        for (unsigned int index : m_Indices) {
+            m_TriangleOffsets[PositionOf(index) + 1]++;
+        }
+        for (size_t p = 0; p < m_Positions.size(); p++) {
+            m_TriangleOffsets[p + 1] += m_TriangleOffsets[p];
+        }
+
+        m_TriangleLists.resize(m_Indices.size());
+        m_Fill.assign(m_TriangleOffsets.begin(), m_TriangleOffsets.end() - 1);
+        for (size_t i = 0; i < m_Indices.size(); i++) {
+            m_TriangleLists[m_Fill[PositionOf(m_Indices[i])]++] = (unsigned int)(i / 3);
+        }
+    }
+
+    void CollectCollapses() {
+        m_Edges.clear();
+        for (size_t i = 0; i < m_Indices.size(); i += 3) {
+            for (int k = 0; k < 3; k++) {
+                unsigned int a = PositionOf(m_Indices[i + k]);
+                unsigned int b = PositionOf(m_Indices[i + (k + 1) % 3]);
+                m_Edges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+            }
+        }
+        std::sort(m_Edges.begin(), m_Edges.end());
+        m_Edges.erase(std::unique(m_Edges.begin(), m_Edges.end()), m_Edges.end());
+
+        m_Collapses.clear();
+        for (const std::pair<unsigned int, unsigned int>& edge : m_Edges) {
+            Collapse best;
+            best.cost = -1.0;
+            for (int direction = 0; direction < 2; direction++) {
+                unsigned int from = direction == 0 ? edge.first : edge.second;
+                unsigned int to = direction == 0 ? edge.second : edge.first;
+
+                Quadric quadric = m_Quadrics[from];
+                AddQuadric(quadric, m_Quadrics[to]);
+                double cost = quadric.weight > 0.0 ? EvaluateQuadric(quadric, m_Positions[to]) / quadric.weight : 0.0;
+                if (best.cost >= 0.0 && cost >= best.cost) continue;
+                if (!CanCollapse(from, to)) continue;
+
+                best.from = from;
+                best.to = to;
+                best.cost = cost;
+            }
+            if (best.cost >= 0.0) m_Collapses.push_back(best);
+        }
+    }
+
+    // pairs every vertex at from with the vertex at to it shares a triangle with, false if one has none
+    bool PairWedges(unsigned int from, unsigned int to) {
+        m_WedgePairs.clear();
+        for (unsigned int t = m_TriangleOffsets[from]; t < m_TriangleOffsets[from + 1]; t++) {
+            const unsigned int* corners = &m_Indices[m_TriangleLists[t] * 3];
+            unsigned int fromVertex = 0, toVertex = 0;
+            bool hasTo = false;
+            for (int k = 0; k < 3; k++) {
+                if (PositionOf(corners[k]) == from) fromVertex = corners[k];
+                if (PositionOf(corners[k]) == to) {
+                    toVertex = corners[k];
+                    hasTo = true;
+                }
+            }
+            if (hasTo) m_WedgePairs.push_back(std::make_pair(fromVertex, toVertex));
+        }
+
+        for (unsigned int t = m_TriangleOffsets[from]; t < m_TriangleOffsets[from + 1]; t++) {
+            const unsigned int* corners = &m_Indices[m_TriangleLists[t] * 3];
+            for (int k = 0; k < 3; k++) {
+                if (PositionOf(corners[k]) != from) continue;
+
+                bool paired = false;
+                for (const std::pair<unsigned int, unsigned int>& pair : m_WedgePairs) {
+                    if (pair.first == corners[k]) paired = true;
+                }
+                if (!paired) return false;
+            }
+        }
+        return true;
+    }
+
+    bool CanCollapse(unsigned int from, unsigned int to) {
+        if (!PairWedges(from, to)) return false;
+
+        // the triangles that stay may not flip or fold over
+        for (unsigned int t = m_TriangleOffsets[from]; t < m_TriangleOffsets[from + 1]; t++) {
+            const unsigned int* corners = &m_Indices[m_TriangleLists[t] * 3];
+            glm::dvec3 before[3], after[3];
+            bool removed = false;
+            for (int k = 0; k < 3; k++) {
+                unsigned int p = PositionOf(corners[k]);
+                if (p == to) removed = true;
+                before[k] = m_Positions[p];
+                after[k] = p == from ? m_Positions[to] : before[k];
+            }
+            if (removed) continue;
+
+            glm::dvec3 n0 = glm::cross(before[1] - before[0], before[2] - before[0]);
+            glm::dvec3 n1 = glm::cross(after[1] - after[0], after[2] - after[0]);
+            double lengths = glm::length(n0) * glm::length(n1);
+            if (lengths <= 0.0 || glm::dot(n0, n1) < MIN_NORMAL_DOT * lengths) return false;
+        }
+        return true;
+    }
+
+    // returns the number of triangles the collapse removes
+    unsigned int ApplyCollapse(unsigned int from, unsigned int to) {
+        PairWedges(from, to);
+        for (const std::pair<unsigned int, unsigned int>& pair : m_WedgePairs) {
+            m_Remap[pair.first] = pair.second;
+        }
+
+        AddQuadric(m_Quadrics[to], m_Quadrics[from]);
+
+        // the planes of from move over to to, each once
+        std::vector<unsigned int>& planes = m_PositionPlanes[to];
+        planes.insert(planes.end(), m_PositionPlanes[from].begin(), m_PositionPlanes[from].end());
+        std::sort(planes.begin(), planes.end());
+        planes.erase(std::unique(planes.begin(), planes.end()), planes.end());
+        std::vector<unsigned int>().swap(m_PositionPlanes[from]);
+
+        // the triangles around from were checked against their current corners, none of them may move this pass
+        m_Locked[from] = 1;
+        m_Locked[to] = 1;
+        for (unsigned int t = m_TriangleOffsets[from]; t < m_TriangleOffsets[from + 1]; t++) {
+            const unsigned int* corners = &m_Indices[m_TriangleLists[t] * 3];
+            for (int k = 0; k < 3; k++) m_Locked[PositionOf(corners[k])] = 1;
+        }
+
+        return (unsigned int)m_WedgePairs.size();
+    }
+
+private:
+    std::vector<unsigned int> m_Indices;
+    std::vector<glm::dvec3> m_Positions;
+    std::vector<unsigned int> m_VertexPosition;
+    std::vector<unsigned int> m_Remap;
+    std::vector<Quadric> m_Quadrics;
+    std::vector<Plane> m_Planes;
+    std::vector<std::vector<unsigned int>> m_PositionPlanes;
+    std::vector<unsigned char> m_Locked;
+
+    std::vector<unsigned int> m_TriangleOffsets;
+    std::vector<unsigned int> m_TriangleLists;
+    std::vector<unsigned int> m_Fill;
+
+    std::vector<std::pair<unsigned int, unsigned int>> m_Edges;
+    std::vector<Collapse> m_Collapses;
+    std::vector<std::pair<unsigned int, unsigned int>> m_WedgePairs;
+};
+
+}  // namespace
+
+std::vector<unsigned int> MeshSimplifier::Simplify(const glm::vec3* positions, size_t stride, unsigned int numVertices,
+                                                   const std::vector<unsigned int>& indices,
+                                                   unsigned int targetIndexCount, float maxError, float* error) {
+    if (error != nullptr) *error = 0.0f;
+    if (indices.size() < 3 || numVertices == 0) return indices;
+
+    Simplifier simplifier(positions, stride, numVertices, indices);
+    return simplifier.Run(targetIndexCount, maxError, error);
+}
+
+void MeshSimplifier::CompactVertices(std::vector<unsigned int>& indices, unsigned int numVertices,
+                                     std::vector<unsigned int>& remap) {
+    const unsigned int UNUSED = ~0u;
+    std::vector<unsigned int> newIndex(numVertices, UNUSED);
+
+    remap.clear();
+    for (unsigned int& index : indices) {
+        if (newIndex[index] == UNUSED) {
+            newIndex[index] = (unsigned int)remap.size();
+            remap.push_back(index);
+        }
+        index = newIndex[index];
+    }
+}
+
+}  // namespace gdp1
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace gdp1 {
+
+// Reduces triangle lists by collapsing edges in the order of their quadric error (Garland and Heckbert).
+// Every collapse moves a vertex onto one of its neighbours, so the result indexes the input vertices and their
+// attributes stay valid. Vertices sharing a position (normal or UV seams) are collapsed together, and open borders are
+// held in place by planes standing on them. Nothing here touches GL, the loader threads generate the LOD chains with it.
+class MeshSimplifier {
+public:
+    // Simplifies indices, a triangle list over numVertices positions stride bytes apart, towards targetIndexCount
+    // indices. Leaves out every collapse that would move a vertex farther than maxError from the plane of any input
+    // triangle it replaces, and stops when none is left. Returns the new triangle list and, if error is given, the
+    // largest such distance, in the units of the positions. The middle of a new triangle on a curved surface can be
+    // somewhat farther off than its vertices.
+    static std::vector<unsigned int> Simplify(const glm::vec3* positions, size_t stride, unsigned int numVertices,
+                                              const std::vector<unsigned int>& indices,
+                                              unsigned int targetIndexCount, float maxError, float* error = nullptr);
+
+    // Copies the vertices indices uses to the front of a new array and points indices at them.
+    // remap receives, for each new vertex, the old vertex it came from.
+    static void CompactVertices(std::vector<unsigned int>& indices, unsigned int numVertices,
+                                std::vector<unsigned int>& remap);
+};
+
+}  // namespace gdp1
@@ -158,6 +158,20 @@ GLuint Texture::LoadCubeMap(const std::vector<std::string>& faces, bool flipY) {
     return cubemap;
 }
 
+GLuint Texture::CreateWhiteTexture() {
+    const unsigned char white[4] = {255, 255, 255, 255};
+
+    GLuint tex = 0;
+    glCreateTextures(GL_TEXTURE_2D, 1, &tex);
+    glTextureStorage2D(tex, 1, GL_RGBA8, 1, 1);
+    glTextureSubImage2D(tex, 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, white);
+
+    glTextureParameteri(tex, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTextureParameteri(tex, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+    return tex;
+}
+
 GLuint Texture::LoadHdrCubeMap(const std::string& baseName) {
     GLuint tex;
     glGenTextures(1, &tex);
@@ -20,6 +20,8 @@ public:
     static GLuint LoadTexture(const std::string& texPath, bool flipY = false);
     static GLuint LoadCubeMap(const std::vector<std::string>& faces, bool flipY = false);
     static GLuint LoadHdrCubeMap(const std::string& baseName);
+    // a 1x1 opaque white texture, sampling it leaves a color as it is
+    static GLuint CreateWhiteTexture();
     static unsigned char* LoadPixels(const std::string& texPath, int& w, int& h, int& numChannels, bool flip);
     static void DeletePixels(unsigned char*);
 
@@ -60,6 +60,24 @@ glm::vec3 TransformUtils::GetQuatAsDegrees(const glm::quat& orientation) {
 
 glm::quat TransformUtils::GetDegreesAsQuat(const glm::vec3& rotation) { return glm::quat(glm::radians(rotation)); }
 
+glm::mat4 TransformUtils::AffineInverse(const glm::mat4& matrix) {
+    glm::mat3 inverse = glm::inverse(glm::mat3(matrix));
+
+    glm::mat4 result(inverse);
+    result[3] = glm::vec4(-(inverse * glm::vec3(matrix[3])), 1.0f);
+    return result;
+}
+
+glm::mat4 TransformUtils::UniformScaleInverse(const glm::mat4& matrix) {
+    // (R * s)^-1 = R^T / s = (R * s)^T / s^2
+    glm::mat3 linear(matrix);
+    glm::mat3 inverse = glm::transpose(linear) * (1.0f / glm::dot(linear[0], linear[0]));
+
+    glm::mat4 result(inverse);
+    result[3] = glm::vec4(-(inverse * glm::vec3(matrix[3])), 1.0f);
+    return result;
+}
+
 glm::vec3 TransformUtils::LocalToWorldPoint(const glm::vec3& point, const glm::vec3& position,
                                             const glm::quat& orientation, const float& scale, glm::mat4& parentMat) {
     GetTransform(position, orientation, scale, parentMat);
@@ -82,7 +100,7 @@ glm::vec3 TransformUtils::WorldToLocalPoint(const glm::vec3& point, const glm::v
                                             const glm::quat& orientation, const float& scale, glm::mat4& parentMat) {
     GetTransform(position, orientation, scale, parentMat);
 
-    glm::mat4 inverseParentMat = glm::inverse(parentMat);
+    glm::mat4 inverseParentMat = UniformScaleInverse(parentMat);
     glm::vec3 localPoint = inverseParentMat * glm::vec4(point, 1.0f);
 
     return localPoint;
@@ -92,7 +110,7 @@ glm::vec3 TransformUtils::WorldToLocalPoint(const glm::vec3& point, const glm::v
                                             glm::mat4& parentMat) {
     GetTransform(position, scale, parentMat);
 
-    glm::mat4 inverseParentMat = glm::inverse(parentMat);
+    glm::mat4 inverseParentMat = UniformScaleInverse(parentMat);
     glm::vec3 localPoint = inverseParentMat * glm::vec4(point, 1.0f);
 
     return localPoint;
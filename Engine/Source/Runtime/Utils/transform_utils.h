@@ -31,6 +31,13 @@ public:
 
     static glm::vec3 GetQuatAsDegrees(const glm::quat& orientation);
 
+    // Inverse of a matrix without projection: the 3x3 part is inverted on its own and the translation is moved
+    // through it, about half the work of a general 4x4 inverse.
+    static glm::mat4 AffineInverse(const glm::mat4& matrix);
+
+    // Inverse of translation * rotation * uniform scale: the transposed rotation divided by the scale.
+    static glm::mat4 UniformScaleInverse(const glm::mat4& matrix);
+
     static glm::quat GetDegreesAsQuat(const glm::vec3& rotation);
 
     static glm::vec3 LocalToWorldPoint(const glm::vec3& point, const glm::vec3& position, const glm::quat& orientation,
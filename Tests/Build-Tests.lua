@@ -0,0 +1,64 @@
+project "Tests"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++14"
+    staticruntime "off"
+
+    targetdir ("../Binaries/" .. OutputDir .. "/%{prj.name}")
+    objdir ("../Binaries/Intermediates/" .. OutputDir .. "/%{prj.name}")
+
+    files
+    {
+        "Source/**.h",
+        "Source/**.cpp",
+    }
+
+    includedirs
+    {
+        "Source",
+        -- Include Engine
+        "../Engine/Source/Runtime",
+        "../Engine/%{IncludeDir.glad}",
+        "../Engine/%{IncludeDir.glm}",
+        "../Engine/%{IncludeDir.imgui}",
+        "../Engine/%{IncludeDir.stb_image}",
+        "../Engine/%{IncludeDir.assimp}",
+        "../Engine/%{IncludeDir.spdlog}",
+        "../Engine/%{IncludeDir.json}",
+        "../Engine/Vendor/sqlite",
+        "../Engine/Vendor/lua/include",
+        "../Engine/Vendor/fmod/include",
+    }
+
+    links
+    {
+        "Engine"
+    }
+
+    -- the checks only run CPU code, they need no window or GL context
+    filter "system:windows"
+        systemversion "latest"
+        defines { "WINDOWS", "GLM_FORCE_INTRINSICS" }
+
+    filter "configurations:Debug"
+        defines { "DEBUG" }
+        runtime "Debug"
+        symbols "On"
+        postbuildcommands
+        {
+            "{COPYFILE} ../Engine/Vendor/assimp/bin/assimp-vc143-mt.dll %{cfg.targetdir}/",
+            "{COPYFILE} ../Engine/Vendor/glfw/lib-vc2022/*.dll %{cfg.targetdir}/",
+            "{COPYFILE} ../Engine/Vendor/fmod/bin/*.dll %{cfg.targetdir}/",
+        }
+
+    filter "configurations:Release"
+        defines { "RELEASE" }
+        runtime "Release"
+        optimize "On"
+        symbols "On"
+        postbuildcommands
+        {
+            "{COPYFILE} ../Engine/Vendor/assimp/bin/assimp-vc143-mt.dll %{cfg.targetdir}/",
+            "{COPYFILE} ../Engine/Vendor/glfw/lib-vc2022/*.dll %{cfg.targetdir}/",
+            "{COPYFILE} ../Engine/Vendor/fmod/bin/*.dll %{cfg.targetdir}/",
+        }
@@ -0,0 +1,51 @@
+#include "test.h"
+
+#include <cmath>
+#include <limits>
+
+#include "Animation/animation_curve.h"
+
+namespace {
+
+Keyframe MakeKey(float time, float value) {
+    Keyframe key = {};
+    key.time = time;
+    key.value = value;
+    key.weightedMode = WeightedMode::None;
+    return key;
+}
+
+}  // namespace
+
+// The batch path must clamp like the scalar one, also for times too large for an int.
+TEST(BakedCurveBatchEvaluateClampsOutOfRangeTimes) {
+    AnimationCurve curve({MakeKey(0.0f, 1.0f), MakeKey(2.0f, 3.0f)});
+    curve.Bake(64);
+
+    const float infinity = std::numeric_limits<float>::infinity();
+    const float times[8] = {-infinity, -5.0f, 0.0f, 2.0f, 3e9f, infinity, 1e30f, 2.5f};
+    float batch[8];
+    curve.Evaluate(times, batch, 8);
+
+    for (int i = 0; i < 8; i++) {
+        CHECK(fabsf(batch[i] - curve.Evaluate(times[i])) < 1e-5f);
+    }
+    CHECK(fabsf(batch[0] - 1.0f) < 1e-5f);
+    CHECK(fabsf(batch[4] - 3.0f) < 1e-5f);
+    CHECK(fabsf(batch[5] - 3.0f) < 1e-5f);
+}
+
+// Inside the keys the batch matches the scalar evaluation.
+TEST(BakedCurveBatchEvaluateMatchesScalar) {
+    AnimationCurve curve({MakeKey(0.0f, 0.0f), MakeKey(1.0f, 2.0f), MakeKey(3.0f, -1.0f)});
+    curve.Bake(128);
+
+    float times[12];
+    for (int i = 0; i < 12; i++) times[i] = i * 0.27f;
+    float batch[12];
+    curve.Evaluate(times, batch, 12);
+
+    for (int i = 0; i < 12; i++) {
+        CHECK(fabsf(batch[i] - curve.Evaluate(times[i])) < 1e-5f);
+    }
+}
@@ -0,0 +1,107 @@
+#include "test.h"
+
+#include <string>
+
+#include "Animation/blend_tree.h"
+
+using namespace gdp1;
+
+namespace {
+
+BlendNode MakeClip() { return BlendNode(); }
+
+BlendNode MakeNode(BlendNodeType type, const std::vector<int>& children, int parameter = -1) {
+    BlendNode node;
+    node.type = type;
+    node.children = children;
+    node.parameter = parameter;
+    return node;
+}
+
+BlendNode MakeBlend1D(const std::vector<int>& children, const std::vector<float>& thresholds, int parameter) {
+    BlendNode node = MakeNode(BlendNodeType::Blend1D, children, parameter);
+    node.thresholds = thresholds;
+    return node;
+}
+
+bool IsValid(const BlendTree& tree) {
+    std::string error;
+    return tree.Validate(error);
+}
+
+}  // namespace
+
+// A layer over a three way blend space, the shape of the zombie locomotion tree. The clips sample the bind pose,
+// which is all the op list needs, so the tree runs without a model.
+TEST(ValidBlendTreeCompilesToABalancedOpList) {
+    BlendTree tree(nullptr);
+    int speed = tree.AddParameter("speed");
+    int attack = tree.AddParameter("attack");
+    tree.AddNode(MakeNode(BlendNodeType::Layer, {1, 5}, attack));
+    tree.AddNode(MakeBlend1D({2, 3, 4}, {0.0f, 1.0f, 2.0f}, speed));
+    tree.AddNode(MakeClip());
+    tree.AddNode(MakeClip());
+    tree.AddNode(MakeClip());
+    tree.AddNode(MakeClip());
+    CHECK(IsValid(tree));
+
+    float parameters[2] = {1.5f, 0.5f};
+    float phases[6] = {0.0f};
+    std::vector<TrackCursor> cursors[6];
+    std::vector<BlendOp> ops;
+    tree.Compile(parameters, 0.016f, phases, cursors, ops);
+
+    // two clips of the blend space, their blend, the attack clip and the layer
+    CHECK(ops.size() == 5);
+    int depth = 0;
+    for (const BlendOp& op : ops) {
+        depth += op.type == BlendOp::Sample ? 1 : -1;
+        CHECK(depth >= 1);
+    }
+    CHECK(depth == 1);
+}
+
+TEST(BlendTreeWithACycleIsInvalid) {
+    BlendTree tree(nullptr);
+    tree.AddNode(MakeNode(BlendNodeType::Additive, {1, 2}));
+    tree.AddNode(MakeNode(BlendNodeType::Layer, {0, 2}));
+    tree.AddNode(MakeClip());
+    CHECK(!IsValid(tree));
+}
+
+TEST(BlendTreeSharingANodeIsValid) {
+    BlendTree tree(nullptr);
+    tree.AddNode(MakeNode(BlendNodeType::Additive, {1, 2}));
+    tree.AddNode(MakeNode(BlendNodeType::Layer, {2, 2}));
+    tree.AddNode(MakeClip());
+    CHECK(IsValid(tree));
+}
+
+TEST(BlendNodeWithoutChildrenIsInvalid) {
+    BlendTree tree(nullptr);
+    tree.AddNode(MakeNode(BlendNodeType::Layer, {1, 2}));
+    tree.AddNode(MakeBlend1D({}, {}, -1));
+    tree.AddNode(MakeClip());
+    CHECK(!IsValid(tree));
+}
+
+TEST(BlendSpaceNeedsAThresholdPerChild) {
+    BlendTree tree(nullptr);
+    int speed = tree.AddParameter("speed");
+    tree.AddNode(MakeBlend1D({1, 2}, {0.0f}, speed));
+    tree.AddNode(MakeClip());
+    tree.AddNode(MakeClip());
+    CHECK(!IsValid(tree));
+}
+
+TEST(BlendTreeChildOutOfRangeIsInvalid) {
+    BlendTree tree(nullptr);
+    tree.AddNode(MakeNode(BlendNodeType::Additive, {1, 7}));
+    tree.AddNode(MakeClip());
+    CHECK(!IsValid(tree));
+
+    BlendTree rootless(nullptr);
+    rootless.AddNode(MakeClip());
+    rootless.SetRoot(3);
+    CHECK(!IsValid(rootless));
+}
@@ -0,0 +1,62 @@
+#include "test.h"
+#include "render_test_utils.h"
+
+#include "Render/render_backend.h"
+
+using namespace gdp1;
+using namespace gdp1::test;
+
+namespace {
+
+const unsigned int NUM_BONES = 100;
+
+}  // namespace
+
+// Skinned draws used to send every bone as a "bones[i]" uniform. With all palettes in one buffer a character only
+// sends where its bones start.
+TEST(SkinnedDrawsOnlySendTheirBoneOffset) {
+    const unsigned int numCharacters = 8;
+    glm::mat4 models[numCharacters];
+
+    RenderQueue queue;
+    for (unsigned int i = 0; i < numCharacters; i++) {
+        DrawPacket packet = MakePacket(0, 0, &models[i], 1.0f + i);
+        packet.boneOffset = (int)(i * NUM_BONES);
+        queue.Add(packet);
+    }
+    queue.Sort();
+
+    RecordingRenderBackend backend;
+    queue.Submit(backend);
+
+    // skinned packets never merge, every character is a draw of its own
+    CHECK(backend.GetCount(RecordingRenderBackend::DrawCommand) == numCharacters);
+    CHECK(backend.GetUniformCount("u_BoneOffset") == numCharacters);
+
+    // binding the program sets the samplers once, after that a character costs its bone offset and nothing more
+    unsigned int programSetup = NUM_TEXTURE_SLOTS + 1;
+    unsigned int frameSetup = backend.GetUniformCount("u_InstanceBase") + backend.GetUniformCount("u_SetLit");
+    unsigned int perCharacter =
+        (backend.GetCount(RecordingRenderBackend::SetUniformCommand) - programSetup - frameSetup) / numCharacters;
+    CHECK(perCharacter == 1);
+    CHECK(frameSetup <= 3);
+}
+
+// Characters sharing a bone offset (the same palette) do not send it again.
+TEST(EqualBoneOffsetsAreNotSentAgain) {
+    glm::mat4 models[2];
+
+    RenderQueue queue;
+    for (int i = 0; i < 2; i++) {
+        DrawPacket packet = MakePacket(0, 0, &models[i], 1.0f + i);
+        packet.boneOffset = 0;
+        queue.Add(packet);
+    }
+    queue.Sort();
+
+    RecordingRenderBackend backend;
+    queue.Submit(backend);
+
+    CHECK(backend.GetCount(RecordingRenderBackend::DrawCommand) == 2);
+    CHECK(backend.GetUniformCount("u_BoneOffset") == 1);
+}
@@ -0,0 +1,141 @@
+#include "test.h"
+
+#include <cmath>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Physics/bounds.h"
+#include "Render/frustum.h"
+
+using namespace gdp1;
+
+namespace {
+
+// the camera at (0, 0, 10) looking down -z
+glm::mat4 GetViewProjection() {
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 10.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    return projection * view;
+}
+
+// boxes in structure of arrays form, as CullBoxes takes them
+struct Boxes {
+    std::vector<float> centerX, centerY, centerZ, extentX, extentY, extentZ;
+
+    void Add(const glm::vec3& center, const glm::vec3& extents) {
+        centerX.push_back(center.x);
+        centerY.push_back(center.y);
+        centerZ.push_back(center.z);
+        extentX.push_back(extents.x);
+        extentY.push_back(extents.y);
+        extentZ.push_back(extents.z);
+    }
+
+    glm::vec3 GetCenter(size_t i) const { return glm::vec3(centerX[i], centerY[i], centerZ[i]); }
+    glm::vec3 GetExtents(size_t i) const { return glm::vec3(extentX[i], extentY[i], extentZ[i]); }
+    unsigned int GetCount() const { return (unsigned int)centerX.size(); }
+
+    std::vector<unsigned char> Cull(const Frustum& frustum, unsigned int planeMask) const {
+        std::vector<unsigned char> visible(GetCount(), 2);
+        frustum.CullBoxes(&centerX[0], &centerY[0], &centerZ[0], &extentX[0], &extentY[0], &extentZ[0], GetCount(),
+                          &visible[0], planeMask);
+        return visible;
+    }
+};
+
+int Classify(const Frustum& frustum, const glm::vec3& center, const glm::vec3& extents, unsigned int planeMask) {
+    int lastPlane = 0;
+    return frustum.ClassifyBox(center - extents, center + extents, planeMask, lastPlane);
+}
+
+}  // namespace
+
+TEST(ClassifyBoxTellsInsideOutsideAndIntersecting) {
+    Frustum frustum;
+    frustum.Update(GetViewProjection());
+
+    const glm::vec3 extents(0.5f);
+    CHECK(Classify(frustum, glm::vec3(0.0f), extents, Frustum::ALL_PLANES) == 1);
+    // behind the camera, past the far plane and off to the side
+    CHECK(Classify(frustum, glm::vec3(0.0f, 0.0f, 20.0f), extents, Frustum::ALL_PLANES) == -1);
+    CHECK(Classify(frustum, glm::vec3(0.0f, 0.0f, -200.0f), extents, Frustum::ALL_PLANES) == -1);
+    CHECK(Classify(frustum, glm::vec3(100.0f, 0.0f, 0.0f), extents, Frustum::ALL_PLANES) == -1);
+    // across the right edge of the view, which is about 10.26 units out at the origin
+    CHECK(Classify(frustum, glm::vec3(10.26f, 0.0f, 0.0f), extents, Frustum::ALL_PLANES) == 0);
+}
+
+// Boxes inside, outside and across the planes, in a count that leaves a tail after the groups of eight.
+TEST(CullBoxesAgreesWithClassifyBox) {
+    Frustum frustum;
+    frustum.Update(GetViewProjection());
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+    std::uniform_real_distribution<float> size(0.1f, 8.0f);
+
+    Boxes boxes;
+    boxes.Add(glm::vec3(0.0f), glm::vec3(0.5f));
+    boxes.Add(glm::vec3(0.0f, 0.0f, 20.0f), glm::vec3(0.5f));
+    boxes.Add(glm::vec3(10.26f, 0.0f, 0.0f), glm::vec3(0.5f));
+    for (int i = 0; i < 1000; i++) {
+        boxes.Add(glm::vec3(position(rng), position(rng), position(rng) - 40.0f),
+                  glm::vec3(size(rng), size(rng), size(rng)));
+    }
+    CHECK(boxes.GetCount() % 8 != 0 && boxes.GetCount() % 4 != 0);
+
+    // every plane, and some planes already known to contain the boxes
+    const unsigned int masks[3] = {Frustum::ALL_PLANES, 0x0F, 0x30};
+    for (unsigned int mask : masks) {
+        std::vector<unsigned char> visible = boxes.Cull(frustum, mask);
+
+        int numVisible = 0, numWrong = 0;
+        for (unsigned int i = 0; i < boxes.GetCount(); i++) {
+            bool expected = Classify(frustum, boxes.GetCenter(i), boxes.GetExtents(i), mask) >= 0;
+            if (visible[i] != (expected ? 1 : 0)) numWrong++;
+            if (expected) numVisible++;
+        }
+
+        CHECK(numWrong == 0);
+        // both outcomes are covered
+        CHECK(numVisible > 0 && numVisible < (int)boxes.GetCount());
+    }
+}
+
+TEST(CullBoxesHandlesCountsBelowEight) {
+    Frustum frustum;
+    frustum.Update(GetViewProjection());
+
+    Boxes boxes;
+    boxes.Add(glm::vec3(0.0f), glm::vec3(0.5f));
+    boxes.Add(glm::vec3(0.0f, 0.0f, 20.0f), glm::vec3(0.5f));
+    boxes.Add(glm::vec3(10.26f, 0.0f, 0.0f), glm::vec3(0.5f));
+
+    std::vector<unsigned char> visible = boxes.Cull(frustum, Frustum::ALL_PLANES);
+    CHECK(visible[0] == 1);
+    CHECK(visible[1] == 0);
+    CHECK(visible[2] == 1);
+}
+
+// the box around the 8 transformed corners
+TEST(TransformBoundsMatchesTheTransformedCorners) {
+    glm::mat4 world = glm::translate(glm::mat4(1.0f), glm::vec3(3.0f, -2.0f, 5.0f));
+    world = glm::rotate(world, glm::radians(37.0f), glm::normalize(glm::vec3(1.0f, 2.0f, 0.5f)));
+    world = glm::scale(world, glm::vec3(2.0f, 0.5f, 3.0f));
+
+    const glm::vec3 min(-1.0f, 0.0f, -2.0f), max(3.0f, 1.0f, 0.5f);
+    Bounds bounds;
+    bounds.SetMinMax(min, max);
+    bounds.TransformBounds(world);
+
+    glm::vec3 expectedMin(INFINITY), expectedMax(-INFINITY);
+    for (int corner = 0; corner < 8; corner++) {
+        glm::vec3 point((corner & 1) ? max.x : min.x, (corner & 2) ? max.y : min.y, (corner & 4) ? max.z : min.z);
+        glm::vec3 transformed = glm::vec3(world * glm::vec4(point, 1.0f));
+        expectedMin = glm::min(expectedMin, transformed);
+        expectedMax = glm::max(expectedMax, transformed);
+    }
+
+    CHECK(glm::all(glm::lessThan(glm::abs(bounds.GetMin() - expectedMin), glm::vec3(1e-4f))));
+    CHECK(glm::all(glm::lessThan(glm::abs(bounds.GetMax() - expectedMax), glm::vec3(1e-4f))));
+}
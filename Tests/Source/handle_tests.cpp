@@ -0,0 +1,36 @@
+#include "test.h"
+
+#include "Core/handle.h"
+
+using namespace gdp1;
+
+TEST(RemovedHandleStaysInvalidWhenItsSlotIsReused) {
+    int a = 1, b = 2;
+    HandleTable<int> table;
+
+    Handle<int> first = table.Add(&a);
+    table.Remove(first);
+    Handle<int> second = table.Add(&b);
+
+    CHECK(second.index == first.index);
+    CHECK(table.Get(first) == nullptr);
+    CHECK(table.Get(second) == &b);
+}
+
+// An object taking over a name keeps it when the object that had it before is removed.
+TEST(RemovingAnObjectKeepsANameTakenOver) {
+    int a = 1, b = 2;
+    HandleTable<int> table;
+    StringId name = StringTable::Intern("handle_test_object");
+
+    Handle<int> first = table.Add(&a, name);
+    Handle<int> second = table.Add(&b, name);
+    CHECK(table.Find(name) == second);
+
+    table.Remove(first);
+    CHECK(table.Find(name) == second);
+    CHECK(table.Get(table.Find(name)) == &b);
+
+    table.Remove(second);
+    CHECK(!table.Find(name).IsValid());
+}
@@ -0,0 +1,157 @@
+#include "test.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Render/light.h"
+#include "Render/light_clusterer.h"
+
+using namespace gdp1;
+
+namespace {
+
+// the same numbers on every platform, unlike rand
+class Random {
+public:
+    explicit Random(uint32_t seed) : m_State(seed) {}
+
+    // in [0, 1)
+    float Next() {
+        m_State = m_State * 1664525u + 1013904223u;
+        return (m_State >> 8) * (1.0f / 16777216.0f);
+    }
+    float Next(float min, float max) { return min + (max - min) * Next(); }
+
+private:
+    uint32_t m_State;
+};
+
+glm::mat4 GetProjection() { return glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 200.0f); }
+
+std::vector<glm::vec4> MakeLights(unsigned int count) {
+    Random random(1);
+    std::vector<glm::vec4> spheres;
+    for (unsigned int i = 0; i < count; i++) {
+        spheres.push_back(glm::vec4(random.Next(-50.0f, 50.0f), random.Next(-15.0f, 15.0f),
+                                    random.Next(-200.0f, 0.0f), random.Next(1.0f, 6.0f)));
+    }
+    return spheres;
+}
+
+bool ClusterHasLight(const LightClusterer& clusterer, const LightClusterer::Cluster& cluster, uint32_t light) {
+    const std::vector<uint32_t>& indices = clusterer.GetLightIndices();
+    for (uint32_t i = cluster.offset; i < cluster.offset + cluster.count; i++) {
+        if (indices[i] == light) return true;
+    }
+    return false;
+}
+
+// Samples points in the frustum and checks that the cluster the shader would look up for each lists every light
+// reaching the point. Returns the lights missing from their cluster.
+int CountMissingLights(const LightClusterer& clusterer, const glm::mat4& projection,
+                       const std::vector<glm::vec4>& spheres, int& numCovered) {
+    Random random(2);
+    int numMissing = 0;
+    numCovered = 0;
+
+    for (int sample = 0; sample < 20000; sample++) {
+        // normalized device x and y, and a view depth spread evenly over the exponential slices
+        float ndcX = random.Next(-1.0f, 1.0f);
+        float ndcY = random.Next(-1.0f, 1.0f);
+        float depth = 0.1f * powf(2000.0f, random.Next());
+        glm::vec3 point(ndcX * depth / projection[0][0], ndcY * depth / projection[1][1], -depth);
+
+        int x = std::min(LightClusterer::TILES_X - 1, (int)((ndcX * 0.5f + 0.5f) * LightClusterer::TILES_X));
+        int y = std::min(LightClusterer::TILES_Y - 1, (int)((ndcY * 0.5f + 0.5f) * LightClusterer::TILES_Y));
+        int z = (int)(logf(depth) * clusterer.GetSliceScale() - clusterer.GetSliceBias());
+        z = std::max(0, std::min(LightClusterer::SLICES_Z - 1, z));
+        const LightClusterer::Cluster& cluster = clusterer.GetCluster(x, y, z);
+
+        for (uint32_t light = 0; light < spheres.size(); light++) {
+            if (glm::length(point - glm::vec3(spheres[light])) > spheres[light].w) continue;
+
+            numCovered++;
+            if (!ClusterHasLight(clusterer, cluster, light)) numMissing++;
+        }
+    }
+
+    return numMissing;
+}
+
+}  // namespace
+
+TEST(EveryLitPointFindsItsLightsInItsCluster) {
+    std::vector<glm::vec4> spheres = MakeLights(300);
+
+    LightClusterer clusterer;
+    clusterer.Build(GetProjection(), spheres);
+
+    int numCovered = 0;
+    CHECK(CountMissingLights(clusterer, GetProjection(), spheres, numCovered) == 0);
+    CHECK(numCovered > 0);
+}
+
+// a projection flipping y, as rendering into a texture upside down does, turns the tiles around
+TEST(FlippedProjectionStillFindsEveryLight) {
+    std::vector<glm::vec4> spheres = MakeLights(300);
+    glm::mat4 projection = glm::scale(GetProjection(), glm::vec3(1.0f, -1.0f, 1.0f));
+
+    LightClusterer clusterer;
+    clusterer.Build(projection, spheres);
+
+    int numCovered = 0;
+    CHECK(CountMissingLights(clusterer, projection, spheres, numCovered) == 0);
+    CHECK(numCovered > 0);
+}
+
+TEST(ClustersOnlyListLightsNearThem) {
+    // one small light straight ahead, it may not show up in the corner tiles or the far slices
+    std::vector<glm::vec4> spheres(1, glm::vec4(0.0f, 0.0f, -10.0f, 1.0f));
+
+    LightClusterer clusterer;
+    clusterer.Build(GetProjection(), spheres);
+
+    CHECK(clusterer.GetAssignmentCount() > 0);
+    CHECK(clusterer.GetAssignmentCount() < LightClusterer::NUM_CLUSTERS / 50);
+    CHECK(clusterer.GetMaxLightsPerCluster() == 1);
+    CHECK(clusterer.GetCluster(0, 0, 0).count == 0);
+    CHECK(clusterer.GetCluster(LightClusterer::TILES_X - 1, LightClusterer::TILES_Y - 1, 0).count == 0);
+    CHECK(clusterer.GetCluster(LightClusterer::TILES_X / 2, LightClusterer::TILES_Y / 2,
+                               LightClusterer::SLICES_Z - 1).count == 0);
+}
+
+TEST(LightsBehindTheCameraAreNotBinned) {
+    std::vector<glm::vec4> spheres(1, glm::vec4(0.0f, 0.0f, 10.0f, 2.0f));
+
+    LightClusterer clusterer;
+    clusterer.Build(GetProjection(), spheres);
+
+    CHECK(clusterer.GetAssignmentCount() == 0);
+}
+
+TEST(LightRadiusEndsAtTheCutoff) {
+    PointLight light;
+    light.color = glm::vec4(1.0f, 0.5f, 0.2f, 1.0f);
+    light.intensity = 2.0f;
+    light.constant = 1.0f;
+    light.linear = 0.09f;
+    light.quadratic = 0.032f;
+
+    const float cutoff = 1.0f / 256.0f;
+    float radius = LightClusterer::GetLightRadius(light, cutoff);
+    float attenuated = light.intensity / (light.constant + light.linear * radius + light.quadratic * radius * radius);
+    CHECK(fabsf(attenuated - cutoff) < cutoff * 0.01f);
+
+    // without falloff it reaches everywhere
+    PointLight constant = light;
+    constant.linear = 0.0f;
+    constant.quadratic = 0.0f;
+    CHECK(LightClusterer::GetLightRadius(constant, cutoff) == FLT_MAX);
+
+    // too dim to ever reach the cutoff
+    light.intensity = 0.001f;
+    CHECK(LightClusterer::GetLightRadius(light, cutoff) == 0.0f);
+}
@@ -0,0 +1,58 @@
+#include "test.h"
+
+#include "Resource/lod_system.h"
+
+using namespace gdp1;
+
+namespace {
+
+// four levels, each twice as coarse as the one before
+std::vector<LODLevel> MakeLevels() {
+    std::vector<LODLevel> levels;
+    levels.push_back(LODLevel(0, std::vector<Mesh*>(), 0.0f));
+    levels.push_back(LODLevel(1, std::vector<Mesh*>(), 0.01f));
+    levels.push_back(LODLevel(2, std::vector<Mesh*>(), 0.02f));
+    levels.push_back(LODLevel(3, std::vector<Mesh*>(), 0.04f));
+    return levels;
+}
+
+}  // namespace
+
+TEST(NearObjectsGetTheFullDetail) {
+    LODSystem lodSystem;
+    std::vector<LODLevel> levels = MakeLevels();
+
+    // level 1 would be off by 10 pixels
+    CHECK(lodSystem.SelectLevel(levels, 3, 1000.0f) == 0);
+}
+
+TEST(FarObjectsGetTheCoarsestLevel) {
+    LODSystem lodSystem;
+    std::vector<LODLevel> levels = MakeLevels();
+
+    // level 3 is off by 0.4 pixels
+    CHECK(lodSystem.SelectLevel(levels, 0, 10.0f) == 3);
+}
+
+TEST(CoarserLevelsWaitForTheHysteresis) {
+    LODSystem lodSystem;
+    std::vector<LODLevel> levels = MakeLevels();
+
+    // level 2 is off by 0.9 pixels, within the limit but not under the 0.75 needed to switch to it
+    CHECK(lodSystem.SelectLevel(levels, 1, 45.0f) == 1);
+    // already there it stays
+    CHECK(lodSystem.SelectLevel(levels, 2, 45.0f) == 2);
+
+    // farther away it drops under 0.75 pixels and is taken
+    CHECK(lodSystem.SelectLevel(levels, 1, 35.0f) == 2);
+    // past the limit it goes back to the finer level
+    CHECK(lodSystem.SelectLevel(levels, 2, 55.0f) == 1);
+}
+
+TEST(LevelsOutOfRangeAreClamped) {
+    LODSystem lodSystem;
+    std::vector<LODLevel> levels = MakeLevels();
+
+    CHECK(lodSystem.SelectLevel(levels, 10, 10.0f) == 3);
+    CHECK(lodSystem.SelectLevel(std::vector<LODLevel>(), 2, 10.0f) == 0);
+}
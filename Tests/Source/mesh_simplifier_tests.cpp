@@ -0,0 +1,187 @@
+#include "test.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/constants.hpp>
+
+#include "Resource/mesh_simplifier.h"
+
+using namespace gdp1;
+
+namespace {
+
+// size x size quads in the xy plane from 0 to size, facing +z
+void MakeGrid(unsigned int size, std::vector<glm::vec3>& positions, std::vector<unsigned int>& indices) {
+    for (unsigned int y = 0; y <= size; y++) {
+        for (unsigned int x = 0; x <= size; x++) {
+            positions.push_back(glm::vec3((float)x, (float)y, 0.0f));
+        }
+    }
+    for (unsigned int y = 0; y < size; y++) {
+        for (unsigned int x = 0; x < size; x++) {
+            unsigned int corner = y * (size + 1) + x;
+            unsigned int above = corner + size + 1;
+            unsigned int quad[6] = {corner, corner + 1, above + 1, corner, above + 1, above};
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+}
+
+// a unit sphere of rings x segments quads, facing outwards, the poles and the seam have vertices of their own like a
+// UV mapped sphere from a modelling tool
+void MakeSphere(unsigned int rings, unsigned int segments, std::vector<glm::vec3>& positions,
+                std::vector<unsigned int>& indices) {
+    for (unsigned int ring = 0; ring <= rings; ring++) {
+        float theta = glm::pi<float>() * ring / rings;
+        for (unsigned int segment = 0; segment <= segments; segment++) {
+            float phi = glm::two_pi<float>() * segment / segments;
+            positions.push_back(glm::vec3(sinf(theta) * cosf(phi), cosf(theta), -sinf(theta) * sinf(phi)));
+        }
+    }
+    for (unsigned int ring = 0; ring < rings; ring++) {
+        for (unsigned int segment = 0; segment < segments; segment++) {
+            unsigned int a = ring * (segments + 1) + segment;
+            unsigned int b = a + segments + 1;
+            if (ring > 0) indices.insert(indices.end(), {a, b, a + 1});
+            if (ring + 1 < rings) indices.insert(indices.end(), {a + 1, b, b + 1});
+        }
+    }
+}
+
+glm::vec3 GetNormal(const std::vector<glm::vec3>& positions, const unsigned int* triangle) {
+    const glm::vec3& p0 = positions[triangle[0]];
+    return glm::cross(positions[triangle[1]] - p0, positions[triangle[2]] - p0);
+}
+
+float GetArea(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices) {
+    float area = 0.0f;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        area += glm::length(GetNormal(positions, &indices[i])) * 0.5f;
+    }
+    return area;
+}
+
+}  // namespace
+
+TEST(FlatGridSimplifiesWithoutErrorAndKeepsItsOutline) {
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+    MakeGrid(10, positions, indices);
+
+    float error = -1.0f;
+    std::vector<unsigned int> simplified = MeshSimplifier::Simplify(
+        &positions[0], sizeof(glm::vec3), (unsigned int)positions.size(), indices, 6, 0.01f, &error);
+
+    CHECK(simplified.size() % 3 == 0);
+    CHECK(simplified.size() < indices.size() / 10);
+    CHECK(error >= 0.0f && error < 1e-4f);
+
+    // the same square, every triangle still facing +z
+    CHECK(fabsf(GetArea(positions, simplified) - 100.0f) < 1e-3f);
+    for (size_t i = 0; i + 2 < simplified.size(); i += 3) {
+        CHECK(GetNormal(positions, &simplified[i]).z > 0.0f);
+    }
+}
+
+// The top left quad of a 2x2 grid has its own copy of the middle vertex at x = -0. It must weld with the middle
+// vertex like any other shared position, or the quad is cut loose along two edges meeting at a corner that the border
+// planes then pin in place.
+TEST(VerticesAtMinusZeroWeldWithZero) {
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+    MakeGrid(2, positions, indices);
+    for (glm::vec3& p : positions) p -= glm::vec3(1.0f, 1.0f, 0.0f);
+
+    unsigned int middle = 4;
+    positions.push_back(glm::vec3(-0.0f, 0.0f, 0.0f));
+    for (size_t i = 12; i < 18; i++) {
+        if (indices[i] == middle) indices[i] = (unsigned int)positions.size() - 1;
+    }
+    CHECK(std::signbit(positions.back().x) && positions.back() == positions[middle]);
+
+    float error = -1.0f;
+    std::vector<unsigned int> simplified = MeshSimplifier::Simplify(
+        &positions[0], sizeof(glm::vec3), (unsigned int)positions.size(), indices, 0, 0.01f, &error);
+
+    // down to two triangles like any flat square
+    CHECK(simplified.size() == 6);
+    CHECK(error >= 0.0f && error < 1e-4f);
+    CHECK(fabsf(GetArea(positions, simplified) - 4.0f) < 1e-3f);
+}
+
+// A vertex raised above a flat grid. Only a few of the planes around it are tilted, the mean distance to them stays
+// under maxError when it is flattened, the largest does not.
+TEST(BumpTallerThanMaxErrorIsKept) {
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+    MakeGrid(10, positions, indices);
+
+    const unsigned int bump = 5 * 11 + 5;
+    positions[bump].z = 0.05f;
+
+    const float maxError = 0.02f;
+    float error = -1.0f;
+    std::vector<unsigned int> simplified = MeshSimplifier::Simplify(
+        &positions[0], sizeof(glm::vec3), (unsigned int)positions.size(), indices, 0, maxError, &error);
+
+    CHECK(simplified.size() < indices.size() / 2);
+    CHECK(error >= 0.0f && error <= maxError);
+    CHECK(std::find(simplified.begin(), simplified.end(), bump) != simplified.end());
+}
+
+TEST(SphereStaysWithinMaxError) {
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+    MakeSphere(24, 48, positions, indices);
+
+    const float maxError = 0.02f;
+    float error = -1.0f;
+    std::vector<unsigned int> simplified = MeshSimplifier::Simplify(
+        &positions[0], sizeof(glm::vec3), (unsigned int)positions.size(), indices, 0, maxError, &error);
+
+    CHECK(simplified.size() < indices.size() / 2);
+    CHECK(error > 0.0f && error <= maxError);
+
+    // the error is measured at the vertices, which stay on the sphere. every vertex is within maxError of all the
+    // planes it replaced, not just of their mean, so the middle of a new triangle sinks little further than that.
+    for (size_t i = 0; i + 2 < simplified.size(); i += 3) {
+        glm::vec3 center = (positions[simplified[i]] + positions[simplified[i + 1]] + positions[simplified[i + 2]]) /
+                           3.0f;
+        CHECK(1.0f - glm::length(center) <= maxError * 1.5f);
+        // no triangle was turned inside out
+        CHECK(glm::dot(GetNormal(positions, &simplified[i]), center) > 0.0f);
+    }
+}
+
+TEST(SimplifyStopsAtTheTargetCount) {
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+    MakeSphere(24, 48, positions, indices);
+
+    unsigned int target = (unsigned int)indices.size() / 4;
+    float error = 0.0f;
+    std::vector<unsigned int> simplified = MeshSimplifier::Simplify(
+        &positions[0], sizeof(glm::vec3), (unsigned int)positions.size(), indices, target, 1.0f, &error);
+
+    CHECK(simplified.size() <= target);
+    // a collapse removes at most a handful of triangles, it does not overshoot by much
+    CHECK(simplified.size() > target * 3 / 4);
+}
+
+TEST(CompactVerticesKeepsOnlyUsedVertices) {
+    std::vector<unsigned int> indices = {4, 2, 7, 7, 2, 9};
+    std::vector<unsigned int> remap;
+    MeshSimplifier::CompactVertices(indices, 10, remap);
+
+    CHECK(remap.size() == 4);
+    for (size_t i = 0; i < indices.size(); i++) {
+        CHECK(indices[i] < remap.size());
+    }
+
+    // the triangles still point at the same old vertices
+    const unsigned int original[6] = {4, 2, 7, 7, 2, 9};
+    for (size_t i = 0; i < indices.size() && indices[i] < remap.size(); i++) {
+        CHECK(remap[indices[i]] == original[i]);
+    }
+}
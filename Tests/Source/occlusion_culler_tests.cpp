@@ -0,0 +1,84 @@
+#include "test.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Render/occlusion_culler.h"
+
+using namespace gdp1;
+
+namespace {
+
+// a 10 x 10 quad in the xy plane facing +z, counter-clockwise seen from the front
+const glm::vec3 QUAD_POSITIONS[4] = {glm::vec3(-5.0f, -5.0f, 0.0f), glm::vec3(5.0f, -5.0f, 0.0f),
+                                     glm::vec3(5.0f, 5.0f, 0.0f), glm::vec3(-5.0f, 5.0f, 0.0f)};
+const unsigned int QUAD_INDICES[6] = {0, 1, 2, 0, 2, 3};
+const unsigned int BACK_QUAD_INDICES[6] = {0, 2, 1, 0, 3, 2};
+
+// the camera at the origin looking down -z
+glm::mat4 GetViewProjection() { return glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f); }
+
+// a unit box around center
+bool IsBoxVisible(const OcclusionCuller& culler, const glm::vec3& center, float halfSize = 0.5f) {
+    return culler.IsVisible(center - glm::vec3(halfSize), center + glm::vec3(halfSize));
+}
+
+void RasterizeQuad(OcclusionCuller& culler, const glm::mat4& world, const unsigned int* indices) {
+    culler.Begin(GetViewProjection());
+    culler.AddOccluder(world, QUAD_POSITIONS, sizeof(glm::vec3), 4, indices, 6);
+    culler.Rasterize();
+}
+
+}  // namespace
+
+TEST(OccluderHidesBoxesBehindIt) {
+    OcclusionCuller culler;
+    RasterizeQuad(culler, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -10.0f)), QUAD_INDICES);
+
+    CHECK(culler.GetTriangleCount() == 2);
+    CHECK(!IsBoxVisible(culler, glm::vec3(0.0f, 0.0f, -20.0f)));
+    CHECK(!IsBoxVisible(culler, glm::vec3(2.0f, -2.0f, -30.0f)));
+}
+
+TEST(OccluderKeepsBoxesInFrontBesideOrAcrossIt) {
+    OcclusionCuller culler;
+    RasterizeQuad(culler, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -10.0f)), QUAD_INDICES);
+
+    // in front
+    CHECK(IsBoxVisible(culler, glm::vec3(0.0f, 0.0f, -5.0f)));
+    // straddling the quad
+    CHECK(IsBoxVisible(culler, glm::vec3(0.0f, 0.0f, -10.0f)));
+    // behind but peeking past its edge
+    CHECK(IsBoxVisible(culler, glm::vec3(14.0f, 0.0f, -20.0f)));
+    // far off to the side
+    CHECK(IsBoxVisible(culler, glm::vec3(40.0f, 0.0f, -50.0f)));
+}
+
+TEST(BackFacingOccluderIsSkipped) {
+    OcclusionCuller culler;
+    RasterizeQuad(culler, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -10.0f)), BACK_QUAD_INDICES);
+
+    CHECK(IsBoxVisible(culler, glm::vec3(0.0f, 0.0f, -20.0f)));
+}
+
+TEST(MirroredOccluderKeepsItsFrontFace) {
+    // mirrored in x, the quad's own front face still faces the camera
+    glm::mat4 world = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -10.0f)),
+                                 glm::vec3(-1.0f, 1.0f, 1.0f));
+
+    OcclusionCuller culler;
+    RasterizeQuad(culler, world, QUAD_INDICES);
+    CHECK(!IsBoxVisible(culler, glm::vec3(0.0f, 0.0f, -20.0f)));
+
+    RasterizeQuad(culler, world, BACK_QUAD_INDICES);
+    CHECK(IsBoxVisible(culler, glm::vec3(0.0f, 0.0f, -20.0f)));
+}
+
+TEST(OccluderCrossingTheNearPlaneIsSkipped) {
+    // the quad lies along the view direction, through the camera
+    glm::mat4 world = glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    OcclusionCuller culler;
+    RasterizeQuad(culler, world, QUAD_INDICES);
+    CHECK(culler.GetTriangleCount() == 0);
+    CHECK(IsBoxVisible(culler, glm::vec3(0.0f, 0.0f, -20.0f)));
+}
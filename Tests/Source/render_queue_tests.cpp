@@ -0,0 +1,344 @@
+#include "test.h"
+#include "render_test_utils.h"
+
+#include "Render/render_backend.h"
+
+using namespace gdp1;
+using namespace gdp1::test;
+
+namespace {
+
+// packet of mesh with a diffuse texture, rekeyed for its texture set
+DrawPacket MakeTexturedPacket(int program, unsigned int mesh, unsigned int diffuse, const glm::mat4* model,
+                              float viewDepth) {
+    DrawPacket packet = MakePacket(program, mesh, model, viewDepth);
+    packet.textures[DiffuseSlot] = diffuse;
+    packet.key = RenderQueue::MakeKey(RenderPass::Opaque, program, RenderQueue::HashTextures(packet.textures), mesh,
+                                      viewDepth);
+    return packet;
+}
+
+// the first recorded call of type
+const RecordingRenderBackend::Command* FindCommand(const RecordingRenderBackend& backend,
+                                                   RecordingRenderBackend::CommandType type) {
+    for (const RecordingRenderBackend::Command& command : backend.GetCommands()) {
+        if (command.type == type) return &command;
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+TEST(KeysOrderPassProgramTexturesMeshAndDepth) {
+    uint64_t base = RenderQueue::MakeKey(RenderPass::Opaque, 1, 1, 1, 1.0f);
+
+    CHECK(base < RenderQueue::MakeKey(RenderPass::AlphaTest, 0, 0, 0, 0.0f));
+    CHECK(base < RenderQueue::MakeKey(RenderPass::Opaque, 2, 0, 0, 0.0f));
+    CHECK(base < RenderQueue::MakeKey(RenderPass::Opaque, 1, 2, 0, 0.0f));
+    CHECK(base < RenderQueue::MakeKey(RenderPass::Opaque, 1, 1, 2, 0.0f));
+    CHECK(base < RenderQueue::MakeKey(RenderPass::Opaque, 1, 1, 1, 2.0f));
+
+    // depths behind the camera sort as 0
+    CHECK(RenderQueue::MakeKey(RenderPass::Opaque, 1, 1, 1, -5.0f) ==
+          RenderQueue::MakeKey(RenderPass::Opaque, 1, 1, 1, 0.0f));
+}
+
+TEST(EqualTextureSetsHashTheSame) {
+    unsigned int a[NUM_TEXTURE_SLOTS] = {3, 4, 0, 0};
+    unsigned int b[NUM_TEXTURE_SLOTS] = {3, 4, 0, 0};
+    unsigned int swapped[NUM_TEXTURE_SLOTS] = {4, 3, 0, 0};
+
+    CHECK(RenderQueue::HashTextures(a) == RenderQueue::HashTextures(b));
+    CHECK(RenderQueue::HashTextures(a) != RenderQueue::HashTextures(swapped));
+}
+
+TEST(SortGroupsProgramsAndPutsTheNearestFirst) {
+    glm::mat4 models[6];
+
+    RenderQueue queue;
+    queue.Add(MakePacket(1, 0, &models[0], 9.0f));
+    queue.Add(MakePacket(0, 0, &models[1], 4.0f));
+    queue.Add(MakePacket(1, 0, &models[2], 2.0f));
+    queue.Add(MakePacket(0, 0, &models[3], 1.0f));
+    queue.Add(MakePacket(1, 0, &models[4], 5.0f));
+    queue.Add(MakePacket(0, 0, &models[5], 30.0f));
+    queue.Sort();
+
+    CHECK(queue.GetPacketCount() == 6);
+    const glm::mat4* expected[6] = {&models[3], &models[1], &models[5], &models[2], &models[4], &models[0]};
+    for (unsigned int i = 0; i < 6; i++) {
+        CHECK(queue.GetSortedPacket(i).model == expected[i]);
+    }
+}
+
+TEST(SortIsStableForEqualKeys) {
+    glm::mat4 models[3];
+
+    RenderQueue queue;
+    for (int i = 0; i < 3; i++) {
+        queue.Add(MakePacket(0, 0, &models[i], 1.0f));
+    }
+    queue.Sort();
+
+    for (unsigned int i = 0; i < 3; i++) {
+        CHECK(queue.GetSortedPacket(i).model == &models[i]);
+    }
+}
+
+// Interleaved programs and textures, the way a hash map hands out the objects, only bind each once when sorted.
+TEST(SubmitSkipsRedundantBinds) {
+    const int numObjects = 16;
+    glm::mat4 models[numObjects];
+
+    RenderQueue queue;
+    for (int i = 0; i < numObjects; i++) {
+        queue.Add(MakeTexturedPacket(i % 2, i % 4, 10 + i % 4, &models[i], 1.0f + i));
+    }
+    queue.Sort();
+
+    RecordingRenderBackend backend;
+    queue.Submit(backend);
+
+    // programs 0 and 1, textures 10 and 12 under program 0, 11 and 13 under 1
+    CHECK(backend.GetCount(RecordingRenderBackend::UseProgramCommand) == 2);
+    CHECK(backend.GetCount(RecordingRenderBackend::BindTextureCommand) == 4);
+    CHECK(backend.GetCount(RecordingRenderBackend::BindVertexArrayCommand) == 1);
+
+    const RenderStats& stats = queue.GetStats();
+    CHECK(stats.packets == numObjects);
+    CHECK(stats.programBinds == 2);
+    CHECK(stats.textureBinds == 4);
+    CHECK(stats.vertexArrayBinds == 1);
+    CHECK(stats.GetStateChanges() == 7);
+}
+
+TEST(UntexturedPacketsKeepTheBoundTextures) {
+    glm::mat4 models[2];
+
+    RenderQueue queue;
+    queue.Add(MakeTexturedPacket(0, 0, 10, &models[0], 1.0f));
+    queue.Add(MakePacket(0, 1, &models[1], 1.0f));
+    queue.Sort();
+
+    RecordingRenderBackend backend;
+    queue.Submit(backend);
+
+    CHECK(backend.GetCount(RecordingRenderBackend::BindTextureCommand) == 1);
+}
+
+// Whatever sorts first, an untextured mesh samples the default diffuse texture and not the one left bound before it.
+TEST(UntexturedPacketsGetTheDefaultDiffuse) {
+    const unsigned int white = 99;
+    glm::mat4 models[3];
+
+    RenderQueue queue;
+    queue.defaultDiffuse = white;
+    queue.Add(MakeTexturedPacket(0, 0, 10, &models[0], 1.0f));
+    queue.Add(MakePacket(0, 1, &models[1], 1.0f));
+    queue.Add(MakePacket(0, 2, &models[2], 2.0f));
+    queue.Sort();
+
+    RecordingRenderBackend backend;
+    queue.Submit(backend);
+
+    // the textured draw binds 10, the untextured ones share one bind of the default, each bind is drawn with
+    std::vector<unsigned int> binds;
+    bool drawn = true;
+    for (const RecordingRenderBackend::Command& command : backend.GetCommands()) {
+        if (command.type == RecordingRenderBackend::BindTextureCommand) {
+            CHECK(command.first == DiffuseSlot);
+            CHECK(drawn);
+            binds.push_back(command.second);
+            drawn = false;
+        }
+        if (command.type == RecordingRenderBackend::DrawCommand ||
+            command.type == RecordingRenderBackend::MultiDrawCommand) {
+            drawn = true;
+        }
+    }
+    CHECK(binds.size() == 2);
+    CHECK(binds.size() == 2 && ((binds[0] == 10 && binds[1] == white) || (binds[0] == white && binds[1] == 10)));
+}
+
+TEST(ProgramsGetTheirSamplersOnceAndTheInstanceBaseBack) {
+    glm::mat4 models[4];
+
+    RenderQueue queue;
+    for (int i = 0; i < 4; i++) {
+        queue.Add(MakePacket(i % 2, 0, &models[i], 1.0f + i));
+    }
+    queue.Sort();
+
+    RecordingRenderBackend backend;
+    queue.Submit(backend);
+
+    CHECK(backend.GetUniformCount("u_Material.texture_diffuse1") == 2);
+    CHECK(backend.GetUniformCount("u_UseLights") == 2);
+    // switched on for each program and off again before leaving it
+    CHECK(backend.GetUniformCount("u_InstanceBase") == 4);
+    CHECK(backend.GetUniformCount("u_Model") == 0);
+}
+
+TEST(EmptyQueueSubmitsNothing) {
+    RenderQueue queue;
+    queue.Sort();
+
+    RecordingRenderBackend backend;
+    queue.Submit(backend);
+
+    CHECK(backend.GetCommands().empty());
+    CHECK(queue.GetStats().drawCalls == 0);
+}
+
+TEST(IdenticalPacketsBecomeOneInstancedCommand) {
+    glm::mat4 models[5];
+    const float depths[5] = {7.0f, 2.0f, 9.0f, 1.0f, 4.0f};
+
+    RenderQueue queue;
+    for (int i = 0; i < 5; i++) {
+        models[i] = glm::mat4(depths[i]);
+        queue.Add(MakePacket(0, 3, &models[i], depths[i]));
+    }
+    queue.Sort();
+
+    const std::vector<DrawElementsIndirectCommand>& commands = queue.GetCommands();
+    CHECK(commands.size() == 1);
+    CHECK(commands[0].count == 300);
+    CHECK(commands[0].instanceCount == 5);
+    CHECK(commands[0].firstIndex == 900);
+    CHECK(commands[0].baseInstance == 0);
+
+    // the matrices follow the sorted packets, nearest first
+    const std::vector<glm::mat4>& matrices = queue.GetInstanceMatrices();
+    CHECK(matrices.size() == 5);
+    const float sorted[5] = {1.0f, 2.0f, 4.0f, 7.0f, 9.0f};
+    for (int i = 0; i < 5; i++) {
+        CHECK(matrices[i] == glm::mat4(sorted[i]));
+    }
+
+    RecordingRenderBackend backend;
+    queue.Submit(backend);
+    CHECK(backend.GetCount(RecordingRenderBackend::DrawCommand) == 1);
+    const RecordingRenderBackend::Command* draw = FindCommand(backend, RecordingRenderBackend::DrawCommand);
+    CHECK(draw && draw->first == 300 && draw->second == 5);
+    CHECK(queue.GetStats().instancedDraws == 1);
+    CHECK(queue.GetStats().drawCalls == 1);
+}
+
+TEST(LongRunsSplitAtMaxInstances) {
+    glm::mat4 models[5];
+
+    RenderQueue queue;
+    queue.maxInstances = 2;
+    for (int i = 0; i < 5; i++) {
+        queue.Add(MakePacket(0, 0, &models[i], 1.0f + i));
+    }
+    queue.Sort();
+
+    const std::vector<DrawElementsIndirectCommand>& commands = queue.GetCommands();
+    CHECK(commands.size() == 3);
+    CHECK(commands[0].instanceCount == 2 && commands[0].baseInstance == 0);
+    CHECK(commands[1].instanceCount == 2 && commands[1].baseInstance == 2);
+    CHECK(commands[2].instanceCount == 1 && commands[2].baseInstance == 4);
+    CHECK(queue.GetInstanceMatrices().size() == 5);
+}
+
+TEST(MeshesSharingStateBecomeOneMultiDraw) {
+    glm::mat4 models[6];
+
+    RenderQueue queue;
+    for (int i = 0; i < 6; i++) {
+        queue.Add(MakePacket(0, i % 3, &models[i], 1.0f + i));
+    }
+    queue.Sort();
+
+    const std::vector<DrawElementsIndirectCommand>& commands = queue.GetCommands();
+    CHECK(commands.size() == 3);
+    for (unsigned int i = 0; i < 3; i++) {
+        CHECK(commands[i].firstIndex == i * 300);
+        CHECK(commands[i].instanceCount == 2);
+        CHECK(commands[i].baseInstance == i * 2);
+    }
+
+    RecordingRenderBackend backend;
+    queue.Submit(backend);
+
+    CHECK(backend.GetCount(RecordingRenderBackend::MultiDrawCommand) == 1);
+    CHECK(backend.GetCount(RecordingRenderBackend::DrawCommand) == 0);
+    const RecordingRenderBackend::Command* draw = FindCommand(backend, RecordingRenderBackend::MultiDrawCommand);
+    CHECK(draw && draw->first == 0 && draw->second == 3);
+
+    // the backend got the commands as the queue built them
+    const std::vector<DrawElementsIndirectCommand>& uploaded = backend.GetIndirectCommands();
+    CHECK(uploaded.size() == commands.size());
+    for (size_t i = 0; i < uploaded.size() && i < commands.size(); i++) {
+        CHECK(uploaded[i].count == commands[i].count);
+        CHECK(uploaded[i].instanceCount == commands[i].instanceCount);
+        CHECK(uploaded[i].firstIndex == commands[i].firstIndex);
+        CHECK(uploaded[i].baseVertex == commands[i].baseVertex);
+        CHECK(uploaded[i].baseInstance == commands[i].baseInstance);
+    }
+
+    CHECK(queue.GetStats().multiDraws == 1);
+    CHECK(queue.GetStats().indirectCommands == 3);
+    CHECK(queue.GetStats().drawCalls == 1);
+}
+
+TEST(WithoutMultiDrawEveryCommandIsADraw) {
+    glm::mat4 models[3];
+
+    RenderQueue queue;
+    queue.multiDraw = false;
+    for (int i = 0; i < 3; i++) {
+        queue.Add(MakePacket(0, i, &models[i], 1.0f));
+    }
+    queue.Sort();
+
+    RecordingRenderBackend backend;
+    queue.Submit(backend);
+
+    CHECK(backend.GetCount(RecordingRenderBackend::MultiDrawCommand) == 0);
+    CHECK(backend.GetCount(RecordingRenderBackend::DrawCommand) == 3);
+    // the state is still only bound once
+    CHECK(backend.GetCount(RecordingRenderBackend::UseProgramCommand) == 1);
+    CHECK(backend.GetCount(RecordingRenderBackend::BindVertexArrayCommand) == 1);
+}
+
+TEST(DifferentStateIsNotMultiDrawn) {
+    glm::mat4 models[3];
+
+    RenderQueue queue;
+    queue.Add(MakePacket(0, 0, &models[0], 1.0f));
+    queue.Add(MakePacket(1, 1, &models[1], 1.0f));
+    queue.Add(MakeTexturedPacket(1, 2, 10, &models[2], 1.0f));
+    queue.Sort();
+
+    RecordingRenderBackend backend;
+    queue.Submit(backend);
+
+    CHECK(queue.GetCommands().size() == 3);
+    CHECK(backend.GetCount(RecordingRenderBackend::MultiDrawCommand) == 0);
+    CHECK(backend.GetCount(RecordingRenderBackend::DrawCommand) == 3);
+}
+
+TEST(NonInstancedPacketsSetTheirModelMatrix) {
+    glm::mat4 models[2];
+
+    RenderQueue queue;
+    for (int i = 0; i < 2; i++) {
+        DrawPacket packet = MakePacket(0, 0, &models[i], 1.0f + i);
+        packet.instanced = false;
+        queue.Add(packet);
+    }
+    queue.Sort();
+
+    CHECK(queue.GetCommands().size() == 2);
+    CHECK(queue.GetInstanceMatrices().empty());
+
+    RecordingRenderBackend backend;
+    queue.Submit(backend);
+
+    CHECK(backend.GetCount(RecordingRenderBackend::DrawCommand) == 2);
+    CHECK(backend.GetUniformCount("u_Model") == 2);
+    CHECK(backend.GetUniformCount("u_InstanceBase") == 0);
+}
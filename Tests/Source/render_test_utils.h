@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Render/render_queue.h"
+
+namespace gdp1 {
+namespace test {
+
+// The render queue only compares programs and the RecordingRenderBackend never calls them, so the render tests use
+// addresses of their own instead of compiled shaders.
+inline Shader* FakeProgram(int index) {
+    static char programs[16];
+    return reinterpret_cast<Shader*>(&programs[index]);
+}
+
+// An untextured packet of mesh in the arena vertex array, keyed like Renderer::Submit keys its packets.
+inline DrawPacket MakePacket(int program, unsigned int mesh, const glm::mat4* model, float viewDepth) {
+    DrawPacket packet = {};
+    packet.shader = FakeProgram(program);
+    packet.model = model;
+    packet.vertexArray = 1;
+    packet.firstIndex = mesh * 300;
+    packet.numIndices = 300;
+    packet.baseVertex = 0;
+    packet.numInstances = 1;
+    packet.boneOffset = -1;
+    packet.setLit = 0;
+    packet.instanced = true;
+    packet.key = RenderQueue::MakeKey(RenderPass::Opaque, program, RenderQueue::HashTextures(packet.textures), mesh,
+                                      viewDepth);
+    return packet;
+}
+
+}  // namespace test
+}  // namespace gdp1
@@ -0,0 +1,137 @@
+#include "test.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "Animation/skeletal_clip.h"
+
+using namespace gdp1;
+
+namespace {
+
+const char* const CLIP_PATH = "skeletal_clip_test.clip";
+
+// the .clip header is followed by the tracks, then the names
+const size_t HEADER_SIZE = 120;
+
+// two tracks of three keys each, the first moving along x
+aiAnimation* MakeAnimation() {
+    aiAnimation* animation = new aiAnimation();
+    animation->mDuration = 20.0;
+    animation->mTicksPerSecond = 10.0;
+    animation->mNumChannels = 2;
+    animation->mChannels = new aiNodeAnim*[2];
+
+    for (unsigned int i = 0; i < 2; i++) {
+        aiNodeAnim* channel = new aiNodeAnim();
+        channel->mNodeName = aiString(i == 0 ? "Spine" : "Head");
+
+        channel->mNumPositionKeys = 3;
+        channel->mPositionKeys = new aiVectorKey[3];
+        channel->mNumRotationKeys = 3;
+        channel->mRotationKeys = new aiQuatKey[3];
+        channel->mNumScalingKeys = 3;
+        channel->mScalingKeys = new aiVectorKey[3];
+        for (unsigned int k = 0; k < 3; k++) {
+            double time = k * 10.0;
+            float x = i == 0 ? (float)(k * k) : 0.0f;
+            channel->mPositionKeys[k] = aiVectorKey(time, aiVector3D(x, 1.0f, 0.0f));
+            channel->mRotationKeys[k] = aiQuatKey(time, aiQuaternion(1.0f, 0.0f, 0.0f, 0.0f));
+            channel->mScalingKeys[k] = aiVectorKey(time, aiVector3D(1.0f, 1.0f, 1.0f));
+        }
+
+        animation->mChannels[i] = channel;
+    }
+
+    return animation;
+}
+
+std::vector<char> SaveClip(const ClipCompressionSettings& settings) {
+    aiAnimation* animation = MakeAnimation();
+    SkeletalClip clip;
+    clip.Compile(animation, settings);
+    delete animation;
+
+    clip.Save(CLIP_PATH);
+
+    std::ifstream file(CLIP_PATH, std::ios::binary);
+    return std::vector<char>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+bool LoadBytes(const std::vector<char>& bytes, const ClipCompressionSettings& settings = ClipCompressionSettings()) {
+    {
+        std::ofstream file(CLIP_PATH, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), bytes.size());
+    }
+
+    SkeletalClip clip;
+    bool loaded = clip.Load(CLIP_PATH, settings);
+    std::remove(CLIP_PATH);
+    return loaded;
+}
+
+SkeletalTrack* GetTrack(std::vector<char>& bytes, unsigned int index) {
+    return reinterpret_cast<SkeletalTrack*>(&bytes[HEADER_SIZE + index * sizeof(SkeletalTrack)]);
+}
+
+}  // namespace
+
+TEST(SavedClipLoadsBack) {
+    std::vector<char> bytes = SaveClip(ClipCompressionSettings());
+    CHECK(bytes.size() > HEADER_SIZE + 2 * sizeof(SkeletalTrack));
+    CHECK(LoadBytes(bytes));
+
+    // the tracks are where the tests below corrupt them
+    CHECK(GetTrack(bytes, 0)->positionCount == 3);
+    CHECK(GetTrack(bytes, 1)->positionOffset == 3);
+}
+
+TEST(TruncatedClipIsRejected) {
+    std::vector<char> bytes = SaveClip(ClipCompressionSettings());
+    bytes.resize(bytes.size() - 4);
+    CHECK(!LoadBytes(bytes));
+}
+
+TEST(ClipWithTrackPastItsKeysIsRejected) {
+    ClipCompressionSettings settings;
+    std::vector<char> bytes = SaveClip(settings);
+
+    std::vector<char> corrupt = bytes;
+    GetTrack(corrupt, 1)->positionCount = 100;
+    CHECK(!LoadBytes(corrupt));
+
+    corrupt = bytes;
+    GetTrack(corrupt, 1)->rotationOffset = 0xFFFFFFF0u;
+    CHECK(!LoadBytes(corrupt));
+
+    corrupt = bytes;
+    GetTrack(corrupt, 0)->scalingOffset = 5;
+    CHECK(!LoadBytes(corrupt));
+}
+
+TEST(ClipWithUnterminatedNameIsRejected) {
+    std::vector<char> bytes = SaveClip(ClipCompressionSettings());
+
+    // "Spine\0Head\0", the last NUL is the last byte of the names
+    size_t names = HEADER_SIZE + 2 * sizeof(SkeletalTrack);
+    CHECK(memcmp(&bytes[names], "Spine\0Head\0", 11) == 0);
+    bytes[names + 10] = 'x';
+    CHECK(!LoadBytes(bytes));
+}
+
+TEST(ClipCompiledWithOtherSettingsIsStale) {
+    ClipCompressionSettings settings;
+    std::vector<char> bytes = SaveClip(settings);
+
+    ClipCompressionSettings tighter = settings;
+    tighter.positionError *= 0.5f;
+    CHECK(!LoadBytes(bytes, tighter));
+
+    ClipCompressionSettings otherRoot = settings;
+    otherRoot.rootMotionNode = "Spine";
+    CHECK(!LoadBytes(bytes, otherRoot));
+
+    CHECK(LoadBytes(bytes, settings));
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+// A minimal test runner for the parts of the engine that run without a window or GL context.
+// TEST(name) registers a function, CHECK(expr) reports a failed expression and keeps going.
+
+namespace gdp1 {
+namespace test {
+
+typedef void (*TestFunc)();
+
+struct TestCase {
+    const char* name;
+    TestFunc func;
+};
+
+std::vector<TestCase>& GetTests();
+
+// counts the failure of the running test and prints where it happened
+void Fail(const char* file, int line, const char* expr);
+
+struct Registrar {
+    Registrar(const char* name, TestFunc func) { GetTests().push_back({name, func}); }
+};
+
+}  // namespace test
+}  // namespace gdp1
+
+#define TEST(name)                                                        \
+    static void name();                                                   \
+    static ::gdp1::test::Registrar name##_registrar(#name, &name);        \
+    static void name()
+
+#define CHECK(expr)                                                           \
+    do {                                                                      \
+        if (!(expr)) ::gdp1::test::Fail(__FILE__, __LINE__, #expr);           \
+    } while (0)
@@ -0,0 +1,52 @@
+#include "test.h"
+
+#include <cstdio>
+
+#include "Core/job_system.h"
+#include "Core/logger.h"
+
+namespace gdp1 {
+namespace test {
+
+namespace {
+
+unsigned int s_Failures = 0;
+
+}  // namespace
+
+std::vector<TestCase>& GetTests() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+void Fail(const char* file, int line, const char* expr) {
+    printf("  %s(%d): CHECK(%s) failed\n", file, line, expr);
+    s_Failures++;
+}
+
+}  // namespace test
+}  // namespace gdp1
+
+// Runs every registered test, returns the number of failed ones.
+int main() {
+    using namespace gdp1;
+
+    Logger::Init();
+    // the parallel code paths run on the pool like they do in the game
+    JobSystem::Init();
+
+    int failedTests = 0;
+    for (const test::TestCase& testCase : test::GetTests()) {
+        unsigned int failuresBefore = test::s_Failures;
+        testCase.func();
+
+        bool passed = test::s_Failures == failuresBefore;
+        printf("[%s] %s\n", passed ? "  OK  " : " FAIL ", testCase.name);
+        if (!passed) failedTests++;
+    }
+
+    JobSystem::Shutdown();
+
+    printf("%d of %d tests failed\n", failedTests, (int)test::GetTests().size());
+    return failedTests;
+}